@@ -1,4 +1,5 @@
 #include "HistogramDialog.h"
+#include "ImageProcessor/ImageStatisticsCache.h"
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QPainter>
@@ -81,34 +82,23 @@ void HistogramDialog::calculateHistogram(const QImage& image)
     qDebug() << "开始计算直方图，图像大小：" << image.width() << "x" << image.height() 
              << "，格式：" << image.format();
 
-    // Reset histogram
-    m_histogram.fill(0, 256);
-    
-    // Calculate grayscale histogram
-    for (int y = 0; y < image.height(); ++y) {
-        for (int x = 0; x < image.width(); ++x) {
-            QColor color = image.pixelColor(x, y);
-            int gray = qGray(color.rgb());
-            if (gray >= 0 && gray < 256) {
-                m_histogram[gray]++;
-            }
-        }
+    // 直方图与统计量由统计引擎一次遍历得到，同一版本的图像不会重复计算
+    const ImageStatistics statistics = ImageStatisticsCache::get(image);
+    const ImageStatistics::Channel &gray = statistics.gray();
+    for (int i = 0; i < 256; i++) {
+        m_histogram[i] = static_cast<int>(gray.histogram[i]);
     }
-    
-    // Find maximum value for scaling
+
+    // 16位灰度图的统计量换算到0-255
+    const double scale = image.depth() == 16 ? 255.0 / 65535.0 : 1.0;
+    const double meanValue = gray.mean() * scale;
+    const double stddevValue = gray.stddev() * scale;
+    const qint64 totalPixels = gray.count;
     int maxCount = 0;
-    int totalPixels = 0;
-    double sum = 0;
-    
     for (int i = 0; i < 256; i++) {
         maxCount = qMax(maxCount, m_histogram[i]);
-        totalPixels += m_histogram[i];
-        sum += i * m_histogram[i];
     }
     
-    // Calculate mean value
-    double meanValue = totalPixels > 0 ? sum / totalPixels : 0;
-    
     // 打印直方图中非零值的数量，便于调试
     int nonZeroValues = 0;
     for (int i = 0; i < 256; i++) {
@@ -118,8 +108,11 @@ void HistogramDialog::calculateHistogram(const QImage& image)
     }
     
     // Update stats label
-    m_statsLabel->setText(tr("灰度统计: 平均值 = %1, 总像素 = %2, 非零值 = %3")
+    m_statsLabel->setText(tr("灰度统计: 平均值 = %1, 标准差 = %2, 范围 = [%3, %4], 总像素 = %5, 非零值 = %6")
                            .arg(meanValue, 0, 'f', 2)
+                           .arg(stddevValue, 0, 'f', 2)
+                           .arg(gray.min * scale, 0, 'f', 0)
+                           .arg(gray.max * scale, 0, 'f', 0)
                            .arg(totalPixels)
                            .arg(nonZeroValues));
     
@@ -0,0 +1,16 @@
+# 链接图像处理核心库（ImageCore/ImageCore.pro）：只依赖QtCore和OpenCV，界面程序和命令行工具共用
+# 使用方法：在.pro中 include(<仓库根目录>/ImageCore.pri)，并在QIImageProcessAll.pro中声明对core的依赖，
+# 从QIImageProcessAll.pro构建时核心库先于使用者构建，输出到构建目录下的lib
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD/ImageProcessor
+
+IMAGECORE_LIB_DIR = $$shadowed($$PWD)/lib
+LIBS += -L$$IMAGECORE_LIB_DIR -lImageCore
+# 核心库更新后重新链接
+win32-msvc*: PRE_TARGETDEPS += $$IMAGECORE_LIB_DIR/ImageCore.lib
+else: PRE_TARGETDEPS += $$IMAGECORE_LIB_DIR/libImageCore.a
+
+# OpenCV 配置（静态库之后链接）
+INCLUDEPATH += $$PWD/3rdParty/opencv/include
+LIBS += -L$$PWD/3rdParty/opencv/lib -lopencv_world490
@@ -0,0 +1,52 @@
+# 图像处理核心库（静态库）：格式转换、滤波、查找表、直方图、ROI统计和批处理，只依赖QtCore和OpenCV
+# 界面程序、命令行工具和基准测试都链接这一份库，使用方法见仓库根目录的ImageCore.pri
+QT       = core
+TEMPLATE = lib
+CONFIG  += staticlib c++17
+
+TARGET = ImageCore
+# 输出到构建目录下的lib，与ImageCore.pri中的链接路径一致
+DESTDIR = $$shadowed($$PWD/..)/lib
+
+INCLUDEPATH += $$PWD/../ImageProcessor
+DEPENDPATH += $$PWD/../ImageProcessor
+
+# OpenCV 配置（只需头文件，由使用者链接）
+INCLUDEPATH += $$PWD/../3rdParty/opencv/include
+
+SOURCES += \
+    ../ImageProcessor/BatchProcessor.cpp \
+    ../ImageProcessor/BoxFilter.cpp \
+    ../ImageProcessor/ConstantTimeMedian.cpp \
+    ../ImageProcessor/HighPass.cpp \
+    ../ImageProcessor/ImageCore.cpp \
+    ../ImageProcessor/ImageOperations.cpp \
+    ../ImageProcessor/ImageStatistics.cpp \
+    ../ImageProcessor/Metrics.cpp \
+    ../ImageProcessor/OperationGraph.cpp \
+    ../ImageProcessor/PointOpChain.cpp \
+    ../ImageProcessor/RecursiveGaussian.cpp \
+    ../ImageProcessor/RoiMask.cpp \
+    ../ImageProcessor/RoiRasterizer.cpp \
+    ../ImageProcessor/SummedAreaTable.cpp \
+    ../ImageProcessor/TileScheduler.cpp \
+    ../ImageProcessor/TraceRecorder.cpp
+
+HEADERS += \
+    ../ImageProcessor/BatchProcessor.h \
+    ../ImageProcessor/BoundedQueue.h \
+    ../ImageProcessor/BoxFilter.h \
+    ../ImageProcessor/ConstantTimeMedian.h \
+    ../ImageProcessor/HighPass.h \
+    ../ImageProcessor/ImageCore.h \
+    ../ImageProcessor/ImageOperations.h \
+    ../ImageProcessor/ImageStatistics.h \
+    ../ImageProcessor/Metrics.h \
+    ../ImageProcessor/OperationGraph.h \
+    ../ImageProcessor/PointOpChain.h \
+    ../ImageProcessor/RecursiveGaussian.h \
+    ../ImageProcessor/RoiMask.h \
+    ../ImageProcessor/RoiRasterizer.h \
+    ../ImageProcessor/SummedAreaTable.h \
+    ../ImageProcessor/TileScheduler.h \
+    ../ImageProcessor/TraceRecorder.h
@@ -0,0 +1,294 @@
+#include "BatchProcessor.h"
+#include "BoundedQueue.h"
+#include "Metrics.h"
+#include "TraceRecorder.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// 在流水线中流动的一张图像
+struct BatchProcessor::Item {
+    QString path;
+    cv::Mat image;
+};
+
+// OpenCV能够读写的扩展名
+static const char* const IMAGE_SUFFIXES[] = {
+    "bmp", "dib", "jpg", "jpeg", "jpe", "jp2", "png", "webp",
+    "pbm", "pgm", "ppm", "pnm", "tif", "tiff", "sr", "ras", "hdr", "pic"
+};
+
+BatchProcessor::BatchProcessor(const OperationGraph &pipeline)
+    : BatchProcessor(pipeline, Options())
+{
+}
+
+BatchProcessor::BatchProcessor(const OperationGraph &pipeline, const Options &options)
+    : m_options(resolved(options))
+{
+    // 只复制阶段配置，不带入源图像、缓存和针对某幅图像的处理范围
+    m_pipeline.copyStages(pipeline);
+}
+
+BatchProcessor::Result BatchProcessor::run(const QStringList &files, const QString &inputRoot,
+                                           const QString &outputRoot, const TileScheduler::Control &control)
+{
+    qDebug() << "====== BATCH START ======";
+    qDebug() << "Batch:" << files.size() << "files, threads decode/process/encode ="
+             << m_options.decodeThreads << m_options.processThreads << m_options.encodeThreads
+             << "queue =" << m_options.queueCapacity;
+
+    const auto start = std::chrono::steady_clock::now();
+    Result result;
+    result.total = files.size();
+
+    BoundedQueue<Item> decoded(m_options.queueCapacity);
+    BoundedQueue<Item> processed(m_options.queueCapacity);
+    std::atomic<int> nextFile(0);
+    std::atomic<int> finished(0);
+    std::atomic<int> succeeded(0);
+    std::atomic<bool> cancelled(false);
+    std::atomic<int> decodersLeft(m_options.decodeThreads);
+    std::atomic<int> processorsLeft(m_options.processThreads);
+    std::mutex errorMutex;
+
+    // 管线内部只转发取消检查，进度按文件计算
+    TileScheduler::Control stageControl;
+    stageControl.cancelled = control.cancelled;
+
+    const auto isCancelled = [&]() {
+        if (!cancelled.load() && control.cancelled && control.cancelled()) {
+            // 丢弃队列中剩余的图像，阻塞在队列上的线程立即返回
+            cancelled.store(true);
+            decoded.abort();
+            processed.abort();
+        }
+        return cancelled.load();
+    };
+    // 文件失败或完成时计数并报告进度
+    const auto fileDone = [&]() {
+        const int done = ++finished;
+        if (control.progress) {
+            control.progress(done, result.total);
+        }
+    };
+    const auto fail = [&](const QString &path, const QString &message) {
+        qDebug() << "Batch: failed" << path << message;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            result.errors.append(path + ": " + message);
+        }
+        fileDone();
+    };
+    // 单个文件的异常只影响该文件
+    const auto guarded = [&](const QString &path, const std::function<void()> &work) {
+        try {
+            work();
+        } catch (const cv::Exception& e) {
+            fail(path, QString::fromStdString(e.what()));
+        } catch (const std::exception& e) {
+            fail(path, QString::fromStdString(e.what()));
+        } catch (...) {
+            fail(path, QStringLiteral("Unknown error"));
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    // 第一级：读取并解码，文件按顺序分给空闲的线程
+    for (int t = 0; t < m_options.decodeThreads; ++t) {
+        threads.emplace_back([&]() {
+            TraceRecorder::setThreadName("Batch decode");
+            int index;
+            while (!isCancelled() && (index = nextFile++) < files.size()) {
+                const QString &path = files.at(index);
+                guarded(path, [&]() {
+                    Item item{path, readImage(path)};
+                    decoded.push(std::move(item));
+                });
+            }
+            if (--decodersLeft == 0) {
+                decoded.close();
+            }
+        });
+    }
+
+    // 第二级：每个线程持有一份管线副本，逐张设置源图像并计算
+    for (int t = 0; t < m_options.processThreads; ++t) {
+        threads.emplace_back([&]() {
+            TraceRecorder::setThreadName("Batch process");
+            OperationGraph graph;
+            graph.copyStages(m_pipeline);
+            Item item;
+            while (decoded.pop(item)) {
+                guarded(item.path, [&]() {
+                    graph.setSource(item.image);
+                    item.image = graph.evaluate(stageControl);
+                    // 释放管线中的缓存，等待下一张时不占用内存
+                    graph.setSource(cv::Mat());
+                    if (item.image.empty()) {
+                        if (isCancelled()) {
+                            return;
+                        }
+                        throw std::runtime_error("Pipeline produced an empty image");
+                    }
+                    processed.push(std::move(item));
+                });
+            }
+            if (--processorsLeft == 0) {
+                processed.close();
+            }
+        });
+    }
+
+    // 第三级：编码并写入输出文件
+    for (int t = 0; t < m_options.encodeThreads; ++t) {
+        threads.emplace_back([&]() {
+            TraceRecorder::setThreadName("Batch encode");
+            Item item;
+            while (processed.pop(item)) {
+                guarded(item.path, [&]() {
+                    writeImage(outputPath(item.path, inputRoot, outputRoot, m_options.outputFormat), item.image);
+                    ++succeeded;
+                    fileDone();
+                });
+                isCancelled();
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    result.succeeded = succeeded.load();
+    result.failed = result.errors.size();
+    result.cancelled = cancelled.load();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    qDebug() << "Batch:" << result.succeeded << "succeeded," << result.failed << "failed"
+             << (result.cancelled ? "(cancelled)" : "") << "in" << result.seconds << "s";
+    qDebug() << "====== BATCH END ======";
+    return result;
+}
+
+QStringList BatchProcessor::findImages(const QString &directory, bool recursive)
+{
+    QStringList nameFilters;
+    for (const char *suffix : IMAGE_SUFFIXES) {
+        nameFilters << QStringLiteral("*.") + QString::fromLatin1(suffix);
+    }
+
+    QStringList files;
+    QDirIterator it(directory, nameFilters, QDir::Files | QDir::Readable,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        files.append(it.next());
+    }
+    files.sort();
+    return files;
+}
+
+bool BatchProcessor::isSupportedImage(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return std::any_of(std::begin(IMAGE_SUFFIXES), std::end(IMAGE_SUFFIXES),
+                       [&suffix](const char *s) { return suffix == QLatin1String(s); });
+}
+
+cv::Mat BatchProcessor::readImage(const QString &path)
+{
+    Metrics::ScopedTimer timer("batch.decode");
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Cannot open file: " + file.errorString().toStdString());
+    }
+    const QByteArray data = file.readAll();
+    if (data.isEmpty()) {
+        throw std::runtime_error("File is empty");
+    }
+
+    // 保留原始位深和通道数，与界面中打开的图像一致（BGR顺序）
+    const cv::Mat buffer(1, data.size(), CV_8UC1, const_cast<char*>(data.constData()));
+    cv::Mat image = cv::imdecode(buffer, cv::IMREAD_UNCHANGED);
+    if (image.empty()) {
+        throw std::runtime_error("Unsupported or corrupt image");
+    }
+    timer.stop();
+    return image;
+}
+
+void BatchProcessor::writeImage(const QString &path, const cv::Mat &image)
+{
+    Metrics::ScopedTimer timer("batch.encode");
+    const QFileInfo info(path);
+    if (!QDir().mkpath(info.absolutePath())) {
+        throw std::runtime_error("Cannot create directory: " + info.absolutePath().toStdString());
+    }
+
+    std::vector<uchar> buffer;
+    const std::string extension = "." + info.suffix().toLower().toStdString();
+    if (!cv::imencode(extension, image, buffer)) {
+        throw std::runtime_error("Cannot encode image as " + extension);
+    }
+
+    // 写完后再替换目标文件，取消或出错时不会留下不完整的文件
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<qint64>(buffer.size()))
+               != static_cast<qint64>(buffer.size())
+        || !file.commit()) {
+        throw std::runtime_error("Cannot write file: " + file.errorString().toStdString());
+    }
+    timer.stop();
+}
+
+QString BatchProcessor::outputPath(const QString &file, const QString &inputRoot, const QString &outputRoot,
+                                   const QString &outputFormat)
+{
+    QString relative = QDir(inputRoot).relativeFilePath(file);
+    if (!outputFormat.isEmpty()) {
+        const QFileInfo info(relative);
+        const QString base = info.path() == QLatin1String(".") ? info.completeBaseName()
+                                                                : info.path() + "/" + info.completeBaseName();
+        relative = base + "." + outputFormat;
+    }
+    return QDir(outputRoot).filePath(relative);
+}
+
+BatchProcessor::Options BatchProcessor::resolved(const Options &options)
+{
+    // 处理占一半的核（块内部还会并行），读取解码和编码写入各占四分之一
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+    Options result = options;
+    if (result.decodeThreads <= 0) {
+        result.decodeThreads = std::max(1, cores / 4);
+    }
+    if (result.processThreads <= 0) {
+        result.processThreads = std::max(1, cores / 2);
+    }
+    if (result.encodeThreads <= 0) {
+        result.encodeThreads = std::max(1, cores / 4);
+    }
+    if (result.queueCapacity <= 0) {
+        result.queueCapacity = 2 * result.processThreads;
+    }
+    if (result.outputFormat.startsWith('.')) {
+        result.outputFormat.remove(0, 1);
+    }
+    result.outputFormat = result.outputFormat.toLower();
+    return result;
+}
@@ -0,0 +1,66 @@
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#include <QString>
+#include <QStringList>
+#include <opencv2/core.hpp>
+#include "OperationGraph.h"
+#include "TileScheduler.h"
+
+// 批处理：对一组图像文件重放同一条处理管线，只依赖QtCore和OpenCV，不需要界面
+// 读取解码 -> 处理 -> 编码写入三级流水线，各级有独立的线程，之间为有界队列：
+// IO、解码、处理和编码同时进行，内存中同时存在的图像数不超过队列容量加线程数
+class BatchProcessor
+{
+public:
+    struct Options {
+        int decodeThreads = 0;    // 各级线程数，0时按核数选择
+        int processThreads = 0;
+        int encodeThreads = 0;
+        int queueCapacity = 0;    // 每个队列最多缓存的图像数，0时为处理线程数的2倍
+        QString outputFormat;     // 输出格式的扩展名（如"png"），为空时与输入文件相同
+    };
+
+    struct Result {
+        int total = 0;
+        int succeeded = 0;
+        int failed = 0;
+        bool cancelled = false;
+        double seconds = 0.0;
+        QStringList errors;       // 每个失败的文件一条："路径: 错误信息"
+    };
+
+    // pipeline只使用其阶段配置，每个处理线程各持有一份副本
+    explicit BatchProcessor(const OperationGraph &pipeline);
+    BatchProcessor(const OperationGraph &pipeline, const Options &options);
+
+    // 处理files（完整路径），结果按相对inputRoot的路径写入outputRoot，子目录自动创建
+    // 单个文件失败只记录错误，不影响其他文件；control.cancelled返回true时尽快停止，
+    // control.progress每完成（或失败）一个文件调用一次，两者都在工作线程中调用
+    Result run(const QStringList &files, const QString &inputRoot, const QString &outputRoot,
+               const TileScheduler::Control &control = TileScheduler::Control());
+
+    // 文件夹中支持的图像文件（完整路径，按路径排序）
+    static QStringList findImages(const QString &directory, bool recursive = false);
+    static bool isSupportedImage(const QString &path);
+
+    // 与文件名无关的读写：文件内容经QFile读写，cv::imdecode/imencode编解码，路径可以包含非ASCII字符
+    // 失败时抛出std::runtime_error或cv::Exception
+    static cv::Mat readImage(const QString &path);
+    static void writeImage(const QString &path, const cv::Mat &image);
+
+    // 输出文件的路径：outputRoot加上file相对inputRoot的路径，outputFormat非空时替换扩展名
+    static QString outputPath(const QString &file, const QString &inputRoot, const QString &outputRoot,
+                              const QString &outputFormat);
+
+private:
+    struct Item;
+
+    // 未指定的线程数和队列容量按核数补全
+    static Options resolved(const Options &options);
+
+    OperationGraph m_pipeline;
+    Options m_options;
+};
+
+#endif // BATCHPROCESSOR_H
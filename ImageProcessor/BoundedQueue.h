@@ -0,0 +1,80 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// 线程安全的有界队列，用于流水线各级之间传递数据
+// 队列满时生产者阻塞，下游慢时上游自动减速，同时存在的数据量不超过容量
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+        : m_capacity(std::max<size_t>(1, capacity)), m_closed(false)
+    {
+    }
+
+    // 队列满时阻塞；队列已关闭时丢弃item并返回false
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed) {
+            return false;
+        }
+        m_items.push_back(std::move(item));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    // 队列空时阻塞；队列已关闭且已取空时返回false
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+        if (m_items.empty()) {
+            return false;
+        }
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // 生产者全部结束时调用：不再接受新数据，消费者取完剩余数据后pop返回false
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+    // 取消时调用：丢弃剩余数据并关闭，阻塞中的push和pop立即返回false
+    void abort()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.clear();
+        m_closed = true;
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+    const size_t m_capacity;
+    bool m_closed;
+    std::deque<T> m_items;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
+
+#endif // BOUNDEDQUEUE_H
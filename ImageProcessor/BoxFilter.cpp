@@ -0,0 +1,176 @@
+#include "BoxFilter.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+cv::Mat BoxFilter::apply(const cv::Mat &src, const cv::Size &kernel, const TileScheduler::Control &control,
+                         const HighPass &highPass)
+{
+    if (src.empty()) {
+        throw std::runtime_error("Input image is empty");
+    }
+    if (!supports(src)) {
+        throw std::invalid_argument("Box filter supports 8-bit, 16-bit and float images only");
+    }
+    if (kernel.width < 1 || kernel.height < 1
+        || kernel.width > MAX_KERNEL_SIZE || kernel.height > MAX_KERNEL_SIZE) {
+        throw std::invalid_argument("Box filter kernel size must be within [1, 32767]");
+    }
+
+    // 行带高度不小于核高的两倍，使每个行带初始化列累加和的开销不超过一半
+    const int bandHeight = std::max(static_cast<int>(MIN_BAND_HEIGHT), 2 * kernel.height);
+    const int bands = (src.rows + bandHeight - 1) / bandHeight;
+    const HighPass matched = highPass.matchedTo(src);
+
+    cv::Mat dst(src.size(), src.type());
+    TileScheduler::forEach(bands, [&](int index) {
+        const int y0 = index * bandHeight;
+        const int y1 = std::min(src.rows, y0 + bandHeight);
+        switch (src.depth()) {
+            case CV_8U:
+                filterBand<uchar, int, int64_t>(src, dst, y0, y1, kernel, matched);
+                break;
+            case CV_16U:
+                filterBand<ushort, int, int64_t>(src, dst, y0, y1, kernel, matched);
+                break;
+            default:
+                filterBand<float, double, double>(src, dst, y0, y1, kernel, matched);
+                break;
+        }
+    }, control);
+    return dst;
+}
+
+bool BoxFilter::supports(const cv::Mat &src)
+{
+    return src.depth() == CV_8U || src.depth() == CV_16U || src.depth() == CV_32F;
+}
+
+template <typename T, typename SumT, typename RowT>
+void BoxFilter::filterBand(const cv::Mat &src, cv::Mat &dst, int y0, int y1, const cv::Size &kernel,
+                           const HighPass &highPass)
+{
+    const int channels = src.channels();
+    const int width = src.cols * channels;
+    const int anchorX = kernel.width / 2;
+    const int anchorY = kernel.height / 2;
+    const double scale = 1.0 / (static_cast<double>(kernel.width) * kernel.height);
+    auto sourceRow = [&](int y) {
+        return src.ptr<T>(cv::borderInterpolate(y, src.rows, cv::BORDER_REFLECT_101));
+    };
+
+    // 第y0行窗口覆盖的各行先累加到列累加和
+    std::vector<SumT> sums(width, 0);
+    for (int dy = 0; dy < kernel.height; ++dy) {
+        const T *row = sourceRow(y0 - anchorY + dy);
+        for (int i = 0; i < width; ++i) {
+            sums[i] += row[i];
+        }
+    }
+
+    // 行方向延拓后的每个位置对应的原始列，所有行共用
+    const int extendedColumns = src.cols + kernel.width - 1;
+    std::vector<int> columnIndex(extendedColumns);
+    for (int x = 0; x < extendedColumns; ++x) {
+        columnIndex[x] = cv::borderInterpolate(x - anchorX, src.cols, cv::BORDER_REFLECT_101) * channels;
+    }
+    std::vector<SumT> extended(static_cast<size_t>(extendedColumns) * channels);
+
+    for (int y = y0; y < y1; ++y) {
+        for (int x = 0; x < extendedColumns; ++x) {
+            std::copy_n(&sums[columnIndex[x]], channels, &extended[static_cast<size_t>(x) * channels]);
+        }
+
+        T *out = dst.ptr<T>(y);
+        const T *original = highPass.isEnabled() ? highPass.original().ptr<T>(y) : nullptr;
+        auto write = [&](int i, RowT sum) {
+            const double mean = sum * scale;
+            out[i] = original ? highPass.combine(original[i], mean) : cv::saturate_cast<T>(mean);
+        };
+
+        for (int c = 0; c < channels; ++c) {
+            const SumT *column = &extended[c];
+            RowT sum = 0;
+            for (int x = 0; x < kernel.width; ++x) {
+                sum += column[x * channels];
+            }
+            write(c, sum);
+            for (int x = 1; x < src.cols; ++x) {
+                sum += column[(x + kernel.width - 1) * channels];
+                sum -= column[(x - 1) * channels];
+                write(x * channels + c, sum);
+            }
+        }
+
+        if (y + 1 < y1) {
+            slideColumnSums(sums.data(), sourceRow(y + 1 - anchorY + kernel.height - 1),
+                            sourceRow(y - anchorY), width);
+        }
+    }
+}
+
+void BoxFilter::slideColumnSums(int *sums, const uchar *added, const uchar *removed, int n)
+{
+    int i = 0;
+#if CV_SIMD128
+    for (; i <= n - cv::v_uint8x16::nlanes; i += cv::v_uint8x16::nlanes) {
+        cv::v_uint16x8 addedLow, addedHigh, removedLow, removedHigh;
+        cv::v_expand(cv::v_load(added + i), addedLow, addedHigh);
+        cv::v_expand(cv::v_load(removed + i), removedLow, removedHigh);
+        // 差值在[-255, 255]之间，16位有符号数即可表示
+        const cv::v_int16x8 low = cv::v_reinterpret_as_s16(addedLow) - cv::v_reinterpret_as_s16(removedLow);
+        const cv::v_int16x8 high = cv::v_reinterpret_as_s16(addedHigh) - cv::v_reinterpret_as_s16(removedHigh);
+
+        cv::v_int32x4 d0, d1, d2, d3;
+        cv::v_expand(low, d0, d1);
+        cv::v_expand(high, d2, d3);
+        cv::v_store(sums + i, cv::v_load(sums + i) + d0);
+        cv::v_store(sums + i + 4, cv::v_load(sums + i + 4) + d1);
+        cv::v_store(sums + i + 8, cv::v_load(sums + i + 8) + d2);
+        cv::v_store(sums + i + 12, cv::v_load(sums + i + 12) + d3);
+    }
+#endif
+    for (; i < n; ++i) {
+        sums[i] += static_cast<int>(added[i]) - static_cast<int>(removed[i]);
+    }
+}
+
+void BoxFilter::slideColumnSums(int *sums, const ushort *added, const ushort *removed, int n)
+{
+    int i = 0;
+#if CV_SIMD128
+    for (; i <= n - cv::v_uint16x8::nlanes; i += cv::v_uint16x8::nlanes) {
+        cv::v_uint32x4 addedLow, addedHigh, removedLow, removedHigh;
+        cv::v_expand(cv::v_load(added + i), addedLow, addedHigh);
+        cv::v_expand(cv::v_load(removed + i), removedLow, removedHigh);
+        const cv::v_int32x4 low = cv::v_reinterpret_as_s32(addedLow) - cv::v_reinterpret_as_s32(removedLow);
+        const cv::v_int32x4 high = cv::v_reinterpret_as_s32(addedHigh) - cv::v_reinterpret_as_s32(removedHigh);
+        cv::v_store(sums + i, cv::v_load(sums + i) + low);
+        cv::v_store(sums + i + 4, cv::v_load(sums + i + 4) + high);
+    }
+#endif
+    for (; i < n; ++i) {
+        sums[i] += static_cast<int>(added[i]) - static_cast<int>(removed[i]);
+    }
+}
+
+void BoxFilter::slideColumnSums(double *sums, const float *added, const float *removed, int n)
+{
+    int i = 0;
+#if CV_SIMD128_64F
+    for (; i <= n - cv::v_float32x4::nlanes; i += cv::v_float32x4::nlanes) {
+        const cv::v_float32x4 a = cv::v_load(added + i);
+        const cv::v_float32x4 r = cv::v_load(removed + i);
+        // 先转换为双精度再相减，避免大数相消的误差累积
+        const cv::v_float64x2 low = cv::v_cvt_f64(a) - cv::v_cvt_f64(r);
+        const cv::v_float64x2 high = cv::v_cvt_f64_high(a) - cv::v_cvt_f64_high(r);
+        cv::v_store(sums + i, cv::v_load(sums + i) + low);
+        cv::v_store(sums + i + 2, cv::v_load(sums + i + 2) + high);
+    }
+#endif
+    for (; i < n; ++i) {
+        sums[i] += static_cast<double>(added[i]) - static_cast<double>(removed[i]);
+    }
+}
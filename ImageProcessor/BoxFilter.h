@@ -0,0 +1,40 @@
+#ifndef BOXFILTER_H
+#define BOXFILTER_H
+
+#include <opencv2/core.hpp>
+#include "HighPass.h"
+#include "TileScheduler.h"
+
+// 滑动和均值滤波：先按列累加核高范围内的行，再沿行用滑动和求核宽范围内的均值
+// 窗口每移动一步只加入一个、移出一个像素，每像素的运算量与核大小无关；支持矩形核
+// 图像按行带并行，每个行带独立初始化列累加和；边界处理与cv::blur的默认方式（BORDER_REFLECT_101）一致
+class BoxFilter
+{
+public:
+    // 支持8U、16U、32F，任意通道数；输出与输入类型相同
+    // 核的宽高可以是任意正数（不要求奇数），超过图像尺寸时按反射边界继续延拓
+    // highPass启用时直接输出高通结果，均值不经过取整
+    static cv::Mat apply(const cv::Mat &src, const cv::Size &kernel,
+                         const TileScheduler::Control &control = TileScheduler::Control(),
+                         const HighPass &highPass = HighPass());
+
+    static bool supports(const cv::Mat &src);
+
+    // 列累加和为32位整数，16位输入时核高不能超过该值
+    static const int MAX_KERNEL_SIZE = 32767;
+
+private:
+    // 计算[y0, y1)行的结果：T为像素类型，SumT为列累加和类型，RowT为行方向滑动和类型
+    template <typename T, typename SumT, typename RowT>
+    static void filterBand(const cv::Mat &src, cv::Mat &dst, int y0, int y1, const cv::Size &kernel,
+                           const HighPass &highPass);
+
+    // 列累加和下移一行：加入added行，移出removed行（SIMD）
+    static void slideColumnSums(int *sums, const uchar *added, const uchar *removed, int n);
+    static void slideColumnSums(int *sums, const ushort *added, const ushort *removed, int n);
+    static void slideColumnSums(double *sums, const float *added, const float *removed, int n);
+
+    static const int MIN_BAND_HEIGHT = 128;
+};
+
+#endif // BOXFILTER_H
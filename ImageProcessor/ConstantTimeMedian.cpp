@@ -0,0 +1,345 @@
+#include "ConstantTimeMedian.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// 各列的细直方图：总区间数不超过4096时连续存放；
+// 否则（16位的256x256两级直方图）每列只为计数非零的粗区间分配细直方图，
+// 计数归零的区间全为0，直接放回空闲列表复用，不需要清零整列的65536项
+template <int CoarseBits, int FineBits, bool Sparse = (CoarseBits + FineBits > 12)>
+class MedianFineColumns
+{
+public:
+    explicit MedianFineColumns(int columns)
+        : m_bins(static_cast<size_t>(columns) << (CoarseBits + FineBits), 0)
+    {
+    }
+
+    void add(int c, int v) { ++m_bins[index(c, v)]; }
+    void remove(int c, int v, bool) { --m_bins[index(c, v)]; }
+
+    const ushort* at(int c, int bin) const
+    {
+        return &m_bins[index(c, bin << FineBits)];
+    }
+
+private:
+    static size_t index(int c, int v)
+    {
+        return (static_cast<size_t>(c) << (CoarseBits + FineBits)) + v;
+    }
+
+    std::vector<ushort> m_bins;
+};
+
+template <int CoarseBits, int FineBits>
+class MedianFineColumns<CoarseBits, FineBits, true>
+{
+public:
+    explicit MedianFineColumns(int columns)
+        : m_blocks(static_cast<size_t>(columns) << CoarseBits, -1)
+        , m_zero(1 << FineBits, 0)
+    {
+    }
+
+    void add(int c, int v)
+    {
+        int &block = m_blocks[slot(c, v)];
+        if (block < 0) {
+            if (m_free.empty()) {
+                block = static_cast<int>(m_pool.size() >> FineBits);
+                m_pool.resize(m_pool.size() + (1 << FineBits), 0);
+            } else {
+                block = m_free.back();
+                m_free.pop_back();
+            }
+        }
+        ++m_pool[(static_cast<size_t>(block) << FineBits) + (v & ((1 << FineBits) - 1))];
+    }
+
+    // emptied为真表示该列这个粗区间的计数已归零，细直方图放回空闲列表
+    void remove(int c, int v, bool emptied)
+    {
+        int &block = m_blocks[slot(c, v)];
+        --m_pool[(static_cast<size_t>(block) << FineBits) + (v & ((1 << FineBits) - 1))];
+        if (emptied) {
+            m_free.push_back(block);
+            block = -1;
+        }
+    }
+
+    // 返回的指针在下一次add之前有效
+    const ushort* at(int c, int bin) const
+    {
+        const int block = m_blocks[(static_cast<size_t>(c) << CoarseBits) + bin];
+        return block < 0 ? m_zero.data() : &m_pool[static_cast<size_t>(block) << FineBits];
+    }
+
+private:
+    static size_t slot(int c, int v)
+    {
+        return (static_cast<size_t>(c) << CoarseBits) + (v >> FineBits);
+    }
+
+    std::vector<int> m_blocks;    // 每列每个粗区间的细直方图在m_pool中的编号，-1表示未分配
+    std::vector<ushort> m_pool;
+    std::vector<int> m_free;
+    std::vector<ushort> m_zero;
+};
+
+cv::Mat ConstantTimeMedian::apply(const cv::Mat &src, int kernelSize, const TileScheduler::Control &control,
+                                  const HighPass &highPass)
+{
+    if (src.empty()) {
+        throw std::runtime_error("Input image is empty");
+    }
+    if (!supports(src)) {
+        throw std::invalid_argument("Constant-time median supports 8-bit and 16-bit images only");
+    }
+    if (kernelSize % 2 == 0 || kernelSize < 3 || kernelSize > MAX_KERNEL_SIZE) {
+        throw std::invalid_argument("Median kernel size must be odd and within [3, 255]");
+    }
+
+    const int radius = kernelSize / 2;
+    cv::Mat input = src;
+    PlaneFilter filter = &ConstantTimeMedian::filterPlane<uchar, 4, 4>;
+
+    // 16位图像先按出现的灰度值排序编号，中值的次序不变，直方图只需覆盖实际出现的值：
+    // 不超过256个值时按8位处理，不超过4096个值时用64x64两级直方图，否则直接用256x256两级直方图
+    std::vector<ushort> values;
+    if (src.depth() == CV_16U) {
+        const int width = src.cols * src.channels();
+        std::vector<int> ranks(65536, 0);
+        for (int y = 0; y < src.rows; ++y) {
+            const ushort *row = src.ptr<ushort>(y);
+            for (int x = 0; x < width; ++x) {
+                ranks[row[x]] = 1;
+            }
+        }
+        for (int v = 0; v < 65536; ++v) {
+            if (ranks[v]) {
+                ranks[v] = static_cast<int>(values.size());
+                values.push_back(static_cast<ushort>(v));
+            }
+        }
+
+        if (values.size() <= 4096) {
+            const bool narrow = values.size() <= 256;
+            input.create(src.size(), CV_MAKETYPE(narrow ? CV_8U : CV_16U, src.channels()));
+            for (int y = 0; y < src.rows; ++y) {
+                const ushort *row = src.ptr<ushort>(y);
+                if (narrow) {
+                    uchar *out = input.ptr<uchar>(y);
+                    for (int x = 0; x < width; ++x) {
+                        out[x] = static_cast<uchar>(ranks[row[x]]);
+                    }
+                } else {
+                    ushort *out = input.ptr<ushort>(y);
+                    for (int x = 0; x < width; ++x) {
+                        out[x] = static_cast<ushort>(ranks[row[x]]);
+                    }
+                }
+            }
+            if (!narrow) {
+                filter = &ConstantTimeMedian::filterPlane<ushort, 6, 6>;
+            }
+        } else {
+            values.clear();
+            filter = &ConstantTimeMedian::filterPlane<ushort, 8, 8>;
+        }
+    }
+
+    // 编号还原为原始值、合成高通都在块内完成，结果直接写入输入类型的目标矩阵
+    const HighPass matched = highPass.matchedTo(src);
+    cv::Mat dst;
+    TileScheduler::run(input, dst, src.type(), radius,
+        [radius, filter, &values, &matched, &control](const cv::Mat &tileInput, const cv::Rect &inner,
+                                                      cv::Mat &output) {
+            // 块内部边缘由halo提供真实像素，图像边缘处补足复制的边缘像素
+            cv::Mat padded;
+            cv::copyMakeBorder(tileInput, padded,
+                               radius - inner.y, radius - (tileInput.rows - inner.y - inner.height),
+                               radius - inner.x, radius - (tileInput.cols - inner.x - inner.width),
+                               cv::BORDER_REPLICATE);
+
+            cv::Mat filtered = values.empty() ? output : cv::Mat(output.size(), padded.type());
+            if (padded.channels() == 1) {
+                filter(padded, filtered, radius, control);
+            } else {
+                cv::Mat plane;
+                cv::Mat result(output.size(), padded.depth());
+                for (int c = 0; c < padded.channels(); ++c) {
+                    cv::extractChannel(padded, plane, c);
+                    filter(plane, result, radius, control);
+                    cv::insertChannel(result, filtered, c);
+                }
+            }
+
+            if (!values.empty()) {
+                // 编号还原为原始的16位值
+                const int width = output.cols * output.channels();
+                for (int y = 0; y < output.rows; ++y) {
+                    ushort *out = output.ptr<ushort>(y);
+                    if (filtered.depth() == CV_8U) {
+                        const uchar *row = filtered.ptr<uchar>(y);
+                        for (int x = 0; x < width; ++x) {
+                            out[x] = values[row[x]];
+                        }
+                    } else {
+                        const ushort *row = filtered.ptr<ushort>(y);
+                        for (int x = 0; x < width; ++x) {
+                            out[x] = values[row[x]];
+                        }
+                    }
+                }
+            }
+
+            if (matched.isEnabled()) {
+                matched.combine(matched.original()(TileScheduler::tileRect(output)), output, output);
+            }
+        }, control);
+    return dst;
+}
+
+bool ConstantTimeMedian::supports(const cv::Mat &src)
+{
+    return src.depth() == CV_8U || src.depth() == CV_16U;
+}
+
+template <typename T, int CoarseBits, int FineBits>
+void ConstantTimeMedian::filterPlane(const cv::Mat &padded, cv::Mat &dst, int radius,
+                                     const TileScheduler::Control &control)
+{
+    // 按列分条处理，条宽由每移动一列都要访问的粗直方图决定，使一条内的粗直方图保持在缓存中（通常一块一条）；
+    // 细直方图只在中值所在的区间访问，不计入。每行开始时细直方图都要由diameter列重新累加，
+    // 条宽不小于核直径时这一开销分摊到每个输出像素为常数
+    const int histogramBytes = static_cast<int>((1 << CoarseBits) * sizeof(ushort));
+    const int stripWidth = std::max(2 * radius + 1, TileScheduler::TARGET_TILE_BYTES / histogramBytes - 2 * radius);
+
+    for (int x0 = 0; x0 < dst.cols; x0 += stripWidth) {
+        filterStrip<T, CoarseBits, FineBits>(padded, dst, x0, std::min(stripWidth, dst.cols - x0), radius, control);
+    }
+}
+
+template <typename T, int CoarseBits, int FineBits>
+void ConstantTimeMedian::filterStrip(const cv::Mat &padded, cv::Mat &dst, int x0, int width, int radius,
+                                     const TileScheduler::Control &control)
+{
+    const int coarseBins = 1 << CoarseBits;
+    const int fineBins = 1 << FineBits;
+    const int bins = coarseBins * fineBins;
+    const int diameter = 2 * radius + 1;
+    const int columns = width + 2 * radius;
+    const int target = diameter * diameter / 2;  // 中值在核内的次序（从0开始）
+
+    // 每列覆盖当前行上下radius行的直方图
+    std::vector<ushort> columnCoarse(static_cast<size_t>(columns) * coarseBins, 0);
+    MedianFineColumns<CoarseBits, FineBits> columnFine(columns);
+    auto columnCoarseAt = [&](int c) { return &columnCoarse[static_cast<size_t>(c) * coarseBins]; };
+    auto columnFineAt = [&](int c, int bin) { return columnFine.at(c, bin); };
+
+    for (int dy = 0; dy < diameter; ++dy) {
+        const T *row = padded.ptr<T>(dy) + x0;
+        for (int c = 0; c < columns; ++c) {
+            const int v = row[c];
+            ++columnCoarseAt(c)[v >> FineBits];
+            columnFine.add(c, v);
+        }
+    }
+
+    // 核直方图：粗直方图每移动一列都更新，细直方图只在中值落入该区间时才追上当前位置
+    std::vector<ushort> coarse(coarseBins);
+    std::vector<ushort> fine(bins);
+    std::vector<int> fineStart(coarseBins);
+
+    for (int y = 0; y < dst.rows; ++y) {
+        if (control.cancelled && control.cancelled()) {
+            throw TileScheduler::Cancelled();
+        }
+
+        if (y > 0) {
+            const T *removed = padded.ptr<T>(y - 1) + x0;
+            const T *added = padded.ptr<T>(y + 2 * radius) + x0;
+            for (int c = 0; c < columns; ++c) {
+                const int oldValue = removed[c];
+                const int newValue = added[c];
+                ushort *columnHistogram = columnCoarseAt(c);
+                --columnHistogram[oldValue >> FineBits];
+                ++columnHistogram[newValue >> FineBits];
+                // 先加后减，新旧值在同一粗区间时细直方图不会被提前释放
+                columnFine.add(c, newValue);
+                columnFine.remove(c, oldValue, columnHistogram[oldValue >> FineBits] == 0);
+            }
+        }
+
+        std::fill(coarse.begin(), coarse.end(), 0);
+        for (int c = 0; c < diameter; ++c) {
+            addHistogram(coarse.data(), columnCoarseAt(c), coarseBins);
+        }
+        // 每行开始时所有细直方图都失效
+        std::fill(fineStart.begin(), fineStart.end(), -diameter);
+
+        T *out = dst.ptr<T>(y) + x0;
+        for (int i = 0; i < width; ++i) {
+            if (i > 0) {
+                slideHistogram(coarse.data(), columnCoarseAt(i + 2 * radius), columnCoarseAt(i - 1), coarseBins);
+            }
+
+            int sum = 0;
+            int bin = 0;
+            while (sum + coarse[bin] <= target) {
+                sum += coarse[bin++];
+            }
+
+            ushort *binFine = &fine[bin * fineBins];
+            int &start = fineStart[bin];
+            if (i - start >= diameter) {
+                // 与上次更新的窗口没有重叠，重新累加
+                std::fill(binFine, binFine + fineBins, 0);
+                for (int c = i; c < i + diameter; ++c) {
+                    addHistogram(binFine, columnFineAt(c, bin), fineBins);
+                }
+            } else {
+                for (; start < i; ++start) {
+                    slideHistogram(binFine, columnFineAt(start + diameter, bin), columnFineAt(start, bin), fineBins);
+                }
+            }
+            start = i;
+
+            int value = 0;
+            while (sum + binFine[value] <= target) {
+                sum += binFine[value++];
+            }
+            out[i] = static_cast<T>((bin << FineBits) | value);
+        }
+    }
+}
+
+void ConstantTimeMedian::addHistogram(ushort *dst, const ushort *src, int bins)
+{
+    int i = 0;
+#if CV_SIMD128
+    for (; i <= bins - cv::v_uint16x8::nlanes; i += cv::v_uint16x8::nlanes) {
+        cv::v_store(dst + i, cv::v_add_wrap(cv::v_load(dst + i), cv::v_load(src + i)));
+    }
+#endif
+    for (; i < bins; ++i) {
+        dst[i] = static_cast<ushort>(dst[i] + src[i]);
+    }
+}
+
+void ConstantTimeMedian::slideHistogram(ushort *dst, const ushort *added, const ushort *removed, int bins)
+{
+    int i = 0;
+#if CV_SIMD128
+    for (; i <= bins - cv::v_uint16x8::nlanes; i += cv::v_uint16x8::nlanes) {
+        const cv::v_uint16x8 sum = cv::v_add_wrap(cv::v_load(dst + i), cv::v_load(added + i));
+        cv::v_store(dst + i, cv::v_sub_wrap(sum, cv::v_load(removed + i)));
+    }
+#endif
+    for (; i < bins; ++i) {
+        dst[i] = static_cast<ushort>(dst[i] + added[i] - removed[i]);
+    }
+}
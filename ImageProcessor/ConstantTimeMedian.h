@@ -0,0 +1,44 @@
+#ifndef CONSTANTTIMEMEDIAN_H
+#define CONSTANTTIMEMEDIAN_H
+
+#include <opencv2/core.hpp>
+#include "HighPass.h"
+#include "TileScheduler.h"
+
+// 常数时间中值滤波（Perreault & Hébert, 2007）
+// 每列维护一个直方图，核直方图随窗口右移只加一列、减一列，与核大小无关；
+// 直方图分为粗细两级，先在粗直方图中定位中值所在的区间，只有该区间的细直方图才需要更新
+// 支持8位和16位，任意通道数，边界按复制边缘像素处理（与cv::medianBlur一致）
+class ConstantTimeMedian
+{
+public:
+    // 核大小必须是3到MAX_KERNEL_SIZE之间的奇数，否则抛出std::invalid_argument
+    // highPass启用时每块滤波后立即合成高通结果
+    static cv::Mat apply(const cv::Mat &src, int kernelSize,
+                         const TileScheduler::Control &control = TileScheduler::Control(),
+                         const HighPass &highPass = HighPass());
+
+    static bool supports(const cv::Mat &src);
+
+    // 直方图计数为16位，核内像素数不能超过65535
+    static const int MAX_KERNEL_SIZE = 255;
+
+private:
+    // 对单通道平面滤波：padded为四周各扩展radius个像素的输入，结果写入dst
+    using PlaneFilter = void (*)(const cv::Mat &padded, cv::Mat &dst, int radius,
+                                 const TileScheduler::Control &control);
+
+    // 像素值的高CoarseBits位为粗直方图区间，低FineBits位为区间内的细直方图
+    template <typename T, int CoarseBits, int FineBits>
+    static void filterPlane(const cv::Mat &padded, cv::Mat &dst, int radius,
+                            const TileScheduler::Control &control);
+    template <typename T, int CoarseBits, int FineBits>
+    static void filterStrip(const cv::Mat &padded, cv::Mat &dst, int x0, int width, int radius,
+                            const TileScheduler::Control &control);
+
+    // 直方图逐项相加、相减（SIMD）
+    static void addHistogram(ushort *dst, const ushort *src, int bins);
+    static void slideHistogram(ushort *dst, const ushort *added, const ushort *removed, int bins);
+};
+
+#endif // CONSTANTTIMEMEDIAN_H
@@ -0,0 +1,58 @@
+#include "HighPass.h"
+#include <stdexcept>
+
+HighPass::HighPass(const cv::Mat &original, double gain, double offset)
+    : m_original(original), m_gain(gain), m_offset(offset)
+{
+}
+
+bool HighPass::isEnabled() const
+{
+    return !m_original.empty();
+}
+
+const cv::Mat& HighPass::original() const
+{
+    return m_original;
+}
+
+double HighPass::gain() const
+{
+    return m_gain;
+}
+
+double HighPass::offset() const
+{
+    return m_offset;
+}
+
+HighPass HighPass::matchedTo(const cv::Mat &src) const
+{
+    if (!isEnabled() || (m_original.type() == src.type() && m_original.size() == src.size())) {
+        return *this;
+    }
+    if (m_original.size() != src.size() || m_original.channels() != src.channels()) {
+        throw std::runtime_error("Image dimension or channel mismatch");
+    }
+
+    // 8位与16位之间按量程换算，不直接饱和
+    double scale = 1.0;
+    if (m_original.depth() == CV_16U && src.depth() == CV_8U) {
+        scale = 1.0 / 257.0;
+    } else if (m_original.depth() == CV_8U && src.depth() == CV_16U) {
+        scale = 257.0;
+    }
+    cv::Mat converted;
+    m_original.convertTo(converted, src.type(), scale);
+    return HighPass(converted, m_gain, m_offset);
+}
+
+void HighPass::combine(const cv::Mat &original, const cv::Mat &filtered, cv::Mat &output) const
+{
+    if (m_gain == 1.0 && m_offset == 0.0) {
+        // 默认参数与原来的cv::subtract语义完全一致
+        cv::subtract(original, filtered, output, cv::noArray(), output.depth());
+        return;
+    }
+    cv::addWeighted(original, m_gain, filtered, -m_gain, m_offset, output, output.depth());
+}
@@ -0,0 +1,41 @@
+#ifndef HIGHPASS_H
+#define HIGHPASS_H
+
+#include <opencv2/core.hpp>
+
+// 融合的高通（“从原图中减去”）：result = gain * (original - filtered) + offset，饱和到原图类型
+// 滤波函数在写出每个结果时直接合成高通，不再生成完整的滤波图像后再整幅相减
+// 默认构造为未启用，滤波函数照常输出滤波结果
+class HighPass
+{
+public:
+    HighPass() = default;
+    explicit HighPass(const cv::Mat &original, double gain = 1.0, double offset = 0.0);
+
+    bool isEnabled() const;
+    const cv::Mat& original() const;
+    double gain() const;
+    double offset() const;
+
+    // 检查原图与滤波输入的尺寸、通道数是否一致（不一致时抛出异常），深度不同时转换为输入的深度（8位与16位之间按量程换算）
+    HighPass matchedTo(const cv::Mat &src) const;
+
+    // 合成一块：output = gain * (original - filtered) + offset，只舍入一次
+    // filtered的通道数与original相同，深度可以不同（如浮点的中间结果）；
+    // output已分配为与original相同的尺寸和类型（可以与filtered共用内存）
+    void combine(const cv::Mat &original, const cv::Mat &filtered, cv::Mat &output) const;
+
+    // 单个值的合成，filtered为未取整的滤波结果
+    template <typename T>
+    T combine(T original, double filtered) const
+    {
+        return cv::saturate_cast<T>(m_gain * (static_cast<double>(original) - filtered) + m_offset);
+    }
+
+private:
+    cv::Mat m_original;
+    double m_gain = 1.0;
+    double m_offset = 0.0;
+};
+
+#endif // HIGHPASS_H
@@ -0,0 +1,322 @@
+#include "ImageCore.h"
+#include "ImageOperations.h"
+#include "ImageStatistics.h"
+#include "OperationGraph.h"
+#include "RoiRasterizer.h"
+#include "SummedAreaTable.h"
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+static int matType(ImageCore::PixelFormat format)
+{
+    switch (format) {
+    case ImageCore::Gray8:
+        return CV_8UC1;
+    case ImageCore::Gray16:
+        return CV_16UC1;
+    case ImageCore::BGR888:
+    case ImageCore::RGB888:
+        return CV_8UC3;
+    case ImageCore::BGRA8888:
+    case ImageCore::RGBA8888:
+        return CV_8UC4;
+    }
+    throw std::invalid_argument("Unknown pixel format");
+}
+
+static bool isRgbOrder(ImageCore::PixelFormat format)
+{
+    return format == ImageCore::RGB888 || format == ImageCore::RGBA8888;
+}
+
+// 缓冲区的cv::Mat视图，不复制数据
+static cv::Mat view(const ImageCore::Buffer &buffer)
+{
+    if (!buffer.data || buffer.width <= 0 || buffer.height <= 0) {
+        throw std::invalid_argument("Buffer is empty");
+    }
+    const size_t rowBytes = buffer.width * ImageCore::bytesPerPixel(buffer.format);
+    if (buffer.stride != 0 && buffer.stride < rowBytes) {
+        throw std::invalid_argument("Buffer stride is smaller than a row");
+    }
+    return cv::Mat(buffer.height, buffer.width, matType(buffer.format), buffer.data,
+                   buffer.stride != 0 ? buffer.stride : rowBytes);
+}
+
+static void checkSameShape(const ImageCore::Buffer &src, const ImageCore::Buffer &dst)
+{
+    if (src.width != dst.width || src.height != dst.height || src.format != dst.format) {
+        throw std::invalid_argument("Destination must have the size and format of the source");
+    }
+}
+
+static void checkKernelSize(int kernelSize, int maxKernelSize)
+{
+    if (kernelSize < 1 || kernelSize % 2 == 0 || kernelSize > maxKernelSize) {
+        throw std::invalid_argument("Kernel size must be an odd number within [1, "
+                                    + std::to_string(maxKernelSize) + "]");
+    }
+}
+
+// 运算结果写入目标缓冲区；原地运算返回输入本身时不需要复制
+static void writeResult(const cv::Mat &result, const ImageCore::Buffer &dst)
+{
+    cv::Mat target = view(dst);
+    if (result.size() != target.size() || result.type() != target.type()) {
+        throw std::invalid_argument("Destination does not match the result");
+    }
+    if (result.data != target.data) {
+        result.copyTo(target);
+    }
+}
+
+static ImageCore::Statistics fromChannel(const ImageStatistics::Channel &channel)
+{
+    ImageCore::Statistics statistics;
+    statistics.count = channel.count;
+    statistics.mean = channel.mean();
+    statistics.variance = channel.variance();
+    statistics.min = channel.min;
+    statistics.max = channel.max;
+    statistics.histogram = channel.histogram;
+    return statistics;
+}
+
+static ImageCore::Statistics fromMoments(const SummedAreaTable::Moments &moments)
+{
+    ImageCore::Statistics statistics;
+    statistics.count = moments.count;
+    statistics.mean = moments.mean();
+    statistics.variance = moments.variance();
+    return statistics;
+}
+
+// 只对区域的包围盒建积分图，段的坐标换算到包围盒内
+static ImageCore::Statistics spanStatistics(const ImageCore::Buffer &src, RoiRasterizer::Spans spans)
+{
+    if (spans.empty()) {
+        return ImageCore::Statistics();
+    }
+    cv::Rect bounds(spans.front().x0, spans.front().y, 0, 0);
+    int right = spans.front().x1;
+    for (const RoiRasterizer::Span &s : spans) {
+        bounds.x = std::min(bounds.x, s.x0);
+        right = std::max(right, s.x1);
+    }
+    bounds.width = right - bounds.x;
+    bounds.height = spans.back().y - bounds.y + 1;
+    for (RoiRasterizer::Span &s : spans) {
+        s.y -= bounds.y;
+        s.x0 -= bounds.x;
+        s.x1 -= bounds.x;
+    }
+
+    const SummedAreaTable table(view(src)(bounds), isRgbOrder(src.format));
+    return fromMoments(table.spans(spans));
+}
+
+ImageCore::Buffer ImageCore::Image::buffer()
+{
+    Buffer result;
+    result.data = pixels.empty() ? nullptr : pixels.data();
+    result.width = width;
+    result.height = height;
+    result.stride = width * bytesPerPixel(format);
+    result.format = format;
+    return result;
+}
+
+size_t ImageCore::bytesPerPixel(PixelFormat format)
+{
+    switch (format) {
+    case Gray8:
+        return 1;
+    case Gray16:
+        return 2;
+    case BGR888:
+    case RGB888:
+        return 3;
+    case BGRA8888:
+    case RGBA8888:
+        return 4;
+    }
+    throw std::invalid_argument("Unknown pixel format");
+}
+
+void ImageCore::toGrayscale(const Buffer &src, const Buffer &dst)
+{
+    const PixelFormat expected = src.format == Gray16 ? Gray16 : Gray8;
+    if (dst.width != src.width || dst.height != src.height || dst.format != expected) {
+        throw std::invalid_argument("Destination must be a gray buffer of the source size");
+    }
+
+    const cv::Mat input = view(src);
+    cv::Mat output = view(dst);
+    switch (src.format) {
+    case Gray8:
+    case Gray16:
+        writeResult(input, dst);
+        break;
+    case BGR888:
+        cv::cvtColor(input, output, cv::COLOR_BGR2GRAY);
+        break;
+    case RGB888:
+        cv::cvtColor(input, output, cv::COLOR_RGB2GRAY);
+        break;
+    case BGRA8888:
+        cv::cvtColor(input, output, cv::COLOR_BGRA2GRAY);
+        break;
+    case RGBA8888:
+        cv::cvtColor(input, output, cv::COLOR_RGBA2GRAY);
+        break;
+    }
+}
+
+void ImageCore::meanFilter(const Buffer &src, const Buffer &dst, int kernelSize)
+{
+    checkSameShape(src, dst);
+    checkKernelSize(kernelSize, ImageOperations::MAX_MEAN_KERNEL_SIZE);
+    writeResult(ImageOperations::meanFilter(view(src), kernelSize), dst);
+}
+
+void ImageCore::gaussianFilter(const Buffer &src, const Buffer &dst, int kernelSize, double sigma)
+{
+    checkSameShape(src, dst);
+    // 核大小为0时由sigma决定
+    if (kernelSize != 0) {
+        checkKernelSize(kernelSize, ImageOperations::MAX_GAUSSIAN_KERNEL_SIZE);
+    }
+    if (sigma <= 0.0) {
+        throw std::invalid_argument("Sigma must be positive");
+    }
+    writeResult(ImageOperations::gaussianFilter(view(src), kernelSize, sigma), dst);
+}
+
+void ImageCore::medianFilter(const Buffer &src, const Buffer &dst, int kernelSize)
+{
+    checkSameShape(src, dst);
+    checkKernelSize(kernelSize, ImageOperations::MAX_MEDIAN_KERNEL_SIZE);
+    writeResult(ImageOperations::medianFilter(view(src), kernelSize), dst);
+}
+
+void ImageCore::linearTransform(const Buffer &src, const Buffer &dst, int kValue, int bValue)
+{
+    checkSameShape(src, dst);
+    writeResult(ImageOperations::linearTransform(view(src), kValue, bValue), dst);
+}
+
+void ImageCore::gammaContrast(const Buffer &src, const Buffer &dst, double gamma, int contrast)
+{
+    checkSameShape(src, dst);
+    if (gamma <= 0.0) {
+        throw std::invalid_argument("Gamma must be positive");
+    }
+    writeResult(ImageOperations::gammaContrast(view(src), gamma, contrast), dst);
+}
+
+void ImageCore::equalizeHistogram(const Buffer &src, const Buffer &dst)
+{
+    checkSameShape(src, dst);
+    if (src.format != Gray8 && src.format != BGR888 && src.format != RGB888) {
+        throw std::invalid_argument("Histogram equalization needs a Gray8, BGR888 or RGB888 buffer");
+    }
+    if (src.format != RGB888) {
+        writeResult(ImageOperations::equalizeHistogram(view(src)), dst);
+        return;
+    }
+
+    // 亮度按BGR顺序计算，RGB缓冲区先交换通道
+    cv::Mat bgr;
+    cv::cvtColor(view(src), bgr, cv::COLOR_RGB2BGR);
+    cv::Mat output = view(dst);
+    cv::cvtColor(ImageOperations::equalizeHistogram(bgr), output, cv::COLOR_BGR2RGB);
+}
+
+ImageCore::Statistics ImageCore::statistics(const Buffer &src)
+{
+    return fromChannel(ImageStatistics::compute(view(src), isRgbOrder(src.format)).gray());
+}
+
+ImageCore::Statistics ImageCore::rectStatistics(const Buffer &src, int x, int y, int width, int height)
+{
+    const cv::Rect rect = cv::Rect(x, y, width, height) & cv::Rect(0, 0, src.width, src.height);
+    if (rect.empty()) {
+        return Statistics();
+    }
+    const SummedAreaTable table(view(src)(rect), isRgbOrder(src.format));
+    return fromMoments(table.rect(cv::Rect(0, 0, rect.width, rect.height)));
+}
+
+ImageCore::Statistics ImageCore::circleStatistics(const Buffer &src, int centerX, int centerY, int radius)
+{
+    return spanStatistics(src, RoiRasterizer::circle(cv::Point(centerX, centerY), radius,
+                                                     cv::Size(src.width, src.height)));
+}
+
+ImageCore::Statistics ImageCore::polygonStatistics(const Buffer &src, const std::vector<int> &points)
+{
+    if (points.size() % 2 != 0) {
+        throw std::invalid_argument("Polygon points must be x, y pairs");
+    }
+    std::vector<cv::Point> polygon;
+    polygon.reserve(points.size() / 2);
+    for (size_t i = 0; i < points.size(); i += 2) {
+        polygon.emplace_back(points[i], points[i + 1]);
+    }
+    return spanStatistics(src, RoiRasterizer::polygon(polygon, cv::Size(src.width, src.height)));
+}
+
+ImageCore::Image ImageCore::runPipeline(const std::string &pipelineJson, const Buffer &src)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromStdString(pipelineJson), &parseError);
+    if (!document.isObject()) {
+        throw std::invalid_argument("Invalid pipeline: " + parseError.errorString().toStdString());
+    }
+    OperationGraph pipeline;
+    pipeline.setStagesFromJson(document.object());
+
+    // 管线按BGR(A)顺序解释彩色图像
+    const bool rgbOrder = isRgbOrder(src.format);
+    cv::Mat source = view(src);
+    if (rgbOrder) {
+        // 转换到新的图像，不修改调用方的缓冲区
+        cv::Mat bgr;
+        cv::cvtColor(source, bgr, src.format == RGB888 ? cv::COLOR_RGB2BGR : cv::COLOR_RGBA2BGRA);
+        source = bgr;
+    }
+    pipeline.setSource(source);
+    cv::Mat result = pipeline.evaluate();
+    if (rgbOrder && result.channels() != 1) {
+        cv::cvtColor(result, result, result.channels() == 3 ? cv::COLOR_BGR2RGB : cv::COLOR_BGRA2RGBA);
+    }
+
+    Image image;
+    switch (result.type()) {
+    case CV_8UC1:
+        image.format = Gray8;
+        break;
+    case CV_16UC1:
+        image.format = Gray16;
+        break;
+    case CV_8UC3:
+        image.format = rgbOrder ? RGB888 : BGR888;
+        break;
+    case CV_8UC4:
+        image.format = rgbOrder ? RGBA8888 : BGRA8888;
+        break;
+    default:
+        throw std::runtime_error("Pipeline produced an unsupported pixel type");
+    }
+    image.width = result.cols;
+    image.height = result.rows;
+    image.pixels.resize(result.total() * result.elemSize());
+    // 写入紧密排列的像素
+    cv::Mat packed(result.rows, result.cols, result.type(), image.pixels.data());
+    result.copyTo(packed);
+    return image;
+}
@@ -0,0 +1,84 @@
+#ifndef IMAGECORE_H
+#define IMAGECORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 图像处理核心库的纯C++接口：调用方提供原始像素缓冲区，接口中不出现Qt和OpenCV的类型
+// 缓冲区只包装为视图，不复制输入；结果写入调用方的目标缓冲区（允许与源相同，即原地处理）
+// 函数之间没有共享状态，可在任意线程中并发调用；参数不正确时抛出std::invalid_argument，
+// 其他错误抛出std::exception的派生类
+class ImageCore
+{
+public:
+    enum PixelFormat {
+        Gray8,      // 8位灰度
+        Gray16,     // 16位灰度
+        BGR888,     // 3字节 B,G,R
+        RGB888,     // 3字节 R,G,B
+        BGRA8888,   // 4字节 B,G,R,A
+        RGBA8888    // 4字节 R,G,B,A
+    };
+
+    // 不拥有数据的像素缓冲区，stride为每行字节数，0表示各行紧密排列
+    struct Buffer {
+        void *data = nullptr;
+        int width = 0;
+        int height = 0;
+        size_t stride = 0;
+        PixelFormat format = Gray8;
+    };
+
+    // 拥有数据的图像（各行紧密排列），用于输出格式由运算决定的场合
+    struct Image {
+        int width = 0;
+        int height = 0;
+        PixelFormat format = Gray8;
+        std::vector<uint8_t> pixels;
+
+        Buffer buffer();
+    };
+
+    // 灰度统计：直方图按ImageStatistics的约定，8位每级一个区间，16位按高8位分区间
+    struct Statistics {
+        int64_t count = 0;
+        double mean = 0.0;
+        double variance = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        std::vector<int64_t> histogram;
+    };
+
+    static size_t bytesPerPixel(PixelFormat format);
+
+    // 转换为灰度，dst为Gray8（8位源）或Gray16（16位源），与界面中的灰度转换一致
+    static void toGrayscale(const Buffer &src, const Buffer &dst);
+
+    // 邻域滤波，dst与src尺寸、格式相同；核大小为奇数，均值不超过1001，高斯不超过31，中值不超过101
+    // 高斯滤波的核大小为0时由sigma决定，大sigma时使用运算量与sigma无关的递归实现
+    static void meanFilter(const Buffer &src, const Buffer &dst, int kernelSize);
+    static void gaussianFilter(const Buffer &src, const Buffer &dst, int kernelSize, double sigma);
+    static void medianFilter(const Buffer &src, const Buffer &dst, int kernelSize);
+
+    // 点运算（查找表），dst与src尺寸、格式相同；参数含义同界面中的滑块
+    static void linearTransform(const Buffer &src, const Buffer &dst, int kValue, int bValue);
+    static void gammaContrast(const Buffer &src, const Buffer &dst, double gamma, int contrast);
+    // 直方图均衡，src为Gray8、BGR888或RGB888（彩色图像只均衡亮度），dst与src尺寸、格式相同
+    static void equalizeHistogram(const Buffer &src, const Buffer &dst);
+
+    // 整幅图像的灰度统计，一次遍历
+    static Statistics statistics(const Buffer &src);
+    // ROI的灰度统计：矩形、圆、多边形（points为x0, y0, x1, y1, ...）；超出图像的部分被裁掉
+    // 只有count、mean、variance有效，由积分图按扫描线段累加得到
+    static Statistics rectStatistics(const Buffer &src, int x, int y, int width, int height);
+    static Statistics circleStatistics(const Buffer &src, int centerX, int centerY, int radius);
+    static Statistics polygonStatistics(const Buffer &src, const std::vector<int> &points);
+
+    // 运行处理流程文件（界面中“导出处理流程”得到的JSON文本），输出的格式取决于流程中的阶段
+    // JSON格式不正确时抛出std::invalid_argument
+    static Image runPipeline(const std::string &pipelineJson, const Buffer &src);
+};
+
+#endif // IMAGECORE_H
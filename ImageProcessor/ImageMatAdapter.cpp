@@ -0,0 +1,230 @@
+#include "ImageMatAdapter.h"
+#include <QtGlobal>
+#include <QDebug>
+#include <opencv2/imgproc.hpp>
+
+bool ImageMatAdapter::canWrap(QImage::Format format)
+{
+    return matType(format) >= 0;
+}
+
+int ImageMatAdapter::matType(QImage::Format format)
+{
+    switch (format) {
+        case QImage::Format_Grayscale8:
+            return CV_8UC1;
+        case QImage::Format_Grayscale16:
+            return CV_16UC1;
+        case QImage::Format_RGB888:
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        case QImage::Format_BGR888:
+#endif
+            return CV_8UC3;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        // 小端机器上0xAARRGGBB在内存中的顺序为B,G,R,A，与OpenCV的BGRA一致
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            return CV_8UC4;
+#endif
+        default:
+            return -1;
+    }
+}
+
+ImageMatAdapter::ChannelOrder ImageMatAdapter::channelOrder(QImage::Format format)
+{
+    switch (format) {
+        case QImage::Format_Grayscale8:
+        case QImage::Format_Grayscale16:
+            return OrderGray;
+        case QImage::Format_RGB888:
+            return OrderRGB;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        case QImage::Format_BGR888:
+            return OrderBGR;
+#endif
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            return OrderBGRA;
+#endif
+        default:
+            return OrderUnknown;
+    }
+}
+
+cv::Mat ImageMatAdapter::constView(const QImage &image)
+{
+    const int type = matType(image.format());
+    if (image.isNull() || type < 0) {
+        return cv::Mat();
+    }
+    // 只读视图：OpenCV的Mat头没有const版本，由调用方保证不写入
+    return cv::Mat(image.height(), image.width(), type,
+                   const_cast<uchar*>(image.constBits()),
+                   static_cast<size_t>(image.bytesPerLine()));
+}
+
+cv::Mat ImageMatAdapter::view(QImage &image)
+{
+    const int type = matType(image.format());
+    if (image.isNull() || type < 0) {
+        return cv::Mat();
+    }
+    // bits()会在数据被共享时先做写时复制，保证写入不影响其它QImage
+    return cv::Mat(image.height(), image.width(), type,
+                   image.bits(), static_cast<size_t>(image.bytesPerLine()));
+}
+
+cv::Mat ImageMatAdapter::toMat(const QImage &image)
+{
+    if (image.isNull() || image.width() <= 0 || image.height() <= 0) {
+        qDebug() << "ImageMatAdapter::toMat: QImage is null or has invalid size";
+        return cv::Mat();
+    }
+
+    cv::Mat mat;
+    switch (channelOrder(image.format())) {
+        case OrderGray:
+            // 零拷贝：直接使用QImage的扫描线，16位灰度保持CV_16UC1，需要8位的调用方自行转换
+            return constView(image);
+        case OrderBGR:
+            return constView(image);
+        case OrderRGB:
+            cv::cvtColor(constView(image), mat, cv::COLOR_RGB2BGR);
+            return mat;
+        case OrderBGRA:
+            cv::cvtColor(constView(image), mat, cv::COLOR_BGRA2BGR);
+            return mat;
+        case OrderUnknown:
+            break;
+    }
+
+    if (image.format() == QImage::Format_Indexed8) {
+        return indexedToMat(image);
+    }
+
+    // 其它格式先由Qt整体转换为RGB888，再一次cvtColor得到BGR
+    qDebug() << "ImageMatAdapter::toMat: converting unsupported format" << image.format() << "to RGB888";
+    const QImage converted = image.convertToFormat(QImage::Format_RGB888);
+    cv::cvtColor(constView(converted), mat, cv::COLOR_RGB2BGR);
+    return mat;
+}
+
+cv::Mat ImageMatAdapter::toGrayMat(const QImage &image)
+{
+    if (image.isNull()) {
+        return cv::Mat();
+    }
+
+    cv::Mat gray;
+    switch (channelOrder(image.format())) {
+        case OrderGray:
+            return toMat(image);
+        case OrderRGB:
+            cv::cvtColor(constView(image), gray, cv::COLOR_RGB2GRAY);
+            return gray;
+        case OrderBGR:
+            cv::cvtColor(constView(image), gray, cv::COLOR_BGR2GRAY);
+            return gray;
+        case OrderBGRA:
+            cv::cvtColor(constView(image), gray, cv::COLOR_BGRA2GRAY);
+            return gray;
+        case OrderUnknown:
+            break;
+    }
+
+    const cv::Mat mat = toMat(image);
+    if (mat.empty() || mat.channels() == 1) {
+        return mat;
+    }
+    cv::cvtColor(mat, gray, cv::COLOR_BGR2GRAY);
+    return gray;
+}
+
+cv::Mat ImageMatAdapter::indexedToMat(const QImage &image)
+{
+    // 索引平面本身就是一个CV_8UC1矩阵
+    const cv::Mat indices(image.height(), image.width(), CV_8UC1,
+                          const_cast<uchar*>(image.constBits()),
+                          static_cast<size_t>(image.bytesPerLine()));
+
+    const auto colorTable = image.colorTable();
+    bool identityGray = !colorTable.isEmpty();
+    cv::Mat lut(1, 256, CV_8UC3, cv::Scalar::all(0));
+    for (int i = 0; i < colorTable.size() && i < 256; ++i) {
+        const QRgb c = colorTable.at(i);
+        lut.at<cv::Vec3b>(0, i) = cv::Vec3b(static_cast<uchar>(qBlue(c)),
+                                            static_cast<uchar>(qGreen(c)),
+                                            static_cast<uchar>(qRed(c)));
+        if (qRed(c) != i || qGreen(c) != i || qBlue(c) != i) {
+            identityGray = false;
+        }
+    }
+
+    if (identityGray) {
+        // 调色板就是0-255灰阶，索引值即灰度值
+        return indices;
+    }
+
+    // 调色板查表：先把索引复制到三个通道，再按通道查LUT
+    cv::Mat mat;
+    cv::cvtColor(indices, mat, cv::COLOR_GRAY2BGR);
+    cv::LUT(mat, lut, mat);
+    return mat;
+}
+
+QImage ImageMatAdapter::toQImage(const cv::Mat &mat)
+{
+    if (mat.empty()) {
+        qDebug() << "ImageMatAdapter::toQImage: Mat is empty";
+        return QImage();
+    }
+
+    cv::Mat src = mat;
+    const bool keep16 = (mat.depth() == CV_16U && mat.channels() == 1);
+    if (mat.depth() != CV_8U && !keep16) {
+        mat.convertTo(src, CV_MAKETYPE(CV_8U, mat.channels()));
+    }
+
+    QImage::Format format = QImage::Format_Invalid;
+    switch (src.channels()) {
+        case 1: format = keep16 ? QImage::Format_Grayscale16 : QImage::Format_Grayscale8; break;
+        case 3: format = QImage::Format_RGB888; break;
+        case 4: format = QImage::Format_ARGB32; break;
+        default:
+            qDebug() << "ImageMatAdapter::toQImage: unsupported channel count" << src.channels();
+            return QImage();
+    }
+
+    QImage result(src.cols, src.rows, format);
+    if (result.isNull()) {
+        qDebug() << "ImageMatAdapter::toQImage: failed to allocate QImage" << src.cols << "x" << src.rows;
+        return QImage();
+    }
+
+    // 目标Mat头直接指向QImage的像素内存，尺寸和类型一致时OpenCV不会重新分配
+    cv::Mat dst(result.height(), result.width(), src.type(),
+                result.bits(), static_cast<size_t>(result.bytesPerLine()));
+    switch (src.channels()) {
+        case 1:
+            src.copyTo(dst);
+            break;
+        case 3:
+            cv::cvtColor(src, dst, cv::COLOR_BGR2RGB);
+            break;
+        case 4: {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+            src.copyTo(dst);
+#else
+            // 大端机器上ARGB32在内存中的顺序为A,R,G,B
+            const int fromTo[] = { 0, 3, 1, 2, 2, 1, 3, 0 };
+            cv::mixChannels(&src, 1, &dst, 1, fromTo, 4);
+#endif
+            break;
+        }
+    }
+    return result;
+}
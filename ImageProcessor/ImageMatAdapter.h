@@ -0,0 +1,49 @@
+#ifndef IMAGEMATADAPTER_H
+#define IMAGEMATADAPTER_H
+
+#include <QImage>
+#include <opencv2/core.hpp>
+
+// QImage <-> cv::Mat 视图适配层
+// 内存布局可以直接对应的格式只创建Mat头（零拷贝，按bytesPerLine设置步长），
+// 其余格式做一次整体的向量化转换，不再逐像素调用pixel()/at<>()
+class ImageMatAdapter
+{
+public:
+    // 视图中像素的通道顺序
+    enum ChannelOrder {
+        OrderUnknown,
+        OrderGray,   // 单通道灰度
+        OrderRGB,    // 3通道 R,G,B (Format_RGB888)
+        OrderBGR,    // 3通道 B,G,R (Format_BGR888)
+        OrderBGRA    // 4通道 B,G,R,A (小端机器上的RGB32/ARGB32)
+    };
+
+    // 格式能否直接包装为Mat头
+    static bool canWrap(QImage::Format format);
+    // 格式对应的Mat类型，不能包装时返回-1
+    static int matType(QImage::Format format);
+    // 格式对应的通道顺序
+    static ChannelOrder channelOrder(QImage::Format format);
+
+    // 只读视图：与image共享扫描线内存，调用方不得写入，且image必须比视图存活更久
+    static cv::Mat constView(const QImage &image);
+    // 可写视图：会使image脱离共享(detach)，写入直接作用于image的像素
+    static cv::Mat view(QImage &image);
+
+    // 转换为处理用的标准布局：灰度为CV_8UC1（Grayscale16为CV_16UC1），彩色为CV_8UC3(BGR)
+    // 灰度和BGR888直接返回只读视图，其它格式最多一次整体转换
+    static cv::Mat toMat(const QImage &image);
+
+    // 转换为单通道灰度(CV_8UC1，Grayscale16为CV_16UC1)：彩色格式直接从视图一次cvtColor，不经过中间BGR矩阵
+    static cv::Mat toGrayMat(const QImage &image);
+
+    // 标准布局的Mat转回QImage：先分配目标QImage，再把结果直接写入其扫描线
+    // CV_8UC1 -> Grayscale8, CV_16UC1 -> Grayscale16, CV_8UC3 -> RGB888, CV_8UC4 -> ARGB32
+    static QImage toQImage(const cv::Mat &mat);
+
+private:
+    static cv::Mat indexedToMat(const QImage &image);
+};
+
+#endif // IMAGEMATADAPTER_H
@@ -0,0 +1,326 @@
+#include "ImageOperations.h"
+#include "BoxFilter.h"
+#include "ConstantTimeMedian.h"
+#include "RecursiveGaussian.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+cv::Mat ImageOperations::toGrayscale(const cv::Mat &src)
+{
+    if (src.empty()) {
+        throw std::runtime_error("Input image is empty");
+    }
+    if (src.channels() == 1) {
+        return src;
+    }
+
+    cv::Mat gray;
+    cv::cvtColor(src, gray, src.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    return gray;
+}
+
+cv::Mat ImageOperations::meanFilter(const cv::Mat &src, int kernelSize, const TileScheduler::Control &control,
+                                    const HighPass &highPass)
+{
+    return meanFilter(src, cv::Size(kernelSize, kernelSize), control, highPass);
+}
+
+cv::Mat ImageOperations::meanFilter(const cv::Mat &src, const cv::Size &kernel, const TileScheduler::Control &control,
+                                    const HighPass &highPass)
+{
+    // 滑动和实现的运算量与核大小无关
+    if (BoxFilter::supports(src)) {
+        return BoxFilter::apply(src, kernel, control, highPass);
+    }
+
+    const HighPass matched = highPass.matchedTo(src);
+    cv::Mat dst;
+    TileScheduler::run(src, dst, src.type(), std::max(kernel.width, kernel.height) / 2,
+        [kernel, &matched](const cv::Mat &input, const cv::Rect &inner, cv::Mat &output) {
+            cv::Mat filtered;
+            cv::blur(input, filtered, kernel);
+            writeTile(filtered(inner), output, matched);
+        }, control);
+    return dst;
+}
+
+cv::Mat ImageOperations::gaussianFilter(const cv::Mat &src, int kernelSize, double sigma,
+                                        const TileScheduler::Control &control, const HighPass &highPass)
+{
+    // 大sigma的完整高斯使用递归实现，运算量与sigma无关
+    if (usesRecursiveGaussian(kernelSize, sigma)) {
+        return RecursiveGaussian::apply(src, sigma, control, highPass);
+    }
+
+    const HighPass matched = highPass.matchedTo(src);
+    cv::Mat dst;
+    TileScheduler::run(src, dst, src.type(), gaussianHalo(kernelSize, sigma),
+        [kernelSize, sigma, &matched](const cv::Mat &input, const cv::Rect &inner, cv::Mat &output) {
+            cv::Mat filtered;
+            cv::GaussianBlur(input, filtered, cv::Size(kernelSize, kernelSize), sigma);
+            writeTile(filtered(inner), output, matched);
+        }, control);
+    return dst;
+}
+
+int ImageOperations::gaussianKernelSize(double sigma)
+{
+    return cvRound(sigma * 6.0 + 1.0) | 1;
+}
+
+bool ImageOperations::usesRecursiveGaussian(int kernelSize, double sigma)
+{
+    // 给定的核比完整核小时按核截断，与sigma略小于阈值时的结果连续
+    return sigma >= RecursiveGaussian::SIGMA_THRESHOLD
+        && (kernelSize == 0 || kernelSize >= gaussianKernelSize(sigma));
+}
+
+int ImageOperations::gaussianHalo(int kernelSize, double sigma)
+{
+    // 递归高斯的响应没有截止，取4σ：更远处的权重之和小于1e-4，对8位结果没有影响
+    // 核大小为0时OpenCV对非8位输入取±4σ的核
+    if (kernelSize == 0 || usesRecursiveGaussian(kernelSize, sigma)) {
+        return cvCeil(sigma * 4.0);
+    }
+    return kernelSize / 2;
+}
+
+cv::Mat ImageOperations::medianFilter(const cv::Mat &src, int kernelSize, const TileScheduler::Control &control,
+                                      const HighPass &highPass)
+{
+    // 大核使用常数时间中值滤波；3和5的核medianBlur使用排序网络，仍然更快
+    if (kernelSize > 5 && ConstantTimeMedian::supports(src)) {
+        return ConstantTimeMedian::apply(src, kernelSize, control, highPass);
+    }
+
+    // medianBlur对大于5的核只支持8位输入
+    cv::Mat input = src;
+    if (src.depth() != CV_8U && kernelSize > 5) {
+        src.convertTo(input, CV_MAKETYPE(CV_8U, src.channels()));
+    }
+
+    const HighPass matched = highPass.matchedTo(input);
+    cv::Mat dst;
+    TileScheduler::run(input, dst, input.type(), kernelSize / 2,
+        [kernelSize, &matched](const cv::Mat &tileInput, const cv::Rect &inner, cv::Mat &output) {
+            cv::Mat filtered;
+            cv::medianBlur(tileInput, filtered, kernelSize);
+            writeTile(filtered(inner), output, matched);
+        }, control);
+    return dst;
+}
+
+cv::Mat ImageOperations::subtract(const cv::Mat &original, const cv::Mat &filtered)
+{
+    if (original.size() != filtered.size() || original.channels() != filtered.channels()) {
+        throw std::runtime_error("Image dimension or channel mismatch");
+    }
+
+    cv::Mat dst;
+    cv::subtract(original, filtered, dst);
+    return dst;
+}
+
+cv::Mat ImageOperations::applyInRoi(const cv::Mat &src, const RoiMask &roi, int halo, const RoiOperation &operation)
+{
+    const cv::Rect imageRect(0, 0, src.cols, src.rows);
+    if (roi.isEmpty()) {
+        return operation(src, imageRect);
+    }
+    if (roi.size() != src.size()) {
+        throw std::invalid_argument("ROI mask size does not match the image");
+    }
+
+    // 包围盒内的每个像素在块中都有完整的邻域；块被图像边界截断的一侧与整幅处理时的边界处理相同
+    const cv::Rect bounds = roi.boundingRect();
+    const cv::Rect tile = cv::Rect(bounds.x - halo, bounds.y - halo,
+                                   bounds.width + 2 * halo, bounds.height + 2 * halo) & imageRect;
+    const cv::Mat result = operation(src(tile), tile);
+    if (result.size() != tile.size() || result.type() != src.type()) {
+        throw std::invalid_argument("ROI operation must preserve the tile size and type");
+    }
+
+    cv::Mat dst = src.clone();
+    cv::Mat dstBounds = dst(bounds);
+    roi.copyInside(result(bounds - tile.tl()), dstBounds, bounds.tl());
+    return dst;
+}
+
+void ImageOperations::writeTile(const cv::Mat &filtered, cv::Mat &output, const HighPass &highPass)
+{
+    if (!highPass.isEnabled()) {
+        filtered.copyTo(output);
+        return;
+    }
+    // 块的滤波结果还在缓存中，直接与原图的对应区域合成
+    highPass.combine(highPass.original()(TileScheduler::tileRect(output)), filtered, output);
+}
+
+PointOpChain ImageOperations::linearChain(int kValue, int bValue)
+{
+    // k范围是0.0到2.0，b值直接使用，结果截断到有效范围
+    PointOpChain chain;
+    chain.linear(1.0 + kValue / 100.0, bValue);
+    return chain;
+}
+
+PointOpChain ImageOperations::gammaContrastChain(double gamma, int contrast)
+{
+    // 伽马校正: s = 255 * (r / 255)^(1 / γ)
+    // 对比度调整: s = (s - 128) * (1 + contrast / 100) + 128
+    PointOpChain chain;
+    chain.gamma(gamma);
+    if (contrast != 0) {
+        chain.contrast(1.0 + contrast / 100.0, 128.0);
+    }
+    return chain;
+}
+
+cv::Mat ImageOperations::applyPointOps(const cv::Mat &src, const PointOpChain &chain)
+{
+    if (chain.isEmpty()) {
+        return src;
+    }
+    // 整条链编译成一张查找表，一次遍历完成
+    return chain.apply(src);
+}
+
+cv::Mat ImageOperations::linearTransform(const cv::Mat &src, int kValue, int bValue)
+{
+    return applyPointOps(src, linearChain(kValue, bValue));
+}
+
+cv::Mat ImageOperations::gammaContrast(const cv::Mat &src, double gamma, int contrast)
+{
+    return applyPointOps(src, gammaContrastChain(gamma, contrast));
+}
+
+// 单通道均衡化：8位使用cv::equalizeHist，16位按相同的规则由累计直方图生成65536项查找表
+static cv::Mat equalizePlane(const cv::Mat &plane)
+{
+    cv::Mat result;
+    if (plane.depth() == CV_8U) {
+        cv::equalizeHist(plane, result);
+        return result;
+    }
+    if (plane.depth() != CV_16U) {
+        throw std::invalid_argument("Histogram equalization supports 8-bit and 16-bit images only");
+    }
+
+    std::vector<int64_t> histogram(65536, 0);
+    for (int y = 0; y < plane.rows; ++y) {
+        const ushort *row = plane.ptr<ushort>(y);
+        for (int x = 0; x < plane.cols; ++x) {
+            ++histogram[row[x]];
+        }
+    }
+
+    // 与cv::equalizeHist一致：最小的灰度映射为0，只有单一灰度时保持不变
+    const int64_t total = static_cast<int64_t>(plane.total());
+    int first = 0;
+    while (histogram[first] == 0) {
+        ++first;
+    }
+    if (histogram[first] == total) {
+        return plane.clone();
+    }
+
+    cv::Mat lut(1, 65536, CV_16U, cv::Scalar(0));
+    ushort *table = lut.ptr<ushort>();
+    const double scale = 65535.0 / static_cast<double>(total - histogram[first]);
+    int64_t sum = 0;
+    for (int i = first + 1; i < 65536; ++i) {
+        sum += histogram[i];
+        table[i] = cv::saturate_cast<ushort>(sum * scale);
+    }
+    return PointOpChain::applyLut(plane, lut);
+}
+
+cv::Mat ImageOperations::equalizeHistogram(const cv::Mat &src)
+{
+    if (src.channels() == 1) {
+        // 灰度图像直接进行直方图均衡化
+        return equalizePlane(src);
+    }
+
+    // 彩色图像只对YUV空间的亮度通道Y进行均衡化，带alpha的图像保留alpha通道
+    cv::Mat bgr = src;
+    if (src.channels() == 4) {
+        cv::cvtColor(src, bgr, cv::COLOR_BGRA2BGR);
+    }
+    cv::Mat yuv;
+    cv::cvtColor(bgr, yuv, cv::COLOR_BGR2YUV);
+
+    std::vector<cv::Mat> channels;
+    cv::split(yuv, channels);
+    channels[0] = equalizePlane(channels[0]);
+    cv::merge(channels, yuv);
+
+    cv::Mat result;
+    cv::cvtColor(yuv, result, cv::COLOR_YUV2BGR);
+    if (src.channels() == 4) {
+        cv::Mat alpha;
+        cv::extractChannel(src, alpha, 3);
+        std::vector<cv::Mat> planes;
+        cv::split(result, planes);
+        planes.push_back(alpha);
+        cv::merge(planes, result);
+    }
+    return result;
+}
+
+cv::Mat ImageOperations::stretchHistogram(const cv::Mat &src)
+{
+    if (src.depth() != CV_8U && src.depth() != CV_16U) {
+        throw std::invalid_argument("Histogram stretching supports 8-bit and 16-bit images only");
+    }
+
+    cv::Mat result;
+    double minVal, maxVal;
+    // 拉伸到所在位深的满量程，16位灰度不先压缩到8位
+    const double maxLevel = src.depth() == CV_16U ? 65535.0 : 255.0;
+
+    if (src.channels() == 1) {
+        cv::minMaxLoc(src, &minVal, &maxVal);
+
+        // 已经占满量程或只有单一灰度时无需拉伸
+        if ((minVal == 0 && maxVal == maxLevel) || maxVal <= minVal) {
+            return src.clone();
+        }
+
+        // 线性拉伸 newPixel = (pixel - min) * maxLevel / (max - min)
+        src.convertTo(result, -1, maxLevel / (maxVal - minVal), -minVal * maxLevel / (maxVal - minVal));
+        return result;
+    }
+
+    // 彩色图像只拉伸YUV空间的亮度通道Y，带alpha的图像保留alpha通道
+    cv::Mat bgr = src;
+    if (src.channels() == 4) {
+        cv::cvtColor(src, bgr, cv::COLOR_BGRA2BGR);
+    }
+    cv::Mat yuv;
+    cv::cvtColor(bgr, yuv, cv::COLOR_BGR2YUV);
+
+    std::vector<cv::Mat> channels;
+    cv::split(yuv, channels);
+
+    cv::minMaxLoc(channels[0], &minVal, &maxVal);
+    if (maxVal > minVal) {
+        channels[0].convertTo(channels[0], -1, maxLevel / (maxVal - minVal), -minVal * maxLevel / (maxVal - minVal));
+    }
+
+    cv::merge(channels, yuv);
+    cv::cvtColor(yuv, result, cv::COLOR_YUV2BGR);
+    if (src.channels() == 4) {
+        cv::Mat alpha;
+        cv::extractChannel(src, alpha, 3);
+        std::vector<cv::Mat> planes;
+        cv::split(result, planes);
+        planes.push_back(alpha);
+        cv::merge(planes, result);
+    }
+    return result;
+}
@@ -0,0 +1,76 @@
+#ifndef IMAGEOPERATIONS_H
+#define IMAGEOPERATIONS_H
+
+#include <opencv2/core.hpp>
+#include "HighPass.h"
+#include "PointOpChain.h"
+#include "RoiMask.h"
+#include "TileScheduler.h"
+#include <functional>
+
+// 纯图像运算：输入输出均为cv::Mat，不修改输入，不依赖界面
+// 出错时抛出cv::Exception或std::exception，由调用方统一处理
+class ImageOperations
+{
+public:
+    // 各邻域滤波允许的最大核，界面、处理流程文件和核心库接口共用同一限制
+    // 均值和中值滤波的运算量与核大小无关；高斯滤波的FIR路径运算量和分块halo随核增大，
+    // 大模糊应增大sigma（使用递归实现）而不是核
+    static const int MAX_MEAN_KERNEL_SIZE = 1001;
+    static const int MAX_GAUSSIAN_KERNEL_SIZE = 31;
+    static const int MAX_MEDIAN_KERNEL_SIZE = 101;
+
+    // 转换为单通道灰度，已是单通道时直接返回输入
+    static cv::Mat toGrayscale(const cv::Mat &src);
+
+    // 邻域滤波：分块并行执行，control可用于取消（抛出TileScheduler::Cancelled）和进度通知
+    // highPass启用时输出gain * (原图 - 滤波结果) + offset，在产生滤波结果的同一遍中完成
+    static cv::Mat meanFilter(const cv::Mat &src, int kernelSize,
+                              const TileScheduler::Control &control = TileScheduler::Control(),
+                              const HighPass &highPass = HighPass());
+    // 矩形核（宽x高）的均值滤波，8位、16位和浮点输入的运算量与核大小无关
+    static cv::Mat meanFilter(const cv::Mat &src, const cv::Size &kernel,
+                              const TileScheduler::Control &control = TileScheduler::Control(),
+                              const HighPass &highPass = HighPass());
+    // 核大小为0时由sigma决定；核覆盖完整支撑（见usesRecursiveGaussian）时使用递归高斯，
+    // 否则按给定的核截断，sigma的微小变化不会使模糊程度突变
+    static cv::Mat gaussianFilter(const cv::Mat &src, int kernelSize, double sigma,
+                                  const TileScheduler::Control &control = TileScheduler::Control(),
+                                  const HighPass &highPass = HighPass());
+    // sigma对应的完整高斯核大小（±3σ，与OpenCV按sigma自动确定的8位核大小相同）
+    static int gaussianKernelSize(double sigma);
+    // 核大小为0或不小于完整核、且sigma不小于RecursiveGaussian::SIGMA_THRESHOLD时使用递归高斯
+    static bool usesRecursiveGaussian(int kernelSize, double sigma);
+    // 高斯滤波的邻域半径：递归高斯和由sigma决定的核取4σ
+    static int gaussianHalo(int kernelSize, double sigma);
+    static cv::Mat medianFilter(const cv::Mat &src, int kernelSize,
+                                const TileScheduler::Control &control = TileScheduler::Control(),
+                                const HighPass &highPass = HighPass());
+    // 原图减去滤波结果（高通），结果饱和到[0, 255]
+    static cv::Mat subtract(const cv::Mat &original, const cv::Mat &filtered);
+
+    // 点运算：每个调整对应一段点运算链，连续的调整可以合并为一张查找表
+    static PointOpChain linearChain(int kValue, int bValue);        // y = kx + b, k = 1 + kValue / 100
+    static PointOpChain gammaContrastChain(double gamma, int contrast);
+    static cv::Mat applyPointOps(const cv::Mat &src, const PointOpChain &chain);
+    static cv::Mat linearTransform(const cv::Mat &src, int kValue, int bValue);
+    static cv::Mat gammaContrast(const cv::Mat &src, double gamma, int contrast);
+
+    // 直方图运算
+    // 均衡化支持8位和16位，1、3或4通道：彩色图像只均衡亮度，保留alpha通道
+    static cv::Mat equalizeHistogram(const cv::Mat &src);
+    // 拉伸到所在位深的满量程（8位为255，16位为65535），通道要求与均衡化相同
+    static cv::Mat stretchHistogram(const cv::Mat &src);
+
+    // ROI范围的运算：只对roi的包围盒向外扩展halo（邻域运算的核半径）后的块调用operation，
+    // 包围盒内的结果按掩码合成回src的副本，ROI以外保持不变；roi为空时对整幅图像运算
+    // operation的参数为块及其在src中的位置，返回与块尺寸、类型相同的结果；roi与src尺寸不同时抛出异常
+    using RoiOperation = std::function<cv::Mat(const cv::Mat &tile, const cv::Rect &rect)>;
+    static cv::Mat applyInRoi(const cv::Mat &src, const RoiMask &roi, int halo, const RoiOperation &operation);
+
+private:
+    // 块的滤波结果写入目标：启用高通时与原图对应区域合成，否则直接复制
+    static void writeTile(const cv::Mat &filtered, cv::Mat &output, const HighPass &highPass);
+};
+
+#endif // IMAGEOPERATIONS_H
@@ -1,4 +1,8 @@
 #include "ImageProcessor.h"
+#include "ImageMatAdapter.h"
+#include "ImageOperations.h"
+#include "ImageStatisticsCache.h"
+#include "Metrics.h"
 #include <QImage>
 #include <QColor>
 #include <cmath>
@@ -7,12 +11,34 @@
 #include <opencv2/opencv.hpp>
 #include <QDebug>
 
+// 8位和16位灰度都按灰度图处理，16位灰度不压缩到8位
+static bool isGrayscaleFormat(QImage::Format format)
+{
+    return ImageMatAdapter::channelOrder(format) == ImageMatAdapter::OrderGray;
+}
+
 ImageProcessor::ImageProcessor(QObject *parent)
     : QObject(parent), kernelSize(3)  // 默认卷积核大小为3
+    , previewScale(1.0)
+    , jobExecutor(new ProcessingJobExecutor(this))
+    , summedAreaKey(0)
 {
+    connect(jobExecutor, &ProcessingJobExecutor::jobFailed, this,
+            [this](quint64, const QString &key, const QString &message) {
+        emit error(tr("后台处理失败(%1): %2").arg(key, message));
+    });
+    connect(jobExecutor, &ProcessingJobExecutor::jobProgress, this,
+            [this](quint64, const QString &, int percent) {
+        emit processingProgress(percent);
+    });
 }
 
-ImageProcessor::~ImageProcessor() = default;
+ImageProcessor::~ImageProcessor()
+{
+    // 析构前取消并等待后台任务结束
+    cancelPendingJobs();
+    jobExecutor->waitForDone();
+}
 
 bool ImageProcessor::loadImage(const QString &filePath)
 {
@@ -21,6 +47,7 @@ bool ImageProcessor::loadImage(const QString &filePath)
         emit imageLoaded(false);
         return false;
     }
+    Metrics::ScopedTimer timer("decode.loadImage");
 
     QImage image(filePath);
     if (image.isNull()) {
@@ -29,8 +56,12 @@ bool ImageProcessor::loadImage(const QString &filePath)
         return false;
     }
 
+    cancelPendingJobs();  // 旧图像的后台结果不再有效
     originalImage = image;
     processedImage = image;
+    grayscaleImage = QImage();  // 旧图像的灰度状态不再有效
+    updatePipelineSource();
+    timer.stop();
     emit imageLoaded(true);
     return true;
 }
@@ -47,15 +78,19 @@ const QImage& ImageProcessor::getProcessedImage() const
 
 void ImageProcessor::setProcessedImage(const QImage &image)
 {
-    if (!image.isNull()) {
-        processedImage = image.copy(); // 创建一个深拷贝
-        emit imageProcessed(); // 发送图像已处理信号
+    // 显示处理结果时界面会把同一幅图像设置回来，不必重复处理，也保留按cacheKey缓存的统计
+    if (image.isNull() || image.cacheKey() == processedImage.cacheKey()) {
+        return;
     }
+    cancelPendingJobs();  // 进行中的后台结果基于之前的图像，不再有效
+    processedImage = image;  // 隐式共享，修改时才复制
+    emit imageProcessed(); // 发送图像已处理信号
 }
 
 void ImageProcessor::resetToOriginal()
 {
     if (!originalImage.isNull()) {
+        cancelPendingJobs();
         processedImage = originalImage;
         emit imageProcessed();
     }
@@ -67,9 +102,15 @@ void ImageProcessor::flipHorizontal()
         emit error(tr("没有可处理的图像"));
         return;
     }
-    cv::Mat mat = QImageToMat(processedImage);
-    cv::flip(mat, mat, 1);  // 1 表示水平翻转
-    processedImage = MatToQImage(mat);
+    cancelPendingJobs();
+    Metrics::ScopedTimer timer("process.flip");
+    QImage flipped = flipImage(processedImage, 1);  // 1 表示水平翻转
+    if (flipped.isNull()) {
+        emit error(tr("图像翻转失败"));
+        return;
+    }
+    processedImage = flipped;
+    timer.stop();
     emit imageProcessed();
 }
 
@@ -79,9 +120,15 @@ void ImageProcessor::flipVertical()
         emit error(tr("没有可处理的图像"));
         return;
     }
-    cv::Mat mat = QImageToMat(processedImage);
-    cv::flip(mat, mat, 0);  // 0 表示垂直翻转
-    processedImage = MatToQImage(mat);
+    cancelPendingJobs();
+    Metrics::ScopedTimer timer("process.flip");
+    QImage flipped = flipImage(processedImage, 0);  // 0 表示垂直翻转
+    if (flipped.isNull()) {
+        emit error(tr("图像翻转失败"));
+        return;
+    }
+    processedImage = flipped;
+    timer.stop();
     emit imageProcessed();
 }
 
@@ -91,8 +138,10 @@ void ImageProcessor::applyMeanFilter(int kernelSize, bool subtractFromOriginal)
         emit error(tr("没有可处理的图像"));
         return;
     }
+    cancelPendingJobs();
 
     qDebug() << "\n====== MEAN FILTER START ======";
+    Metrics::ScopedTimer timer("process.meanFilter");
     qDebug() << "Mean Filter - Input image format:" << processedImage.format()
              << "Size:" << processedImage.width() << "x" << processedImage.height()
              << "Depth:" << processedImage.depth()
@@ -105,70 +154,17 @@ void ImageProcessor::applyMeanFilter(int kernelSize, bool subtractFromOriginal)
         return;
     }
 
-    if (kernelSize < 3 || kernelSize > 31) {
-        emit error(tr("核大小必须在3到31之间"));
-        qDebug() << "Error: 核大小必须在3到31之间, kernelSize=" << kernelSize;
+    if (kernelSize < 3 || kernelSize > MAX_MEAN_KERNEL_SIZE) {
+        emit error(tr("核大小必须在3到%1之间").arg(MAX_MEAN_KERNEL_SIZE));
+        qDebug() << "Error: 核大小必须在3到" << MAX_MEAN_KERNEL_SIZE << "之间, kernelSize=" << kernelSize;
         qDebug() << "====== MEAN FILTER ERROR END (INVALID KERNEL SIZE RANGE) ======\n";
         return;
     }
 
     try {
-        // 使用深拷贝确保安全
-        QImage safeImage = processedImage.copy();
-        
-        qDebug() << "Step 1: Converting QImage to Mat safely...";
-        cv::Mat mat;
-        
-        // 使用更安全的方式进行图像格式转换
-        switch (safeImage.format()) {
-            case QImage::Format_Grayscale8:
-                qDebug() << "Converting grayscale image";
-                // 深拷贝图像数据到OpenCV矩阵
-                {
-                    mat = cv::Mat(safeImage.height(), safeImage.width(), CV_8UC1);
-                    // 逐行复制数据而不是直接使用内存映射
-                    for (int y = 0; y < safeImage.height(); ++y) {
-                        const uchar* scanLine = safeImage.constScanLine(y);
-                        uchar* matLine = mat.ptr<uchar>(y);
-                        std::memcpy(matLine, scanLine, safeImage.width());
-                    }
-                }
-                break;
-                
-            case QImage::Format_RGB32:
-            case QImage::Format_ARGB32:
-            case QImage::Format_ARGB32_Premultiplied:
-                qDebug() << "Converting RGB32/ARGB32 image";
-                // 转换为BGR格式（OpenCV使用BGR而不是RGB）
-                {
-                    mat = cv::Mat(safeImage.height(), safeImage.width(), CV_8UC4);
-                    // 逐行复制数据
-                    for (int y = 0; y < safeImage.height(); ++y) {
-                        const uchar* scanLine = safeImage.constScanLine(y);
-                        uchar* matLine = mat.ptr<uchar>(y);
-                        std::memcpy(matLine, scanLine, safeImage.width() * 4);
-                    }
-                    // 转换为3通道BGR格式
-                    cv::cvtColor(mat, mat, cv::COLOR_BGRA2BGR);
-                }
-                break;
-                
-            default:
-                qDebug() << "Converting other format to RGB32 first";
-                // 转换为标准格式再处理
-                safeImage = safeImage.convertToFormat(QImage::Format_RGB32);
-                mat = cv::Mat(safeImage.height(), safeImage.width(), CV_8UC4);
-                // 逐行复制数据
-                for (int y = 0; y < safeImage.height(); ++y) {
-                    const uchar* scanLine = safeImage.constScanLine(y);
-                    uchar* matLine = mat.ptr<uchar>(y);
-                    std::memcpy(matLine, scanLine, safeImage.width() * 4);
-                }
-                // 转换为3通道BGR格式
-                cv::cvtColor(mat, mat, cv::COLOR_BGRA2BGR);
-                break;
-        }
-        
+        qDebug() << "Step 1: Converting QImage to Mat...";
+        cv::Mat mat = QImageToMat(processedImage);
+
         // 验证转换后的Mat
         if (mat.empty()) {
             throw std::runtime_error("Failed to convert QImage to Mat");
@@ -181,89 +177,17 @@ void ImageProcessor::applyMeanFilter(int kernelSize, bool subtractFromOriginal)
         cv::Mat filteredMat;
         qDebug() << "Step 3: Applying mean filter with kernel size " << kernelSize;
         
-        cv::Size kernelDim(kernelSize, kernelSize);
-        cv::blur(mat, filteredMat, kernelDim);
-        
-        // 如果请求从原始图像中减去滤波后的图像
+        // 如果请求从原始图像中减去滤波后的图像，高通在滤波的同一遍中完成（尺寸或通道不匹配时抛出异常）
+        HighPass highPass;
         if (subtractFromOriginal) {
-            qDebug() << "Step 4: Subtracting filtered image from original";
-            
-            // 转换原始图像
-            QImage safOriginal = originalImage.copy();
-            cv::Mat originalMat;
-            
-            // 确保使用与上面相同的转换方法
-            switch (safOriginal.format()) {
-                case QImage::Format_Grayscale8:
-                    originalMat = cv::Mat(safOriginal.height(), safOriginal.width(), CV_8UC1);
-                    for (int y = 0; y < safOriginal.height(); ++y) {
-                        const uchar* scanLine = safOriginal.constScanLine(y);
-                        uchar* matLine = originalMat.ptr<uchar>(y);
-                        std::memcpy(matLine, scanLine, safOriginal.width());
-                    }
-                    break;
-                    
-                case QImage::Format_RGB32:
-                case QImage::Format_ARGB32:
-                case QImage::Format_ARGB32_Premultiplied:
-                    originalMat = cv::Mat(safOriginal.height(), safOriginal.width(), CV_8UC4);
-                    for (int y = 0; y < safOriginal.height(); ++y) {
-                        const uchar* scanLine = safOriginal.constScanLine(y);
-                        uchar* matLine = originalMat.ptr<uchar>(y);
-                        std::memcpy(matLine, scanLine, safOriginal.width() * 4);
-                    }
-                    cv::cvtColor(originalMat, originalMat, cv::COLOR_BGRA2BGR);
-                    break;
-                    
-                default:
-                    safOriginal = safOriginal.convertToFormat(QImage::Format_RGB32);
-                    originalMat = cv::Mat(safOriginal.height(), safOriginal.width(), CV_8UC4);
-                    for (int y = 0; y < safOriginal.height(); ++y) {
-                        const uchar* scanLine = safOriginal.constScanLine(y);
-                        uchar* matLine = originalMat.ptr<uchar>(y);
-                        std::memcpy(matLine, scanLine, safOriginal.width() * 4);
-                    }
-                    cv::cvtColor(originalMat, originalMat, cv::COLOR_BGRA2BGR);
-                    break;
-            }
-            
-            // 检查尺寸是否匹配
-            if (originalMat.size() != filteredMat.size() || originalMat.channels() != filteredMat.channels()) {
-                qDebug() << "Error: Original and filtered images have different dimensions or channels";
-                throw std::runtime_error("Image dimension or channel mismatch");
-            }
-            
-            // 执行减法操作
-            cv::subtract(originalMat, filteredMat, filteredMat);
+            qDebug() << "Step 4: Subtracting filtered image from original (fused into the filter pass)";
+            highPass = HighPass(QImageToMat(originalImage));
         }
+        filteredMat = OperationGraph::filterInRoi(OperationGraph::FilterMean, kernelSize, 0.0, mat, processingROI, highPass);
         
         // 转换回QImage
         qDebug() << "Step 5: Converting filtered Mat back to QImage";
-        QImage result;
-        
-        // 根据通道数选择正确的转换方法
-        if (filteredMat.channels() == 1) {
-            // 灰度图像
-            result = QImage(filteredMat.cols, filteredMat.rows, QImage::Format_Grayscale8);
-            // 逐行复制数据
-            for (int y = 0; y < filteredMat.rows; ++y) {
-                const uchar* matLine = filteredMat.ptr<uchar>(y);
-                uchar* resultLine = result.scanLine(y);
-                std::memcpy(resultLine, matLine, filteredMat.cols);
-            }
-        } else {
-            // 彩色图像 - 将BGR转为RGB
-            cv::Mat rgbMat;
-            cv::cvtColor(filteredMat, rgbMat, cv::COLOR_BGR2RGB);
-            
-            // 创建QImage并复制数据
-            result = QImage(rgbMat.cols, rgbMat.rows, QImage::Format_RGB888);
-            for (int y = 0; y < rgbMat.rows; ++y) {
-                const uchar* matLine = rgbMat.ptr<uchar>(y);
-                uchar* resultLine = result.scanLine(y);
-                std::memcpy(resultLine, matLine, rgbMat.cols * 3);
-            }
-        }
+        QImage result = MatToQImage(filteredMat);
         
         // 验证结果
         if (result.isNull()) {
@@ -273,6 +197,7 @@ void ImageProcessor::applyMeanFilter(int kernelSize, bool subtractFromOriginal)
         // 设置处理后的图像并发出信号
         processedImage = result;
         qDebug() << "Mean filter completed successfully";
+        timer.stop();
         qDebug() << "====== MEAN FILTER END ======\n";
         emit imageProcessed();
         
@@ -297,26 +222,26 @@ void ImageProcessor::applyGaussianFilter(int kernelSize, double sigma, bool subt
         emit error(tr("没有可处理的图像"));
         return;
     }
+    cancelPendingJobs();
 
     qDebug() << "\n====== GAUSSIAN FILTER START ======";
+    Metrics::ScopedTimer timer("process.gaussianFilter");
     qDebug() << "Gaussian Filter - Input image format:" << processedImage.format()
              << "Size:" << processedImage.width() << "x" << processedImage.height()
              << "Depth:" << processedImage.depth()
              << "Is null:" << processedImage.isNull();
 
-    // 保存原始图像的副本用于处理
-    QImage originalCopy = processedImage.copy();
-
-    if (kernelSize % 2 == 0) {
+    // 核大小为0时由sigma决定
+    if (kernelSize % 2 == 0 && kernelSize != 0) {
         emit error(tr("核大小必须是奇数"));
         qDebug() << "Error: 核大小必须是奇数, kernelSize=" << kernelSize;
         qDebug() << "====== GAUSSIAN FILTER ERROR END (INVALID KERNEL SIZE) ======\n";
         return;
     }
 
-    if (kernelSize < 3 || kernelSize > 31) {
-        emit error(tr("核大小必须在3到31之间"));
-        qDebug() << "Error: 核大小必须在3到31之间, kernelSize=" << kernelSize;
+    if (kernelSize != 0 && (kernelSize < 3 || kernelSize > MAX_KERNEL_SIZE)) {
+        emit error(tr("核大小必须在3到%1之间").arg(MAX_KERNEL_SIZE));
+        qDebug() << "Error: 核大小必须在3到" << MAX_KERNEL_SIZE << "之间, kernelSize=" << kernelSize;
         qDebug() << "====== GAUSSIAN FILTER ERROR END (INVALID KERNEL SIZE RANGE) ======\n";
         return;
     }
@@ -325,7 +250,7 @@ void ImageProcessor::applyGaussianFilter(int kernelSize, double sigma, bool subt
         qDebug() << "Step 1: Converting QImage to Mat for Gaussian filter...";
         
         // 判断是否是灰度图
-        bool isGrayscaleImage = (processedImage.format() == QImage::Format_Grayscale8);
+        bool isGrayscaleImage = isGrayscaleFormat(processedImage.format());
         qDebug() << "Image is grayscale:" << isGrayscaleImage;
         
         cv::Mat mat;
@@ -355,6 +280,29 @@ void ImageProcessor::applyGaussianFilter(int kernelSize, double sigma, bool subt
             return;
         }
 
+        // 从原图中减去时，高通在滤波的同一遍中完成
+        HighPass highPass;
+        if (subtractFromOriginal) {
+            qDebug() << "Step 2.1: Preparing original image for fused subtraction";
+            cv::Mat originalMat = QImageToMat(originalImage);
+            if (originalMat.empty()) {
+                qDebug() << "Error: Original image conversion to Mat failed";
+                emit error(tr("原始图像转换失败"));
+                qDebug() << "====== GAUSSIAN FILTER ERROR END (ORIGINAL CONVERSION FAILED) ======\n";
+                return;
+            }
+
+            // 检查尺寸是否匹配
+            if (originalMat.rows != mat.rows || originalMat.cols != mat.cols ||
+                originalMat.channels() != mat.channels()) {
+                qDebug() << "Error: Dimension or channel mismatch for subtraction";
+                emit error(tr("原始图像与滤波图像尺寸或通道不匹配"));
+                qDebug() << "====== GAUSSIAN FILTER ERROR END (DIMENSION MISMATCH) ======\n";
+                return;
+            }
+            highPass = HighPass(originalMat);
+        }
+
         cv::Mat filteredMat;
         
         qDebug() << "Step 3: Starting Gaussian filtering operation based on image type";
@@ -363,7 +311,7 @@ void ImageProcessor::applyGaussianFilter(int kernelSize, double sigma, bool subt
             cv::Size kernelDim(kernelSize, kernelSize);
             qDebug() << "Using kernel dimensions: " << kernelDim.width << "x" << kernelDim.height
                      << " and sigma=" << sigma;
-            cv::GaussianBlur(mat, filteredMat, kernelDim, sigma);
+            filteredMat = OperationGraph::filterInRoi(OperationGraph::FilterGaussian, kernelSize, sigma, mat, processingROI, highPass);
             qDebug() << "Gaussian blur operation completed successfully";
             
             // 验证结果
@@ -393,38 +341,6 @@ void ImageProcessor::applyGaussianFilter(int kernelSize, double sigma, bool subt
                  << "channels:" << filteredMat.channels()
                  << "type:" << filteredMat.type();
 
-        if (subtractFromOriginal) {
-            qDebug() << "Step 5: Subtracting filtered image from original (requested)";
-            try {
-                cv::Mat originalMat = QImageToMat(originalImage);
-                if (originalMat.empty()) {
-                    qDebug() << "Error: Original image conversion to Mat failed";
-                    emit error(tr("原始图像转换失败"));
-                    qDebug() << "====== GAUSSIAN FILTER ERROR END (ORIGINAL CONVERSION FAILED) ======\n";
-                    return;
-                }
-
-                // 检查尺寸是否匹配
-                if (originalMat.rows != filteredMat.rows || originalMat.cols != filteredMat.cols ||
-                    originalMat.channels() != filteredMat.channels()) {
-                    qDebug() << "Error: Dimension or channel mismatch for subtraction";
-                    emit error(tr("原始图像与滤波图像尺寸或通道不匹配"));
-                    qDebug() << "====== GAUSSIAN FILTER ERROR END (DIMENSION MISMATCH) ======\n";
-                    return;
-                }
-
-                // 执行减法操作
-                cv::subtract(originalMat, filteredMat, filteredMat);
-                qDebug() << "Subtraction completed successfully";
-            }
-            catch (const std::exception& e) {
-                qDebug() << "Error during subtraction:" << e.what();
-                emit error(tr("图像相减操作错误: %1").arg(e.what()));
-                qDebug() << "====== GAUSSIAN FILTER ERROR END (SUBTRACTION ERROR) ======\n";
-                return;
-            }
-        }
-
         qDebug() << "Step 6: Converting filtered Mat back to QImage...";
         QImage newImage;
 
@@ -449,6 +365,7 @@ void ImageProcessor::applyGaussianFilter(int kernelSize, double sigma, bool subt
         processedImage = newImage;
         
         qDebug() << "Step 7: Gaussian filter completed successfully";
+        timer.stop();
         qDebug() << "====== GAUSSIAN FILTER END ======\n";
         
         // 发出图像处理完成的信号
@@ -474,17 +391,19 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
         emit error(tr("没有可处理的图像"));
         return;
     }
+    cancelPendingJobs();
 
     qDebug() << "\n====== MEDIAN FILTER START ======";
+    Metrics::ScopedTimer timer("process.medianFilter");
     // 添加调试信息以检查处理前的图像
     qDebug() << "Median Filter - Input image format:" << processedImage.format()
              << "Size:" << processedImage.width() << "x" << processedImage.height()
              << "Depth:" << processedImage.depth()
              << "Is null:" << processedImage.isNull();
 
-    if (kernelSize % 2 == 0 || kernelSize < 3 || kernelSize > 31) {
-        emit error(tr("核大小必须是3到31之间的奇数"));
-        qDebug() << "Error: 核大小必须是3到31之间的奇数, kernelSize=" << kernelSize;
+    if (kernelSize % 2 == 0 || kernelSize < 3 || kernelSize > MAX_MEDIAN_KERNEL_SIZE) {
+        emit error(tr("核大小必须是3到%1之间的奇数").arg(MAX_MEDIAN_KERNEL_SIZE));
+        qDebug() << "Error: 核大小必须是3到" << MAX_MEDIAN_KERNEL_SIZE << "之间的奇数, kernelSize=" << kernelSize;
         qDebug() << "====== MEDIAN FILTER ERROR END (INVALID KERNEL SIZE) ======\n";
         return;
     }
@@ -493,7 +412,7 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
         qDebug() << "Step 1: Converting QImage to Mat for median filter...";
         
         // 判断是否是灰度图
-        bool isGrayscaleImage = (processedImage.format() == QImage::Format_Grayscale8);
+        bool isGrayscaleImage = isGrayscaleFormat(processedImage.format());
         qDebug() << "Image is grayscale:" << isGrayscaleImage;
         
         cv::Mat mat;
@@ -523,6 +442,53 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
             return;
         }
 
+        // 从原图中减去时，高通在滤波的同一遍中完成
+        HighPass highPass;
+        if (subtractFromOriginal) {
+            qDebug() << "Step 2.1: Preparing original image for fused subtraction";
+            qDebug() << "Step 2.1.1: Converting original image to Mat...";
+            cv::Mat originalMat;
+            try {
+                originalMat = QImageToMat(originalImage);
+                if (originalMat.empty()) {
+                    qDebug() << "Error: Original image conversion to Mat failed";
+                    emit error(tr("原始图像转换失败"));
+                    qDebug() << "====== MEDIAN FILTER ERROR END (ORIGINAL CONVERSION FAILED) ======\n";
+                    return;
+                }
+                qDebug() << "Original Mat: size=" << originalMat.rows << "x" << originalMat.cols
+                         << " channels=" << originalMat.channels() << " type=" << originalMat.type();
+            } catch (const std::exception& e) {
+                qDebug() << "Exception during original image conversion: " << e.what();
+                emit error(tr("原始图像转换异常: %1").arg(e.what()));
+                qDebug() << "====== MEDIAN FILTER ERROR END (ORIGINAL CONVERSION EXCEPTION) ======\n";
+                return;
+            }
+
+            // 检查原始图像尺寸是否匹配
+            qDebug() << "Step 2.1.2: Validating original image dimensions";
+            if (originalMat.rows != mat.rows || originalMat.cols != mat.cols) {
+                qDebug() << "Error: Original image dimensions do not match: " 
+                         << originalMat.rows << "x" << originalMat.cols
+                         << " vs " << mat.rows << "x" << mat.cols;
+                emit error(tr("原始图像尺寸不匹配"));
+                qDebug() << "====== MEDIAN FILTER ERROR END (DIMENSION MISMATCH) ======\n";
+                return;
+            }
+
+            // 检查原始图像通道数是否与当前图像匹配
+            qDebug() << "Step 2.1.3: Validating channel count";
+            if (originalMat.channels() != mat.channels()) {
+                qDebug() << "Error: Original image channel count does not match: "
+                         << originalMat.channels() << " vs " << mat.channels();
+                emit error(tr("原始图像通道数与当前图像不匹配"));
+                qDebug() << "====== MEDIAN FILTER ERROR END (CHANNEL COUNT MISMATCH) ======\n";
+                return;
+            }
+
+            highPass = HighPass(originalMat);
+        }
+
         cv::Mat filteredMat;
         
         qDebug() << "Step 3: Starting median filtering operation based on image type";
@@ -531,21 +497,21 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
             qDebug() << "Step 3.1: Processing grayscale image with median filter";
             try {
                 qDebug() << "Step 3.1.1: Checking if input matrix needs conversion to CV_8UC1";
-                // 确保输入矩阵是CV_8UC1类型
+                // 中值滤波支持8位和16位灰度，其他类型转换为CV_8UC1
                 cv::Mat matCopy;
-                if (mat.type() != CV_8UC1) {
+                if (mat.type() != CV_8UC1 && mat.type() != CV_16UC1) {
                     qDebug() << "Converting mat to CV_8UC1 format from type:" << mat.type();
                     mat.convertTo(matCopy, CV_8UC1);
                     qDebug() << "Conversion successful, new Mat type: " << matCopy.type();
                 } else {
-                    qDebug() << "Mat already in CV_8UC1 format, creating copy";
-                    matCopy = mat.clone();
+                    qDebug() << "Mat already in supported format, using it directly. Type:" << mat.type();
+                    matCopy = mat;  // medianBlur只读取输入，无需拷贝
                 }
                 
                 qDebug() << "Step 3.1.2: Creating output matrix with same dimensions";
                 // 创建同样大小和类型的输出矩阵
                 try {
-                    filteredMat.create(matCopy.rows, matCopy.cols, CV_8UC1);
+                    filteredMat.create(matCopy.rows, matCopy.cols, matCopy.type());
                     qDebug() << "Output matrix created successfully, size: " << filteredMat.rows << "x" << filteredMat.cols;
                 } catch (const std::exception& e) {
                     qDebug() << "Exception creating output matrix: " << e.what();
@@ -556,7 +522,7 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
                 // 使用安全的方式应用中值滤波
                 try {
                     qDebug() << "Using kernel size: " << kernelSize;
-                    cv::medianBlur(matCopy, filteredMat, kernelSize);
+                    filteredMat = OperationGraph::filterInRoi(OperationGraph::FilterMedian, kernelSize, 0.0, matCopy, processingROI, highPass);
                     qDebug() << "Median blur operation completed successfully";
                 } catch (const cv::Exception& e) {
                     qDebug() << "OpenCV exception during median blur operation: " << e.what();
@@ -590,10 +556,12 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
                 
                 // 检查第一个像素值以验证数据有效
                 if (!filteredMat.empty() && filteredMat.rows > 0 && filteredMat.cols > 0) {
-                    uchar firstPixel = filteredMat.at<uchar>(0, 0);
-                    uchar lastPixel = filteredMat.at<uchar>(filteredMat.rows-1, filteredMat.cols-1);
-                    qDebug() << "First pixel value:" << static_cast<int>(firstPixel)
-                             << " Last pixel value:" << static_cast<int>(lastPixel);
+                    const bool is16Bit = (filteredMat.depth() == CV_16U);
+                    int firstPixel = is16Bit ? filteredMat.at<ushort>(0, 0) : filteredMat.at<uchar>(0, 0);
+                    int lastPixel = is16Bit ? filteredMat.at<ushort>(filteredMat.rows-1, filteredMat.cols-1)
+                                            : filteredMat.at<uchar>(filteredMat.rows-1, filteredMat.cols-1);
+                    qDebug() << "First pixel value:" << firstPixel
+                             << " Last pixel value:" << lastPixel;
                 }
             }
             catch (const cv::Exception& e) {
@@ -621,7 +589,7 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
                 // 彩色图像处理
                 try {
                     qDebug() << "Using kernel size: " << kernelSize;
-                    cv::medianBlur(mat, filteredMat, kernelSize);
+                    filteredMat = OperationGraph::filterInRoi(OperationGraph::FilterMedian, kernelSize, 0.0, mat, processingROI, highPass);
                     qDebug() << "Color median blur operation completed successfully";
                 } catch (const cv::Exception& e) {
                     qDebug() << "OpenCV exception during color median blur: " << e.what();
@@ -662,67 +630,6 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
                  << "channels:" << filteredMat.channels()
                  << "type:" << filteredMat.type();
 
-        if (subtractFromOriginal) {
-            qDebug() << "Step 5: Subtracting filtered image from original (requested)";
-            qDebug() << "Step 5.1: Converting original image to Mat...";
-            cv::Mat originalMat;
-            try {
-                originalMat = QImageToMat(originalImage);
-                if (originalMat.empty()) {
-                    qDebug() << "Error: Original image conversion to Mat failed";
-                    emit error(tr("原始图像转换失败"));
-                    qDebug() << "====== MEDIAN FILTER ERROR END (ORIGINAL CONVERSION FAILED) ======\n";
-                    return;
-                }
-                qDebug() << "Original Mat: size=" << originalMat.rows << "x" << originalMat.cols
-                         << " channels=" << originalMat.channels() << " type=" << originalMat.type();
-            } catch (const std::exception& e) {
-                qDebug() << "Exception during original image conversion: " << e.what();
-                emit error(tr("原始图像转换异常: %1").arg(e.what()));
-                qDebug() << "====== MEDIAN FILTER ERROR END (ORIGINAL CONVERSION EXCEPTION) ======\n";
-                return;
-            }
-
-            // 检查原始图像尺寸是否匹配
-            qDebug() << "Step 5.2: Validating original image dimensions";
-            if (originalMat.rows != mat.rows || originalMat.cols != mat.cols) {
-                qDebug() << "Error: Original image dimensions do not match: " 
-                         << originalMat.rows << "x" << originalMat.cols
-                         << " vs " << mat.rows << "x" << mat.cols;
-                emit error(tr("原始图像尺寸不匹配"));
-                qDebug() << "====== MEDIAN FILTER ERROR END (DIMENSION MISMATCH) ======\n";
-                return;
-            }
-
-            // 检查原始图像通道数是否与当前图像匹配
-            qDebug() << "Step 5.3: Validating channel count";
-            if (originalMat.channels() != mat.channels()) {
-                qDebug() << "Error: Original image channel count does not match: "
-                         << originalMat.channels() << " vs " << mat.channels();
-                emit error(tr("原始图像通道数与当前图像不匹配"));
-                qDebug() << "====== MEDIAN FILTER ERROR END (CHANNEL COUNT MISMATCH) ======\n";
-                return;
-            }
-
-            qDebug() << "Step 5.4: Subtracting filtered image from original...";
-            try {
-                cv::subtract(originalMat, filteredMat, filteredMat);
-                qDebug() << "Subtraction completed successfully";
-            }
-            catch (const cv::Exception& e) {
-                qDebug() << "OpenCV error during subtraction:" << e.what();
-                emit error(tr("图像相减操作失败: %1").arg(e.what()));
-                qDebug() << "====== MEDIAN FILTER ERROR END (SUBTRACTION ERROR) ======\n";
-                return;
-            }
-            catch (const std::exception& e) {
-                qDebug() << "Error during subtraction:" << e.what();
-                emit error(tr("图像相减操作错误: %1").arg(e.what()));
-                qDebug() << "====== MEDIAN FILTER ERROR END (SUBTRACTION EXCEPTION) ======\n";
-                return;
-            }
-        }
-
         qDebug() << "Step 6: Converting filtered Mat back to QImage...";
         QImage newImage;
 
@@ -759,6 +666,7 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
         qDebug() << "Step 6.3: Validating new image dimensions";
         qDebug() << "New image size:" << newImage.width() << "x" << newImage.height();
         processedImage = newImage;
+        timer.stop();
         emit imageProcessed();
     } catch (const cv::Exception& e) {
         emit error(tr("OpenCV错误: %1").arg(e.what()));
@@ -770,343 +678,82 @@ void ImageProcessor::applyMedianFilter(int kernelSize, bool subtractFromOriginal
 }
 
 // QImage 转 cv::Mat
+// 灰度(8位或16位)/BGR888直接返回共享扫描线的只读视图，其它格式一次整体转换为BGR
 cv::Mat ImageProcessor::QImageToMat(const QImage &image)
 {
     if (image.isNull()) {
         qDebug() << "QImageToMat: QImage is null";
         return cv::Mat();
     }
+    Metrics::ScopedTimer timer("convert.QImageToMat");
 
-    qDebug() << "QImageToMat: Converting QImage format:" << image.format() 
-             << "Size:" << image.width() << "x" << image.height() 
-             << "Depth:" << image.depth()
-             << "Bytes per line:" << image.bytesPerLine();
+    qDebug() << "QImageToMat: Converting QImage format:" << image.format()
+             << "Size:" << image.width() << "x" << image.height()
+             << "Bytes per line:" << image.bytesPerLine()
+             << "Zero-copy:" << isGrayscaleFormat(image.format());
 
-    cv::Mat mat;
     try {
-        // 检查图像尺寸是否合理
-        if (image.width() <= 0 || image.height() <= 0) {
-            qDebug() << "QImageToMat: Invalid image dimensions:" << image.width() << "x" << image.height();
-            return cv::Mat();
-        }
-
-        // 对于所有类型的图像，我们都创建一个深拷贝，并使用更安全的逐像素复制
-        QImage copy = image.copy();
-
-        switch (copy.format()) {
-            case QImage::Format_RGB32:
-            case QImage::Format_ARGB32:
-            case QImage::Format_ARGB32_Premultiplied:
-                {
-                    qDebug() << "QImageToMat: Processing Format_RGB32/ARGB32";
-                    
-                    // 创建目标矩阵
-                    mat = cv::Mat(copy.height(), copy.width(), CV_8UC3);
-                    
-                    // 逐像素复制，把ARGB/RGB32转为BGR
-                    for (int y = 0; y < copy.height(); ++y) {
-                        for (int x = 0; x < copy.width(); ++x) {
-                            QRgb pixel = copy.pixel(x, y);
-                            mat.at<cv::Vec3b>(y, x)[0] = qBlue(pixel);   // B
-                            mat.at<cv::Vec3b>(y, x)[1] = qGreen(pixel);  // G
-                            mat.at<cv::Vec3b>(y, x)[2] = qRed(pixel);    // R
-                        }
-                    }
-                    
-                    qDebug() << "QImageToMat: Converted ARGB to BGR using safe copy, Mat size:"
-                             << mat.cols << "x" << mat.rows 
-                             << "Channels:" << mat.channels();
-                }
-                break;
-                
-            case QImage::Format_RGB888:
-                {
-                    qDebug() << "QImageToMat: Processing Format_RGB888";
-                    
-                    // 创建目标矩阵
-                    mat = cv::Mat(copy.height(), copy.width(), CV_8UC3);
-                    
-                    // 逐行复制，把RGB转为BGR
-                    for (int y = 0; y < copy.height(); ++y) {
-                        const uchar* scanLine = copy.constScanLine(y);
-                        for (int x = 0; x < copy.width(); ++x) {
-                            // RGB888格式的顺序是RGBRGBRGB...
-                            mat.at<cv::Vec3b>(y, x)[0] = scanLine[x*3+2];  // B
-                            mat.at<cv::Vec3b>(y, x)[1] = scanLine[x*3+1];  // G
-                            mat.at<cv::Vec3b>(y, x)[2] = scanLine[x*3];    // R
-                        }
-                    }
-                    
-                    qDebug() << "QImageToMat: Converted RGB888 to BGR using safe copy, Mat size:"
-                             << mat.cols << "x" << mat.rows 
-                             << "Channels:" << mat.channels();
-                }
-                break;
-                
-            case QImage::Format_Grayscale8:
-                {
-                    qDebug() << "QImageToMat: Processing Format_Grayscale8";
-                    
-                    // 创建目标矩阵
-                    mat = cv::Mat(copy.height(), copy.width(), CV_8UC1);
-                    
-                    // 逐行复制
-                    for (int y = 0; y < copy.height(); ++y) {
-                        const uchar* scanLine = copy.constScanLine(y);
-                        uchar* matLine = mat.ptr<uchar>(y);
-                        std::memcpy(matLine, scanLine, copy.width());
-                    }
-                    
-                    qDebug() << "QImageToMat: Created grayscale Mat using safe copy, size:"
-                             << mat.cols << "x" << mat.rows 
-                             << "Channels:" << mat.channels();
-                }
-                break;
-                
-            case QImage::Format_Indexed8:
-                {
-                    qDebug() << "QImageToMat: Processing Format_Indexed8";
-                    
-                    // 将索引色图像转换为RGB32格式
-                    QImage convertedImage = copy.convertToFormat(QImage::Format_RGB32);
-                    
-                    // 创建目标矩阵
-                    mat = cv::Mat(convertedImage.height(), convertedImage.width(), CV_8UC3);
-                    
-                    // 逐像素复制，把RGB32转为BGR
-                    for (int y = 0; y < convertedImage.height(); ++y) {
-                        for (int x = 0; x < convertedImage.width(); ++x) {
-                            QRgb pixel = convertedImage.pixel(x, y);
-                            mat.at<cv::Vec3b>(y, x)[0] = qBlue(pixel);   // B
-                            mat.at<cv::Vec3b>(y, x)[1] = qGreen(pixel);  // G
-                            mat.at<cv::Vec3b>(y, x)[2] = qRed(pixel);    // R
-                        }
-                    }
-                    
-                    qDebug() << "QImageToMat: Converted Indexed8 to BGR using safe copy, Mat size:"
-                             << mat.cols << "x" << mat.rows 
-                             << "Channels:" << mat.channels();
-                }
-                break;
-                
-            default:
-                qDebug() << "QImageToMat: Unsupported format, converting to RGB32 first:" << copy.format();
-                
-                // 转换为RGB32格式再处理
-                QImage converted = copy.convertToFormat(QImage::Format_RGB32);
-                
-                // 创建目标矩阵
-                mat = cv::Mat(converted.height(), converted.width(), CV_8UC3);
-                
-                // 逐像素复制，把RGB32转为BGR
-                for (int y = 0; y < converted.height(); ++y) {
-                    for (int x = 0; x < converted.width(); ++x) {
-                        QRgb pixel = converted.pixel(x, y);
-                        mat.at<cv::Vec3b>(y, x)[0] = qBlue(pixel);   // B
-                        mat.at<cv::Vec3b>(y, x)[1] = qGreen(pixel);  // G
-                        mat.at<cv::Vec3b>(y, x)[2] = qRed(pixel);    // R
-                    }
-                }
-                
-                qDebug() << "QImageToMat: Converted to RGB32 then to BGR using safe copy, Mat size:"
-                         << mat.cols << "x" << mat.rows 
-                         << "Channels:" << mat.channels();
-                break;
-        }
+        cv::Mat mat = ImageMatAdapter::toMat(image);
+        timer.stop();
+        return mat;
     } catch (const cv::Exception& e) {
         qDebug() << "OpenCV error in QImageToMat:" << e.what();
-        return cv::Mat();
     } catch (const std::exception& e) {
         qDebug() << "Error in QImageToMat:" << e.what();
-        return cv::Mat();
     } catch (...) {
         qDebug() << "Unknown error in QImageToMat";
-        return cv::Mat();
     }
-
-    if (mat.empty()) {
-        qDebug() << "Failed to convert QImage to Mat";
-    } else {
-        qDebug() << "QImageToMat: Successfully converted image, result Mat:" 
-                 << "Size:" << mat.cols << "x" << mat.rows 
-                 << "Channels:" << mat.channels() 
-                 << "Type:" << mat.type() 
-                 << "Depth:" << mat.depth() 
-                 << "Is continuous:" << mat.isContinuous();
-    }
-    return mat;
+    return cv::Mat();
 }
 
 // cv::Mat 转 QImage
+// 结果直接写入新分配的QImage缓冲区，不再经过中间clone
 QImage ImageProcessor::MatToQImage(const cv::Mat &mat)
 {
-    qDebug() << "\n====== MAT TO QIMAGE START ======";
     if (mat.empty()) {
         qDebug() << "MatToQImage: Mat is empty";
-        qDebug() << "====== MAT TO QIMAGE END (FAILED) ======\n";
         return QImage();
     }
+    Metrics::ScopedTimer timer("convert.MatToQImage");
 
-    qDebug() << "MatToQImage: Converting Mat size:" << mat.cols << "x" << mat.rows 
-             << "Channels:" << mat.channels() 
-             << "Type:" << mat.type() 
-             << "Depth:" << mat.depth() 
-             << "Step:" << mat.step
-             << "Is continuous:" << mat.isContinuous();
-    
-    // 检查像素值范围，用于诊断
-    if (mat.channels() == 1) {
-        try {
-            double minVal, maxVal;
-            cv::minMaxLoc(mat, &minVal, &maxVal);
-            qDebug() << "Mat pixel value range: min=" << minVal << " max=" << maxVal;
-            
-            // 只在确保安全的情况下取样像素值
-            if (mat.rows > 0 && mat.cols > 0 && mat.data != nullptr && mat.type() == CV_8UC1) {
-                try {
-                    // 创建一个Mat的副本来确保内存安全
-                    cv::Mat safeMatForSampling = mat.clone();
-                    if (!safeMatForSampling.empty()) {
-                        uchar firstPixel = safeMatForSampling.at<uchar>(0, 0);
-                        
-                        // 确保中间索引不会越界
-                        int midRow = std::min(safeMatForSampling.rows/2, safeMatForSampling.rows-1);
-                        int midCol = std::min(safeMatForSampling.cols/2, safeMatForSampling.cols-1);
-                        uchar middlePixel = safeMatForSampling.at<uchar>(midRow, midCol);
-                        
-                        // 确保最后一个索引不会越界
-                        int lastRow = safeMatForSampling.rows-1;
-                        int lastCol = safeMatForSampling.cols-1;
-                        uchar lastPixel = safeMatForSampling.at<uchar>(lastRow, lastCol);
-                        
-                        qDebug() << "Sample pixels: first=" << static_cast<int>(firstPixel)
-                                << " middle=" << static_cast<int>(middlePixel)
-                                << " last=" << static_cast<int>(lastPixel);
-                    } else {
-                        qDebug() << "Skipping pixel sampling: cloned matrix is empty";
-                    }
-                } catch (const cv::Exception& e) {
-                    qDebug() << "OpenCV exception during pixel sampling: " << e.what() << " - continuing conversion";
-                } catch (const std::exception& e) {
-                    qDebug() << "Standard exception during pixel sampling: " << e.what() << " - continuing conversion";
-                } catch (...) {
-                    qDebug() << "Unknown exception during pixel sampling - continuing conversion";
-                }
-            } else {
-                qDebug() << "Skipping pixel sampling due to unsafe conditions";
-                if (mat.type() != CV_8UC1) {
-                    qDebug() << "Matrix type is not CV_8UC1, it is: " << mat.type();
-                }
-            }
-        } catch (const cv::Exception& e) {
-            qDebug() << "OpenCV exception during min/max calculation: " << e.what() << " - continuing conversion";
-        } catch (const std::exception& e) {
-            qDebug() << "Standard exception during min/max calculation: " << e.what() << " - continuing conversion";
-        } catch (...) {
-            qDebug() << "Unknown exception during min/max calculation - continuing conversion";
-        }
-    }
+    qDebug() << "MatToQImage: Converting Mat size:" << mat.cols << "x" << mat.rows
+             << "Channels:" << mat.channels()
+             << "Type:" << mat.type();
 
     try {
-        if (mat.type() == CV_8UC3) {
-            qDebug() << "MatToQImage: Processing CV_8UC3 (BGR) Mat";
-            cv::Mat rgb;
-            cv::cvtColor(mat, rgb, cv::COLOR_BGR2RGB);
-            // 创建深拷贝以确保数据安全
-            cv::Mat rgbCopy = rgb.clone();
-            QImage result(rgbCopy.data, rgbCopy.cols, rgbCopy.rows, rgbCopy.step, QImage::Format_RGB888);
-            QImage copy = result.copy(); // 再次复制确保完全分离数据
-            qDebug() << "MatToQImage: Created RGB888 QImage, size:" << copy.width() << "x" << copy.height()
-                     << "Format:" << copy.format() << "Depth:" << copy.depth()
-                     << "Is null:" << copy.isNull();
-            
-            // 检查QImage像素值
-            if (!copy.isNull() && copy.width() > 0 && copy.height() > 0) {
-                QRgb firstPixel = copy.pixel(0, 0);
-                QRgb middlePixel = copy.pixel(copy.width()/2, copy.height()/2);
-                QRgb lastPixel = copy.pixel(copy.width()-1, copy.height()-1);
-                qDebug() << "RGB QImage sample pixels: first=RGB(" 
-                         << qRed(firstPixel) << "," << qGreen(firstPixel) << "," << qBlue(firstPixel) << ")"
-                         << " middle=RGB(" 
-                         << qRed(middlePixel) << "," << qGreen(middlePixel) << "," << qBlue(middlePixel) << ")"
-                         << " last=RGB(" 
-                         << qRed(lastPixel) << "," << qGreen(lastPixel) << "," << qBlue(lastPixel) << ")";
-            }
-            
-            qDebug() << "====== MAT TO QIMAGE END (SUCCESS) ======\n";
-            return copy;
-        } else if (mat.type() == CV_8UC1) {
-            qDebug() << "MatToQImage: Processing CV_8UC1 (Grayscale) Mat - Using specialized function";
-            // 使用专门的灰度图像处理函数
-            QImage grayImage = ImageProcessor::createGrayscaleImage(mat);
-            if (grayImage.isNull()) {
-                qDebug() << "MatToQImage: Specialized grayscale conversion failed, trying fallback method";
-                // 如果专门的函数失败，尝试备用方法
-                cv::Mat grayCopy = mat.clone();
-                QImage result(grayCopy.data, grayCopy.cols, grayCopy.rows, grayCopy.step, QImage::Format_Grayscale8);
-                QImage copy = result.copy();
-                
-                qDebug() << "Fallback grayscale QImage: size=" << copy.width() << "x" << copy.height()
-                         << " format=" << copy.format() << " is null=" << copy.isNull();
-                
-                if (!copy.isNull() && copy.width() > 0 && copy.height() > 0) {
-                    int firstPixel = qGray(copy.pixel(0, 0));
-                    int middlePixel = qGray(copy.pixel(copy.width()/2, copy.height()/2));
-                    int lastPixel = qGray(copy.pixel(copy.width()-1, copy.height()-1));
-                    qDebug() << "Fallback QImage sample pixels: first=" << firstPixel
-                             << " middle=" << middlePixel
-                             << " last=" << lastPixel;
-                }
-                
-                qDebug() << "====== MAT TO QIMAGE END (FALLBACK SUCCESS) ======\n";
-                return copy;
-            }
-            
-            qDebug() << "MatToQImage: Created Grayscale QImage, size:" << grayImage.width() << "x" << grayImage.height()
-                     << "Format:" << grayImage.format() << "Depth:" << grayImage.depth();
-            qDebug() << "====== MAT TO QIMAGE END (SUCCESS) ======\n";
-            return grayImage;
-        } else {
-            qDebug() << "MatToQImage: Unsupported Mat type:" << mat.type() << ", trying to convert";
-            
-            // 尝试转换为支持的格式
-            cv::Mat converted;
-            if (mat.channels() == 1) {
-                // 如果是单通道但类型不是CV_8UC1
-                qDebug() << "MatToQImage: Converting single channel Mat to 8-bit";
-                mat.convertTo(converted, CV_8UC1);
-                // 使用专门的灰度图像处理函数
-                QImage result = ImageProcessor::createGrayscaleImage(converted);
-                qDebug() << "====== MAT TO QIMAGE END (CONVERTED SUCCESS) ======\n";
-                return result;
-            } else if (mat.channels() == 3) {
-                // 如果是三通道但类型不是CV_8UC3
-                qDebug() << "MatToQImage: Converting 3-channel Mat to 8-bit BGR";
-                mat.convertTo(converted, CV_8UC3);
-                cv::Mat rgb;
-                cv::cvtColor(converted, rgb, cv::COLOR_BGR2RGB);
-                cv::Mat rgbCopy = rgb.clone();
-                QImage result(rgbCopy.data, rgbCopy.cols, rgbCopy.rows, rgbCopy.step, QImage::Format_RGB888);
-                QImage copy = result.copy();
-                qDebug() << "MatToQImage: Converted to RGB QImage, size:" << copy.width() << "x" << copy.height()
-                         << "Format:" << copy.format() << "Is null:" << copy.isNull();
-                qDebug() << "====== MAT TO QIMAGE END (CONVERTED SUCCESS) ======\n";
-                return copy;
-            } else {
-                qDebug() << "MatToQImage: Unsupported Mat type and channel count, returning empty image";
-                qDebug() << "====== MAT TO QIMAGE END (FAILED) ======\n";
-                return QImage();
-            }
+        QImage image = mat.channels() == 1 ? createGrayscaleImage(mat) : ImageMatAdapter::toQImage(mat);
+        if (!image.isNull()) {
+            timer.stop();
         }
+        return image;
     } catch (const cv::Exception& e) {
         qDebug() << "OpenCV error in MatToQImage:" << e.what();
-        qDebug() << "====== MAT TO QIMAGE END (ERROR) ======\n";
-        return QImage();
     } catch (const std::exception& e) {
         qDebug() << "Error in MatToQImage:" << e.what();
-        qDebug() << "====== MAT TO QIMAGE END (ERROR) ======\n";
+    }
+    return QImage();
+}
+
+// 图像翻转：可直接包装的格式在两个视图之间完成，不经过格式转换
+QImage ImageProcessor::flipImage(const QImage &image, int flipCode)
+{
+    if (ImageMatAdapter::canWrap(image.format())) {
+        QImage flipped(image.size(), image.format());
+        if (flipped.isNull()) {
+            return QImage();
+        }
+        cv::Mat dst = ImageMatAdapter::view(flipped);
+        cv::flip(ImageMatAdapter::constView(image), dst, flipCode);
+        return flipped;
+    }
+
+    cv::Mat mat = QImageToMat(image);
+    if (mat.empty()) {
         return QImage();
     }
+    cv::Mat flippedMat;
+    cv::flip(mat, flippedMat, flipCode);
+    return MatToQImage(flippedMat);
 }
 
 // 添加新方法：应用线性变换 y = kx + b
@@ -1116,14 +763,16 @@ void ImageProcessor::applyLinearTransform(int kValue, int bValue)
         emit error(tr("没有可处理的图像"));
         return;
     }
+    cancelPendingJobs();
     
     qDebug() << "\n====== LINEAR TRANSFORM START ======";
+    Metrics::ScopedTimer timer("process.linearTransform");
     qDebug() << "Linear Transform - Parameters: k=" << kValue << " b=" << bValue;
     
     try {
         // 如果是灰度图像操作，应始终基于当前的灰度图像进行变换
         // 如果未处于灰度模式，则当前图像可能是彩色的，需要先转换为灰度
-        bool currentlyGrayscale = (processedImage.format() == QImage::Format_Grayscale8);
+        bool currentlyGrayscale = isGrayscaleFormat(processedImage.format());
         QImage inputImage;
         
         qDebug() << "Current image is grayscale: " << currentlyGrayscale;
@@ -1131,10 +780,8 @@ void ImageProcessor::applyLinearTransform(int kValue, int bValue)
         if (!currentlyGrayscale) {
             qDebug() << "Converting to grayscale first";
             
-            // 将当前图像转换为灰度图
-            cv::Mat colorMat = QImageToMat(processedImage);
-            cv::Mat grayMat;
-            cv::cvtColor(colorMat, grayMat, cv::COLOR_BGR2GRAY);
+            // 将当前图像转换为灰度图（直接从原始像素布局一次转换）
+            cv::Mat grayMat = ImageMatAdapter::toGrayMat(processedImage);
             
             // 保存临时灰度图像作为输入
             inputImage = createGrayscaleImage(grayMat);
@@ -1159,27 +806,11 @@ void ImageProcessor::applyLinearTransform(int kValue, int bValue)
             throw std::runtime_error("Failed to convert QImage to Mat");
         }
         
-        cv::Mat result;
-        
-        // 计算k值
-        double k = 1.0;
-        if (kValue >= 0) {
-            k = 1.0 + kValue / 100.0;  // k范围是1.0到2.0
-        } else {
-            k = 1.0 + kValue / 100.0;  // k范围是0.0到1.0
-        }
-        
-        // b值直接使用
-        double b = bValue;
-        
-        qDebug() << "Applied transformation: y = " << k << "x + " << b;
+        qDebug() << "Applied transformation: y = " << (1.0 + kValue / 100.0) << "x + " << bValue;
         
-        // 应用线性变换
-        mat.convertTo(result, -1, k, b);
-        
-        // 确保结果在0-255范围内
-        cv::threshold(result, result, 255, 255, cv::THRESH_TRUNC);
-        cv::threshold(result, result, 0, 0, cv::THRESH_TOZERO);
+        // 应用线性变换，结果饱和到所在位深的范围内（8位为0-255，16位为0-65535）
+        const PointOpChain chain = ImageOperations::linearChain(kValue, bValue);
+        cv::Mat result = applyPointOpsInROI(mat, chain);
         
         // 转换回QImage
         QImage transformedImage = createGrayscaleImage(result);
@@ -1187,10 +818,14 @@ void ImageProcessor::applyLinearTransform(int kValue, int bValue)
             throw std::runtime_error("Failed to convert result to QImage");
         }
         
-        // 更新处理后的图像
+        // 更新处理后的图像，输入已统计过时直方图由查找表换算（只处理ROI时不能换算）
+        if (processingROI.isEmpty()) {
+            ImageStatisticsCache::derive(inputImage, transformedImage, chain.compile(mat.depth()));
+        }
         processedImage = transformedImage;
         
         qDebug() << "Linear transform completed successfully";
+        timer.stop();
         qDebug() << "====== LINEAR TRANSFORM END ======\n";
         emit imageProcessed();
     } catch (const cv::Exception& e) {
@@ -1208,6 +843,58 @@ void ImageProcessor::applyLinearTransform(int kValue, int bValue)
     }
 }
 
+// 亮度调整：所有通道整体平移 value，保持彩色图像的通道数
+void ImageProcessor::adjustBrightness(int value)
+{
+    qDebug() << "\n====== BRIGHTNESS START ======";
+    if (processedImage.isNull()) {
+        emit error(tr("没有可处理的图像"));
+        qDebug() << "====== BRIGHTNESS ERROR END (NULL IMAGE) ======\n";
+        return;
+    }
+    cancelPendingJobs();
+    Metrics::ScopedTimer timer("process.brightness");
+
+    qDebug() << "Adjusting brightness by" << value;
+
+    try {
+        cv::Mat mat = QImageToMat(processedImage);
+        if (mat.empty()) {
+            throw std::runtime_error("Failed to convert QImage to Mat");
+        }
+
+        // y = x + value，编译为一张查找表对所有通道一次遍历
+        PointOpChain chain;
+        chain.linear(1.0, value);
+        cv::Mat resultMat = applyPointOpsInROI(mat, chain);
+
+        QImage result = MatToQImage(resultMat);
+        if (result.isNull()) {
+            throw std::runtime_error("Failed to convert result to QImage");
+        }
+
+        if (processingROI.isEmpty()) {
+            ImageStatisticsCache::derive(processedImage, result, chain.compile(mat.depth()));
+        }
+        processedImage = result;
+        timer.stop();
+        qDebug() << "====== BRIGHTNESS END ======\n";
+        emit imageProcessed();
+    } catch (const cv::Exception& e) {
+        qDebug() << "OpenCV error in brightness adjustment:" << e.what();
+        emit error(tr("OpenCV错误: %1").arg(e.what()));
+        qDebug() << "====== BRIGHTNESS ERROR END ======\n";
+    } catch (const std::exception& e) {
+        qDebug() << "Error in brightness adjustment:" << e.what();
+        emit error(tr("处理错误: %1").arg(e.what()));
+        qDebug() << "====== BRIGHTNESS ERROR END ======\n";
+    } catch (...) {
+        qDebug() << "Unknown error in brightness adjustment";
+        emit error(tr("未知错误"));
+        qDebug() << "====== BRIGHTNESS ERROR END ======\n";
+    }
+}
+
 // 伽马对比度调整
 void ImageProcessor::adjustGammaContrast(double gamma, int contrast)
 {
@@ -1217,6 +904,8 @@ void ImageProcessor::adjustGammaContrast(double gamma, int contrast)
         qDebug() << "====== GAMMA CONTRAST ERROR END (NULL IMAGE) ======\n";
         return;
     }
+    cancelPendingJobs();
+    Metrics::ScopedTimer timer("process.gammaContrast");
     
     qDebug() << "Applying gamma correction with gamma=" << gamma 
              << " and contrast adjustment with contrast=" << contrast;
@@ -1224,7 +913,7 @@ void ImageProcessor::adjustGammaContrast(double gamma, int contrast)
     try {
         // 如果是灰度图像操作，应始终基于当前的灰度图像进行变换
         // 如果未处于灰度模式，则当前图像可能是彩色的，需要先转换为灰度
-        bool currentlyGrayscale = (processedImage.format() == QImage::Format_Grayscale8);
+        bool currentlyGrayscale = isGrayscaleFormat(processedImage.format());
         QImage inputImage;
         
         qDebug() << "Current image is grayscale: " << currentlyGrayscale;
@@ -1232,10 +921,8 @@ void ImageProcessor::adjustGammaContrast(double gamma, int contrast)
         if (!currentlyGrayscale) {
             qDebug() << "Converting to grayscale first";
             
-            // 将当前图像转换为灰度图
-            cv::Mat colorMat = QImageToMat(processedImage);
-            cv::Mat grayMat;
-            cv::cvtColor(colorMat, grayMat, cv::COLOR_BGR2GRAY);
+            // 将当前图像转换为灰度图（直接从原始像素布局一次转换）
+            cv::Mat grayMat = ImageMatAdapter::toGrayMat(processedImage);
             
             // 保存临时灰度图像作为输入
             inputImage = createGrayscaleImage(grayMat);
@@ -1265,31 +952,9 @@ void ImageProcessor::adjustGammaContrast(double gamma, int contrast)
         qDebug() << "Input image format: channels=" << mat.channels() 
                  << " type=" << mat.type() << " depth=" << mat.depth();
         
-        // 创建查找表(LUT)进行伽马校正
-        cv::Mat lookUpTable(1, 256, CV_8U);
-        uchar* p = lookUpTable.ptr();
-        
-        // 计算对比度系数
-        double contrastFactor = 1.0 + contrast / 100.0;
-        qDebug() << "Contrast factor:" << contrastFactor;
-        
-        // 填充查找表，应用伽马校正和对比度调整
-        for (int i = 0; i < 256; ++i) {
-            // 伽马校正: s = c * r^γ (其中r是输入像素值, s是输出像素值)
-            double pixelValue = pow(i / 255.0, 1.0 / gamma) * 255.0;
-            
-            // 应用对比度调整: s = (s - 128) * contrast_factor + 128
-            pixelValue = (pixelValue - 128) * contrastFactor + 128;
-            
-            // 确保值在0-255范围内
-            pixelValue = std::min(255.0, std::max(0.0, pixelValue));
-            
-            p[i] = cv::saturate_cast<uchar>(pixelValue);
-        }
-        
-        // 应用查找表进行变换
-        cv::Mat resultMat;
-        cv::LUT(mat, lookUpTable, resultMat);
+        // 通过查找表(LUT)应用伽马校正和对比度调整
+        const PointOpChain chain = ImageOperations::gammaContrastChain(gamma, contrast);
+        cv::Mat resultMat = applyPointOpsInROI(mat, chain);
         
         // 转换回QImage
         QImage result = createGrayscaleImage(resultMat);
@@ -1300,8 +965,12 @@ void ImageProcessor::adjustGammaContrast(double gamma, int contrast)
             return;
         }
         
+        if (processingROI.isEmpty()) {
+            ImageStatisticsCache::derive(inputImage, result, chain.compile(mat.depth()));
+        }
         processedImage = result;
         qDebug() << "Gamma and contrast adjustment applied successfully";
+        timer.stop();
         qDebug() << "====== GAMMA CONTRAST END ======\n";
         emit imageProcessed();
     } catch (const cv::Exception& e) {
@@ -1332,15 +1001,15 @@ void ImageProcessor::saveGrayscaleImage()
         // 如果当前图像是灰度图，将其保存到grayscaleImage
         if (isGrayscale()) {
             grayscaleImage = processedImage.copy(); // 使用深拷贝确保数据独立
+            updatePipelineSource();
             qDebug() << "已保存当前灰度图像";
         } else {
             // 如果不是灰度图，先转换为灰度图再保存
             try {
-                cv::Mat mat = QImageToMat(processedImage);
-                if (!mat.empty()) {
-                    cv::Mat gray;
-                    cv::cvtColor(mat, gray, cv::COLOR_BGR2GRAY);
+                cv::Mat gray = ImageMatAdapter::toGrayMat(processedImage);
+                if (!gray.empty()) {
                     grayscaleImage = MatToQImage(gray);
+                    updatePipelineSource();
                     qDebug() << "已将彩色图像转换为灰度图像并保存";
                 } else {
                     qDebug() << "转换为Mat失败，无法保存灰度图像";
@@ -1364,7 +1033,7 @@ bool ImageProcessor::isGrayscale() const
         }
         
         // 检查图像格式
-        if (processedImage.format() == QImage::Format_Grayscale8) {
+        if (isGrayscaleFormat(processedImage.format())) {
             return true;
         }
         
@@ -1400,6 +1069,7 @@ bool ImageProcessor::isGrayscale() const
 // 恢复到灰度图像状态
 void ImageProcessor::restoreGrayscaleImage()
 {
+    cancelPendingJobs();
     try {
         if (!grayscaleImage.isNull()) {
             // 使用深拷贝确保数据独立
@@ -1411,10 +1081,8 @@ void ImageProcessor::restoreGrayscaleImage()
             qDebug() << "没有保存的灰度图像，从原始图像转换";
             if (!originalImage.isNull()) {
                 // 直接从原始图像转换为灰度，避免调用convertToGrayscale()
-                cv::Mat mat = QImageToMat(originalImage);
-                if (!mat.empty()) {
-                    cv::Mat gray;
-                    cv::cvtColor(mat, gray, cv::COLOR_BGR2GRAY);
+                cv::Mat gray = ImageMatAdapter::toGrayMat(originalImage);
+                if (!gray.empty()) {
                     processedImage = MatToQImage(gray);
                     emit imageProcessed();
                 } else {
@@ -1429,6 +1097,295 @@ void ImageProcessor::restoreGrayscaleImage()
     }
 }
 
+// 设置处理范围：之后的滤波、点运算和管线只作用于ROI
+void ImageProcessor::setProcessingROI(const RoiMask &roi)
+{
+    processingROI = roi;
+    pipeline.setRoi(roi);
+}
+
+const RoiMask& ImageProcessor::getProcessingROI() const
+{
+    return processingROI;
+}
+
+// 点运算，设置了处理范围时只作用于ROI
+cv::Mat ImageProcessor::applyPointOpsInROI(const cv::Mat &mat, const PointOpChain &chain) const
+{
+    return ImageOperations::applyInRoi(mat, processingROI, 0,
+        [&chain](const cv::Mat &tile, const cv::Rect &) {
+            return ImageOperations::applyPointOps(tile, chain);
+        });
+}
+
+// 启用管线阶段并设置参数，参数未变化时该阶段的缓存继续有效
+void ImageProcessor::setPipelineStage(OperationGraph::Stage stage, const QVariantList &parameters)
+{
+    pipeline.setStage(stage, parameters);
+}
+
+void ImageProcessor::disablePipelineStage(OperationGraph::Stage stage)
+{
+    pipeline.disableStage(stage);
+}
+
+void ImageProcessor::resetPipeline()
+{
+    pipeline.disableAllStages();
+}
+
+QJsonObject ImageProcessor::exportPipeline() const
+{
+    return pipeline.stagesToJson();
+}
+
+// 计算管线输出：只有参数变化的阶段及其下游会重新计算
+void ImageProcessor::renderPipeline()
+{
+    qDebug() << "\n====== PIPELINE RENDER START ======";
+    if (pipelineSource.isNull()) {
+        emit error(tr("没有可处理的图像"));
+        qDebug() << "====== PIPELINE RENDER ERROR END (NULL SOURCE) ======\n";
+        return;
+    }
+    Metrics::ScopedTimer timer("process.renderPipeline");
+
+    try {
+        qDebug() << "First dirty stage:" << pipeline.firstDirtyStage();
+        cv::Mat result = pipeline.evaluate();
+
+        QImage image = MatToQImage(result);
+        if (image.isNull()) {
+            throw std::runtime_error("Failed to convert pipeline result to QImage");
+        }
+
+        // 点运算段之后的统计由查找表换算，直方图对话框不必重新遍历输出
+        ImageStatisticsCache::insert(image, pipeline.statistics());
+        processedImage = image;
+        timer.stop();
+        qDebug() << "====== PIPELINE RENDER END ======\n";
+        emit imageProcessed();
+    } catch (const cv::Exception& e) {
+        qDebug() << "OpenCV error in pipeline:" << e.what();
+        emit error(tr("OpenCV错误: %1").arg(e.what()));
+        qDebug() << "====== PIPELINE RENDER ERROR END ======\n";
+    } catch (const std::exception& e) {
+        qDebug() << "Error in pipeline:" << e.what();
+        emit error(tr("处理错误: %1").arg(e.what()));
+        qDebug() << "====== PIPELINE RENDER ERROR END ======\n";
+    } catch (...) {
+        qDebug() << "Unknown error in pipeline";
+        emit error(tr("未知错误"));
+        qDebug() << "====== PIPELINE RENDER ERROR END ======\n";
+    }
+}
+
+// 在后台线程中计算管线：使用管线的副本，完成后把副本的缓存合并回来
+ProcessingJob ImageProcessor::renderPipelineAsync()
+{
+    if (pipelineSource.isNull()) {
+        emit error(tr("没有可处理的图像"));
+        return ProcessingJob();
+    }
+
+    jobExecutor->cancel(QStringLiteral("preview"));  // 全分辨率结果到来后旧预览不再需要
+    qDebug() << "Pipeline async render, first dirty stage:" << pipeline.firstDirtyStage();
+    QSharedPointer<OperationGraph> snapshot(new OperationGraph(pipeline));
+    QImage source = pipelineSource;  // 持有源图像，保证后台线程中的视图数据有效
+    QSharedPointer<ImageStatistics> statistics(new ImageStatistics);
+
+    return jobExecutor->submit(QStringLiteral("pipeline"),
+        [this, snapshot, source, statistics](const ProcessingJob &job) {
+            Q_UNUSED(source);
+            Metrics::ScopedTimer timer("job.pipeline");
+            const cv::Mat result = snapshot->evaluate(jobControl(job));
+            if (!result.empty()) {
+                // 统计随输出一同在后台得到：只改点运算参数时只需换算直方图
+                *statistics = snapshot->statistics(jobControl(job));
+                timer.stop();
+            }
+            return result;
+        },
+        [this, snapshot, statistics](const cv::Mat &result) {
+            pipeline.adoptCache(*snapshot);
+
+            QImage image = MatToQImage(result);
+            if (image.isNull()) {
+                emit error(tr("管线结果转换失败"));
+                return;
+            }
+            ImageStatisticsCache::insert(image, *statistics);
+            processedImage = image;
+            emit imageProcessed();
+        });
+}
+
+// 拖动控件时的快速预览：管线在显示尺寸的代理图像上计算，参数语义与全分辨率一致
+ProcessingJob ImageProcessor::renderPipelinePreviewAsync(const QSize &displaySize)
+{
+    if (pipelineSource.isNull()) {
+        emit error(tr("没有可处理的图像"));
+        return ProcessingJob();
+    }
+
+    // 参数已经改变，未完成的全分辨率结果已经过时
+    jobExecutor->cancel(QStringLiteral("pipeline"));
+
+    updatePreviewSource(displaySize);
+    if (previewScale >= 1.0) {
+        // 图像不大于显示区域，直接计算全分辨率结果
+        return renderPipelineAsync();
+    }
+
+    previewPipeline.copyStages(pipeline, previewScale);
+    QSharedPointer<OperationGraph> snapshot(new OperationGraph(previewPipeline));
+
+    return jobExecutor->submit(QStringLiteral("preview"),
+        [this, snapshot](const ProcessingJob &job) {
+            Metrics::ScopedTimer timer("job.preview");
+            cv::Mat result = snapshot->evaluate(jobControl(job));
+            if (!result.empty()) {
+                timer.stop();
+            }
+            return result;
+        },
+        [this, snapshot](const cv::Mat &result) {
+            previewPipeline.adoptCache(*snapshot);
+
+            QImage image = MatToQImage(result);
+            if (!image.isNull()) {
+                emit previewReady(image);
+            }
+        });
+}
+
+// 在后台线程中对当前处理后的图像进行滤波，语义与同步的滤波函数一致
+ProcessingJob ImageProcessor::applyFilterAsync(OperationGraph::FilterType type, int kernelSize,
+                                               double sigma, bool subtractFromOriginal,
+                                               double gain, double offset)
+{
+    if (processedImage.isNull()) {
+        emit error(tr("没有可处理的图像"));
+        return ProcessingJob();
+    }
+    if (!validateFilterKernel(type, kernelSize)) {
+        return ProcessingJob();
+    }
+
+    qDebug() << "Filter async: type=" << type << " kernelSize=" << kernelSize
+             << " sigma=" << sigma << " subtractFromOriginal=" << subtractFromOriginal
+             << " gain=" << gain << " offset=" << offset;
+    QImage input = processedImage;
+    QImage original = subtractFromOriginal ? originalImage : QImage();
+    const RoiMask roi = processingROI;
+
+    return jobExecutor->submit(QStringLiteral("filter"),
+        [this, input, original, roi, type, kernelSize, sigma, gain, offset](const ProcessingJob &job) {
+            Metrics::ScopedTimer timer("job.filter");
+            // 高通与滤波在同一遍中完成，不再生成完整的滤波图像后整幅相减
+            // 设置了处理范围时只计算ROI的包围盒加上核的halo
+            const HighPass highPass = original.isNull() ? HighPass()
+                                                        : HighPass(QImageToMat(original), gain, offset);
+            cv::Mat result = OperationGraph::filterInRoi(type, kernelSize, sigma, QImageToMat(input), roi,
+                                                         highPass, jobControl(job));
+            timer.stop();
+            return result;
+        },
+        [this, inputKey = input.cacheKey()](const cv::Mat &result) {
+            // 任务运行期间处理后的图像已被替换（切换图像、翻转等），结果不再适用
+            if (processedImage.cacheKey() != inputKey) {
+                qDebug() << "Filter async: input image changed, result discarded";
+                return;
+            }
+            QImage image = MatToQImage(result);
+            if (image.isNull()) {
+                emit error(tr("滤波结果转换失败"));
+                return;
+            }
+            processedImage = image;
+            emit imageProcessed();
+        });
+}
+
+TileScheduler::Control ImageProcessor::jobControl(const ProcessingJob &job) const
+{
+    // 在工作线程中调用：只访问任务句柄和执行器，执行器析构前会等待所有任务结束
+    ProcessingJobExecutor *executor = jobExecutor;
+    TileScheduler::Control control;
+    control.cancelled = [job]() { return job.isCancelled(); };
+    control.progress = [executor, job](int done, int total) { executor->reportProgress(job, done, total); };
+    return control;
+}
+
+void ImageProcessor::cancelPendingJobs()
+{
+    jobExecutor->cancelAll();
+}
+
+bool ImageProcessor::hasPendingJobs() const
+{
+    return jobExecutor->isBusy();
+}
+
+const SummedAreaTable& ImageProcessor::summedAreaTable(const QImage &image)
+{
+    if (image.isNull()) {
+        summedArea = SummedAreaTable();
+        summedAreaKey = 0;
+        return summedArea;
+    }
+    if (image.cacheKey() == summedAreaKey && !summedArea.isEmpty()) {
+        return summedArea;
+    }
+
+    // 能直接包装的格式零拷贝建表，灰度按qGray的权重计算，与直方图一致
+    const ImageMatAdapter::ChannelOrder order = ImageMatAdapter::channelOrder(image.format());
+    const cv::Mat mat = order != ImageMatAdapter::OrderUnknown ? ImageMatAdapter::constView(image)
+                                                               : ImageMatAdapter::toMat(image);
+    qDebug() << "Building summed-area table:" << mat.cols << "x" << mat.rows;
+    summedArea = SummedAreaTable(mat, order == ImageMatAdapter::OrderRGB);
+    summedAreaKey = image.cacheKey();
+    return summedArea;
+}
+
+void ImageProcessor::updatePipelineSource()
+{
+    pipelineSource = grayscaleImage.isNull() ? originalImage : grayscaleImage;
+    // 灰度图像直接以视图形式进入管线，pipelineSource保证其数据有效
+    pipeline.setSource(QImageToMat(pipelineSource));
+
+    // 预览源图像在下一次预览时按显示尺寸重新生成
+    previewPipeline.setSource(cv::Mat());
+    previewDisplaySize = QSize();
+    previewScale = 1.0;
+}
+
+void ImageProcessor::updatePreviewSource(const QSize &displaySize)
+{
+    const cv::Mat &source = pipeline.source();
+    if (displaySize == previewDisplaySize && !previewPipeline.source().empty()) {
+        return;
+    }
+
+    previewDisplaySize = displaySize;
+    previewScale = 1.0;
+    if (source.empty() || displaySize.isEmpty()) {
+        return;
+    }
+
+    previewScale = qMin(1.0, qMin(static_cast<double>(displaySize.width()) / source.cols,
+                                  static_cast<double>(displaySize.height()) / source.rows));
+    if (previewScale >= 1.0) {
+        return;
+    }
+
+    // 区域插值缩小，相当于取显示尺寸对应的金字塔层
+    cv::Mat proxy;
+    cv::resize(source, proxy, cv::Size(), previewScale, previewScale, cv::INTER_AREA);
+    previewPipeline.setSource(proxy);
+    qDebug() << "Preview source:" << proxy.cols << "x" << proxy.rows << "scale=" << previewScale;
+}
+
 // 实现调试函数，用于打印图像信息
 void ImageProcessor::debugImageInfo() const
 {
@@ -1442,7 +1399,7 @@ void ImageProcessor::debugImageInfo() const
         qDebug() << "   Format: " << originalImage.format();
         qDebug() << "   Depth: " << originalImage.depth();
         qDebug() << "   Bytes per line: " << originalImage.bytesPerLine();
-        qDebug() << "   Is Grayscale: " << (originalImage.format() == QImage::Format_Grayscale8);
+        qDebug() << "   Is Grayscale: " << isGrayscaleFormat(originalImage.format());
     } else {
         qDebug() << "Original Image: NULL";
     }
@@ -1455,7 +1412,7 @@ void ImageProcessor::debugImageInfo() const
         qDebug() << "   Format: " << processedImage.format();
         qDebug() << "   Depth: " << processedImage.depth();
         qDebug() << "   Bytes per line: " << processedImage.bytesPerLine();
-        qDebug() << "   Is Grayscale: " << (processedImage.format() == QImage::Format_Grayscale8);
+        qDebug() << "   Is Grayscale: " << isGrayscaleFormat(processedImage.format());
         
         // 尝试转换为Mat并检查通道数
         try {
@@ -1480,7 +1437,7 @@ void ImageProcessor::debugImageInfo() const
         qDebug() << "Grayscale Image Cache:";
         qDebug() << "   Size: " << grayscaleImage.width() << "x" << grayscaleImage.height();
         qDebug() << "   Format: " << grayscaleImage.format();
-        qDebug() << "   Is Grayscale: " << (grayscaleImage.format() == QImage::Format_Grayscale8);
+        qDebug() << "   Is Grayscale: " << isGrayscaleFormat(grayscaleImage.format());
     } else {
         qDebug() << "Grayscale Image Cache: NULL";
     }
@@ -1491,113 +1448,23 @@ void ImageProcessor::debugImageInfo() const
 // 处理单通道灰度图像转换为QImage
 QImage ImageProcessor::createGrayscaleImage(const cv::Mat &grayscaleMat)
 {
-    qDebug() << "\n====== CREATE GRAYSCALE IMAGE START ======";
-    qDebug() << "Creating specialized grayscale QImage from Mat";
-    qDebug() << "Input Mat: size=" << grayscaleMat.cols << "x" << grayscaleMat.rows
-             << " type=" << grayscaleMat.type() << " channels=" << grayscaleMat.channels()
-             << " depth=" << grayscaleMat.depth() << " is continuous=" << grayscaleMat.isContinuous();
-    
-    // 检查Mat是否有效
     if (grayscaleMat.empty()) {
-        qDebug() << "ERROR: Input Mat is empty!";
-        qDebug() << "====== CREATE GRAYSCALE IMAGE END (FAILED) ======\n";
+        qDebug() << "createGrayscaleImage: Input Mat is empty";
         return QImage();
     }
-    
-    // 检查像素值范围，用于诊断
-    double minVal, maxVal;
-    cv::minMaxLoc(grayscaleMat, &minVal, &maxVal);
-    qDebug() << "Mat pixel value range: min=" << minVal << " max=" << maxVal;
-    
-    // 取样一些像素值
-    if (grayscaleMat.rows > 0 && grayscaleMat.cols > 0) {
-        uchar firstPixel = grayscaleMat.at<uchar>(0, 0);
-        uchar middlePixel = grayscaleMat.at<uchar>(grayscaleMat.rows/2, grayscaleMat.cols/2);
-        uchar lastPixel = grayscaleMat.at<uchar>(grayscaleMat.rows-1, grayscaleMat.cols-1);
-        qDebug() << "Sample pixels: first=" << static_cast<int>(firstPixel)
-                 << " middle=" << static_cast<int>(middlePixel)
-                 << " last=" << static_cast<int>(lastPixel);
-    }
-    
-    try {
-        // 确保矩阵类型正确
-        if (grayscaleMat.type() != CV_8UC1) {
-            qDebug() << "Converting matrix type to CV_8UC1 from type:" << grayscaleMat.type();
-            cv::Mat convertedMat;
-            grayscaleMat.convertTo(convertedMat, CV_8UC1);
-            
-            // 再次检查像素值范围
-            double newMinVal, newMaxVal;
-            cv::minMaxLoc(convertedMat, &newMinVal, &newMaxVal);
-            qDebug() << "Converted Mat pixel value range: min=" << newMinVal << " max=" << newMaxVal;
-            
-            // 确保数据连续
-            cv::Mat continuousMat;
-            if (!convertedMat.isContinuous()) {
-                qDebug() << "Making data continuous";
-                continuousMat = convertedMat.clone();
-            } else {
-                continuousMat = convertedMat;
-            }
-            
-            // 创建QImage并复制数据
-            QImage result(continuousMat.data, continuousMat.cols, continuousMat.rows, 
-                         continuousMat.step, QImage::Format_Grayscale8);
-            QImage copy = result.copy(); // 深拷贝
-            
-            qDebug() << "Created QImage: size=" << copy.width() << "x" << copy.height()
-                     << " format=" << copy.format() << " depth=" << copy.depth()
-                     << " is null=" << copy.isNull();
-                     
-            // 检查QImage像素值
-            if (!copy.isNull() && copy.width() > 0 && copy.height() > 0) {
-                int firstQPixel = qGray(copy.pixel(0, 0));
-                int middleQPixel = qGray(copy.pixel(copy.width()/2, copy.height()/2));
-                int lastQPixel = qGray(copy.pixel(copy.width()-1, copy.height()-1));
-                qDebug() << "QImage sample pixels: first=" << firstQPixel
-                         << " middle=" << middleQPixel
-                         << " last=" << lastQPixel;
-            }
-            
-            qDebug() << "====== CREATE GRAYSCALE IMAGE END (SUCCESS) ======\n";
-            return copy;
-        } else {
-            // 确保数据连续
-            cv::Mat continuousMat;
-            if (!grayscaleMat.isContinuous()) {
-                qDebug() << "Making data continuous";
-                continuousMat = grayscaleMat.clone();
-            } else {
-                continuousMat = grayscaleMat;
-            }
-            
-            // 创建QImage并复制数据
-            QImage result(continuousMat.data, continuousMat.cols, continuousMat.rows, 
-                         continuousMat.step, QImage::Format_Grayscale8);
-            QImage copy = result.copy(); // 深拷贝
-            
-            qDebug() << "Created QImage: size=" << copy.width() << "x" << copy.height()
-                     << " format=" << copy.format() << " depth=" << copy.depth()
-                     << " is null=" << copy.isNull();
-                     
-            // 检查QImage像素值
-            if (!copy.isNull() && copy.width() > 0 && copy.height() > 0) {
-                int firstQPixel = qGray(copy.pixel(0, 0));
-                int middleQPixel = qGray(copy.pixel(copy.width()/2, copy.height()/2));
-                int lastQPixel = qGray(copy.pixel(copy.width()-1, copy.height()-1));
-                qDebug() << "QImage sample pixels: first=" << firstQPixel
-                         << " middle=" << middleQPixel
-                         << " last=" << lastQPixel;
-            }
-            
-            qDebug() << "====== CREATE GRAYSCALE IMAGE END (SUCCESS) ======\n";
-            return copy;
-        }
-    } catch (const std::exception& e) {
-        qDebug() << "Error in createGrayscaleImage:" << e.what();
-        qDebug() << "====== CREATE GRAYSCALE IMAGE END (ERROR) ======\n";
+
+    if (grayscaleMat.channels() != 1) {
+        qDebug() << "createGrayscaleImage: Expected single channel Mat, got" << grayscaleMat.channels();
         return QImage();
     }
+
+    // 8位写入Grayscale8，16位写入Grayscale16；其它位深先饱和转换为8位
+    if (grayscaleMat.depth() != CV_8U && grayscaleMat.depth() != CV_16U) {
+        cv::Mat convertedMat;
+        grayscaleMat.convertTo(convertedMat, CV_8UC1);
+        return ImageMatAdapter::toQImage(convertedMat);
+    }
+    return ImageMatAdapter::toQImage(grayscaleMat);
 }
 
 // 将图像转换为灰度图
@@ -1609,9 +1476,11 @@ void ImageProcessor::convertToGrayscale()
         qDebug() << "====== CONVERT TO GRAYSCALE ERROR END (NULL IMAGE) ======\n";
         return;
     }
+    cancelPendingJobs();
+    Metrics::ScopedTimer timer("process.grayscale");
     
     // 检查图像是否已经是灰度图
-    if (processedImage.format() == QImage::Format_Grayscale8) {
+    if (isGrayscaleFormat(processedImage.format())) {
         qDebug() << "Image is already grayscale, no conversion needed";
         qDebug() << "====== CONVERT TO GRAYSCALE END (ALREADY GRAYSCALE) ======\n";
         return;
@@ -1619,18 +1488,15 @@ void ImageProcessor::convertToGrayscale()
     
     try {
         qDebug() << "Converting image to grayscale...";
-        cv::Mat mat = QImageToMat(processedImage);
+        cv::Mat grayMat = ImageMatAdapter::toGrayMat(processedImage);
         
-        if (mat.empty()) {
-            qDebug() << "Error: QImageToMat returned empty matrix";
+        if (grayMat.empty()) {
+            qDebug() << "Error: grayscale conversion returned empty matrix";
             emit error(tr("图像转换失败"));
             qDebug() << "====== CONVERT TO GRAYSCALE ERROR END (CONVERSION FAILED) ======\n";
             return;
         }
         
-        cv::Mat grayMat;
-        cv::cvtColor(mat, grayMat, cv::COLOR_BGR2GRAY);
-        
         // 使用专门的灰度图像处理函数
         processedImage = createGrayscaleImage(grayMat);
         
@@ -1645,6 +1511,7 @@ void ImageProcessor::convertToGrayscale()
         saveGrayscaleImage();
         
         qDebug() << "Grayscale conversion completed successfully";
+        timer.stop();
         qDebug() << "====== CONVERT TO GRAYSCALE END ======\n";
         emit imageProcessed();
     } catch (const cv::Exception& e) {
@@ -1671,6 +1538,8 @@ void ImageProcessor::applyHistogramEqualization()
         qDebug() << "====== HISTOGRAM EQUALIZATION ERROR END (NULL IMAGE) ======\n";
         return;
     }
+    cancelPendingJobs();
+    Metrics::ScopedTimer timer("process.equalizeHistogram");
     
     try {
         cv::Mat mat = QImageToMat(processedImage);
@@ -1681,32 +1550,9 @@ void ImageProcessor::applyHistogramEqualization()
             return;
         }
         
-        cv::Mat result;
-        
-        // 根据图像通道数选择不同的处理方式
-        if (mat.channels() == 1) {
-            // 灰度图像直接进行直方图均衡化
-            qDebug() << "Equalizing grayscale image histogram";
-            cv::equalizeHist(mat, result);
-        } else {
-            // 彩色图像需要在YUV/Lab空间进行处理
-            qDebug() << "Equalizing color image histogram in YUV space";
-            cv::Mat yuv;
-            cv::cvtColor(mat, yuv, cv::COLOR_BGR2YUV);
-            
-            // 分离通道
-            std::vector<cv::Mat> channels;
-            cv::split(yuv, channels);
-            
-            // 只对亮度通道Y进行均衡化处理
-            cv::equalizeHist(channels[0], channels[0]);
-            
-            // 合并通道
-            cv::merge(channels, yuv);
-            
-            // 转换回BGR空间
-            cv::cvtColor(yuv, result, cv::COLOR_YUV2BGR);
-        }
+        // 灰度图像直接均衡化，彩色图像只均衡YUV空间的亮度通道
+        qDebug() << "Equalizing histogram, channels:" << mat.channels();
+        cv::Mat result = ImageOperations::equalizeHistogram(mat);
         
         // 转换回QImage
         QImage qResult = MatToQImage(result);
@@ -1719,6 +1565,7 @@ void ImageProcessor::applyHistogramEqualization()
         
         processedImage = qResult;
         qDebug() << "Histogram equalization applied successfully";
+        timer.stop();
         qDebug() << "====== HISTOGRAM EQUALIZATION END ======\n";
         emit imageProcessed();
     } catch (const cv::Exception& e) {
@@ -1745,6 +1592,8 @@ void ImageProcessor::applyHistogramStretching()
         qDebug() << "====== HISTOGRAM STRETCHING ERROR END (NULL IMAGE) ======\n";
         return;
     }
+    cancelPendingJobs();
+    Metrics::ScopedTimer timer("process.stretchHistogram");
     
     try {
         cv::Mat mat = QImageToMat(processedImage);
@@ -1755,58 +1604,9 @@ void ImageProcessor::applyHistogramStretching()
             return;
         }
         
-        cv::Mat result;
-        
-        // 根据图像通道数选择不同的处理方式
-        if (mat.channels() == 1) {
-            // 灰度图像处理
-            qDebug() << "Stretching grayscale image histogram";
-            // 找到最小值和最大值
-            double minVal, maxVal;
-            cv::minMaxLoc(mat, &minVal, &maxVal);
-            qDebug() << "Original range: min=" << minVal << " max=" << maxVal;
-            
-            // 如果范围已经是0-255，则不需要进一步处理
-            if (minVal == 0 && maxVal == 255) {
-                qDebug() << "Image already uses full range (0-255), no stretching needed";
-                result = mat.clone();
-            } else {
-                // 线性拉伸 newPixel = (pixel - min) * 255 / (max - min)
-                mat.convertTo(result, -1, 255.0 / (maxVal - minVal), -minVal * 255.0 / (maxVal - minVal));
-                
-                // 验证结果
-                cv::minMaxLoc(result, &minVal, &maxVal);
-                qDebug() << "Stretched range: min=" << minVal << " max=" << maxVal;
-            }
-        } else {
-            // 彩色图像处理
-            qDebug() << "Stretching color image histogram";
-            // 转换到YUV色彩空间
-            cv::Mat yuv;
-            cv::cvtColor(mat, yuv, cv::COLOR_BGR2YUV);
-            
-            // 分离通道
-            std::vector<cv::Mat> channels;
-            cv::split(yuv, channels);
-            
-            // 只拉伸亮度通道Y
-            double minVal, maxVal;
-            cv::minMaxLoc(channels[0], &minVal, &maxVal);
-            qDebug() << "Original Y channel range: min=" << minVal << " max=" << maxVal;
-            
-            // 线性拉伸
-            channels[0].convertTo(channels[0], -1, 255.0 / (maxVal - minVal), -minVal * 255.0 / (maxVal - minVal));
-            
-            // 验证结果
-            cv::minMaxLoc(channels[0], &minVal, &maxVal);
-            qDebug() << "Stretched Y channel range: min=" << minVal << " max=" << maxVal;
-            
-            // 合并通道
-            cv::merge(channels, yuv);
-            
-            // 转换回BGR空间
-            cv::cvtColor(yuv, result, cv::COLOR_YUV2BGR);
-        }
+        // 灰度图像直接线性拉伸，彩色图像只拉伸YUV空间的亮度通道
+        qDebug() << "Stretching histogram, channels:" << mat.channels();
+        cv::Mat result = ImageOperations::stretchHistogram(mat);
         
         // 转换回QImage
         QImage qResult = MatToQImage(result);
@@ -1819,6 +1619,7 @@ void ImageProcessor::applyHistogramStretching()
         
         processedImage = qResult;
         qDebug() << "Histogram stretching applied successfully";
+        timer.stop();
         qDebug() << "====== HISTOGRAM STRETCHING END ======\n";
         emit imageProcessed();
     } catch (const cv::Exception& e) {
@@ -1856,11 +1657,36 @@ int ImageProcessor::getKernelSize() const
     return kernelSize;
 }
 
+int ImageProcessor::maxKernelSize(OperationGraph::FilterType type)
+{
+    return type == OperationGraph::FilterMean ? ImageOperations::MAX_MEAN_KERNEL_SIZE
+         : type == OperationGraph::FilterMedian ? ImageOperations::MAX_MEDIAN_KERNEL_SIZE
+         : ImageOperations::MAX_GAUSSIAN_KERNEL_SIZE;
+}
+
+// 后台滤波和管线的滤波阶段共用的核大小检查；高斯滤波的核大小为0时由sigma决定
+bool ImageProcessor::validateFilterKernel(OperationGraph::FilterType type, int kernelSize)
+{
+    if (type == OperationGraph::FilterGaussian && kernelSize == 0) {
+        return true;
+    }
+    if (kernelSize % 2 == 0) {
+        emit error(tr("核大小必须是奇数"));
+        return false;
+    }
+    const int maxSize = maxKernelSize(type);
+    if (kernelSize < 3 || kernelSize > maxSize) {
+        emit error(tr("核大小必须在3到%1之间").arg(maxSize));
+        return false;
+    }
+    return true;
+}
+
 // 验证卷积核大小
 bool ImageProcessor::validateKernelSize(int size)
 {
-    // 卷积核大小必须是奇数且在3到31之间
-    return (size % 2 == 1) && (size >= 3) && (size <= 31);
+    // 卷积核大小必须是奇数且在3到均值滤波的最大核之间，中值和高斯滤波在应用时另行检查
+    return (size % 2 == 1) && (size >= 3) && (size <= MAX_MEAN_KERNEL_SIZE);
 }
 
 // 使用当前设置的卷积核大小应用均值滤波
@@ -4,6 +4,10 @@
 #include <QObject>
 #include <QImage>
 #include <opencv2/opencv.hpp>
+#include "ImageOperations.h"
+#include "OperationGraph.h"
+#include "ProcessingJobExecutor.h"
+#include "SummedAreaTable.h"
 
 class ImageProcessor : public QObject
 {
@@ -23,6 +27,14 @@ public:
     void setKernelSize(int size);  // 设置卷积核大小
     int getKernelSize() const;     // 获取当前卷积核大小
 
+    static const int MAX_KERNEL_SIZE = ImageOperations::MAX_GAUSSIAN_KERNEL_SIZE;        // 高斯滤波的最大核
+    static const int MAX_MEDIAN_KERNEL_SIZE = ImageOperations::MAX_MEDIAN_KERNEL_SIZE;   // 中值滤波的最大核
+    static const int MAX_MEAN_KERNEL_SIZE = ImageOperations::MAX_MEAN_KERNEL_SIZE;       // 均值滤波的最大核
+
+    // 各滤波类型的最大核；检查核大小，无效时发出error信号并返回false（高斯滤波的核大小可为0，由sigma决定）
+    static int maxKernelSize(OperationGraph::FilterType type);
+    bool validateFilterKernel(OperationGraph::FilterType type, int kernelSize);
+
     // 图像处理操作
     void flipHorizontal();
     void flipVertical();
@@ -48,6 +60,36 @@ public:
     void applyCurrentGaussianFilter(double sigma = 1.0, bool subtractFromOriginal = false);
     void applyCurrentMedianFilter(bool subtractFromOriginal = false);
 
+    // 处理范围：非空时滤波和点运算（包括管线）只计算ROI的包围盒加上核的halo，
+    // 结果按掩码合成，ROI以外保持不变；直方图均衡和拉伸仍作用于整幅图像
+    void setProcessingROI(const RoiMask &roi);
+    const RoiMask& getProcessingROI() const;
+
+    // 非破坏式处理管线：以灰度基准图为源，参数变化时只重算下游阶段
+    void setPipelineStage(OperationGraph::Stage stage, const QVariantList &parameters = QVariantList());
+    void disablePipelineStage(OperationGraph::Stage stage);
+    void resetPipeline();    // 禁用所有管线阶段
+    // 当前管线的阶段配置（处理流程文件），可由批处理工具对整个文件夹重放
+    QJsonObject exportPipeline() const;
+    void renderPipeline();   // 计算管线输出并设置为处理后的图像
+
+    // 后台处理：立即返回可取消的任务句柄，结果通过imageProcessed信号通知
+    // 同一阶段的新请求会取代尚未完成的旧请求
+    ProcessingJob renderPipelineAsync();
+    // subtractFromOriginal时输出gain * (原图 - 滤波结果) + offset
+    ProcessingJob applyFilterAsync(OperationGraph::FilterType type, int kernelSize,
+                                   double sigma = 1.0, bool subtractFromOriginal = false,
+                                   double gain = 1.0, double offset = 0.0);
+    // 代理分辨率预览：在缩小到显示尺寸的源图像上计算管线，核大小按比例缩放
+    // 结果通过previewReady信号通知，不修改处理后的图像
+    ProcessingJob renderPipelinePreviewAsync(const QSize &displaySize);
+    void cancelPendingJobs();
+    bool hasPendingJobs() const;
+
+    // 图像的灰度积分图，第一次需要时才建立，按图像版本缓存（只保留最近一幅）
+    // 之后任意矩形ROI的均值和方差都是常数时间，拖动ROI时可以实时统计
+    const SummedAreaTable& summedAreaTable(const QImage &image);
+
     // 调试函数
     void debugImageInfo() const;  // 打印当前图像信息，用于调试
 
@@ -58,13 +100,27 @@ private:
     
     // 创建灰度图像的辅助函数
     static QImage createGrayscaleImage(const cv::Mat &grayscaleMat);
+    // 图像翻转的辅助函数，可包装的格式直接在视图间翻转
+    static QImage flipImage(const QImage &image, int flipCode);
+
+    // 点运算，设置了处理范围时只作用于ROI
+    cv::Mat applyPointOpsInROI(const cv::Mat &mat, const PointOpChain &chain) const;
 
     // 验证卷积核大小
     bool validateKernelSize(int kernelSize);
 
+    // 管线源图像：已保存的灰度图像，否则为原始图像
+    void updatePipelineSource();
+    // 预览源图像：管线源图像缩小到不超过显示尺寸
+    void updatePreviewSource(const QSize &displaySize);
+    // 后台任务的控制：取消检查和分块进度都转发给任务句柄
+    TileScheduler::Control jobControl(const ProcessingJob &job) const;
+
 signals:
     void imageLoaded(bool success);
     void imageProcessed();
+    void previewReady(const QImage &preview);  // 代理分辨率预览完成
+    void processingProgress(int percent);      // 后台处理进度（0-100）
     void error(const QString &errorMessage);
     void kernelSizeChanged(int newSize);  // 卷积核大小变化的信号
 
@@ -73,6 +129,15 @@ private:
     QImage processedImage;
     QImage grayscaleImage;
     int kernelSize;  // 当前卷积核大小
+    OperationGraph pipeline;  // 非破坏式处理管线
+    QImage pipelineSource;    // 管线源图像，保证管线中的视图数据有效
+    OperationGraph previewPipeline;  // 代理分辨率预览管线，阶段配置从pipeline复制
+    double previewScale;             // 预览源图像相对管线源图像的缩放比例
+    QSize previewDisplaySize;        // 生成预览源图像时的显示尺寸
+    ProcessingJobExecutor *jobExecutor;  // 后台任务执行器
+    SummedAreaTable summedArea;          // 最近一次请求的图像的积分图
+    qint64 summedAreaKey;                // 积分图对应的图像版本(QImage::cacheKey)
+    RoiMask processingROI;               // 处理范围，为空时处理整幅图像
 };
 
 #endif // IMAGEPROCESSOR_H
@@ -0,0 +1,259 @@
+#include "ImageStatistics.h"
+#include "Metrics.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+double ImageStatistics::Channel::mean() const
+{
+    return count > 0 ? sum / count : 0.0;
+}
+
+double ImageStatistics::Channel::variance() const
+{
+    if (count <= 0) {
+        return 0.0;
+    }
+    const double m = mean();
+    return std::max(0.0, sumSquares / count - m * m);
+}
+
+double ImageStatistics::Channel::stddev() const
+{
+    return std::sqrt(variance());
+}
+
+ImageStatistics ImageStatistics::compute(const cv::Mat &src, bool rgbOrder, const TileScheduler::Control &control)
+{
+    if (src.empty()) {
+        throw std::runtime_error("Input image is empty");
+    }
+    if (!supports(src)) {
+        throw std::invalid_argument("Image statistics support 8-bit and 16-bit images only");
+    }
+    Metrics::ScopedTimer timer("stats.histogram");
+
+    const int channels = src.channels();
+    const bool withGray = channels == 3 || channels == 4;
+    const int levels = src.depth() == CV_8U ? 256 : 65536;
+    const int planes = channels + (withGray ? 1 : 0);
+
+    // 行带内用32位计数，完成后加到64位的总计数上
+    const int bandHeight = std::max(1, (MIN_BAND_PIXELS + src.cols - 1) / src.cols);
+    const int bands = (src.rows + bandHeight - 1) / bandHeight;
+    std::vector<int64_t> totals(static_cast<size_t>(planes) * levels, 0);
+    std::mutex totalsMutex;
+
+    TileScheduler::forEach(bands, [&](int index) {
+        const int y0 = index * bandHeight;
+        const int y1 = std::min(src.rows, y0 + bandHeight);
+        std::vector<uint32_t> counts(totals.size(), 0);
+        if (src.depth() == CV_8U) {
+            std::vector<uchar> row;
+            countBand<uchar>(src, y0, y1, rgbOrder, withGray, counts, row);
+        } else {
+            std::vector<ushort> row;
+            countBand<ushort>(src, y0, y1, rgbOrder, withGray, counts, row);
+        }
+
+        std::lock_guard<std::mutex> lock(totalsMutex);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            totals[i] += counts[i];
+        }
+    }, control);
+
+    ImageStatistics result;
+    result.m_levels = levels;
+    for (int c = 0; c < channels; ++c) {
+        const auto first = totals.begin() + static_cast<size_t>(c) * levels;
+        result.m_counts.emplace_back(first, first + levels);
+        result.m_channels.push_back(fromCounts(result.m_counts.back().data(), levels));
+    }
+    if (withGray) {
+        result.m_gray = fromCounts(&totals[static_cast<size_t>(channels) * levels], levels);
+    }
+    timer.stop();
+    return result;
+}
+
+bool ImageStatistics::canMap(const cv::Mat &lut) const
+{
+    const int depth = m_levels == 256 ? CV_8U : CV_16U;
+    return m_channels.size() == 1 && lut.type() == depth && static_cast<int>(lut.total()) == m_levels;
+}
+
+ImageStatistics ImageStatistics::mapped(const cv::Mat &lut) const
+{
+    if (!canMap(lut)) {
+        throw std::invalid_argument("Lookup table cannot be applied to these statistics");
+    }
+
+    // 输入值v的像素全部变为lut[v]，计数随之移动
+    const cv::Mat table = lut.isContinuous() ? lut : lut.clone();
+    const std::vector<int64_t> &counts = m_counts.front();
+    std::vector<int64_t> remapped(m_levels, 0);
+    if (m_levels == 256) {
+        const uchar *p = table.ptr<uchar>();
+        for (int v = 0; v < m_levels; ++v) {
+            remapped[p[v]] += counts[v];
+        }
+    } else {
+        const ushort *p = table.ptr<ushort>();
+        for (int v = 0; v < m_levels; ++v) {
+            remapped[p[v]] += counts[v];
+        }
+    }
+
+    ImageStatistics result;
+    result.m_levels = m_levels;
+    result.m_channels.push_back(fromCounts(remapped.data(), m_levels));
+    result.m_counts.push_back(std::move(remapped));
+    return result;
+}
+
+bool ImageStatistics::supports(const cv::Mat &src)
+{
+    return src.depth() == CV_8U || src.depth() == CV_16U;
+}
+
+bool ImageStatistics::isEmpty() const
+{
+    return m_channels.empty();
+}
+
+int ImageStatistics::channelCount() const
+{
+    return static_cast<int>(m_channels.size());
+}
+
+const ImageStatistics::Channel& ImageStatistics::channel(int index) const
+{
+    return m_channels.at(index);
+}
+
+const ImageStatistics::Channel& ImageStatistics::gray() const
+{
+    return m_channels.size() == 1 ? m_channels.front() : m_gray;
+}
+
+template <typename T>
+void ImageStatistics::countBand(const cv::Mat &src, int y0, int y1, bool rgbOrder, bool withGray,
+                                std::vector<uint32_t> &counts, std::vector<T> &grayBuffer)
+{
+    const int channels = src.channels();
+    const size_t levels = counts.size() / (channels + (withGray ? 1 : 0));
+    uint32_t *grayCounts = withGray ? &counts[channels * levels] : nullptr;
+    if (withGray) {
+        grayBuffer.resize(src.cols);
+    }
+
+    for (int y = y0; y < y1; ++y) {
+        const T *row = src.ptr<T>(y);
+        if (channels == 1) {
+            for (int x = 0; x < src.cols; ++x) {
+                ++counts[row[x]];
+            }
+        } else {
+            for (int x = 0; x < src.cols; ++x) {
+                for (int c = 0; c < channels; ++c) {
+                    ++counts[c * levels + row[x * channels + c]];
+                }
+            }
+        }
+
+        if (withGray) {
+            grayRow(row, grayBuffer.data(), src.cols, channels, rgbOrder);
+            for (int x = 0; x < src.cols; ++x) {
+                ++grayCounts[grayBuffer[x]];
+            }
+        }
+    }
+}
+
+void ImageStatistics::grayRow(const uchar *src, uchar *dst, int width, int channels, bool rgbOrder)
+{
+    const int r = rgbOrder ? 0 : 2;
+    const int b = rgbOrder ? 2 : 0;
+    int x = 0;
+#if CV_SIMD128
+    // 11R + 16G + 5B 最大为8160，16位无符号数即可容纳
+    const cv::v_uint16x8 wr = cv::v_setall_u16(11);
+    const cv::v_uint16x8 wb = cv::v_setall_u16(5);
+    for (; x <= width - cv::v_uint8x16::nlanes; x += cv::v_uint8x16::nlanes) {
+        cv::v_uint8x16 p[4];
+        if (channels == 3) {
+            cv::v_load_deinterleave(src + x * 3, p[0], p[1], p[2]);
+        } else {
+            cv::v_load_deinterleave(src + x * 4, p[0], p[1], p[2], p[3]);
+        }
+        cv::v_uint16x8 rLow, rHigh, gLow, gHigh, bLow, bHigh;
+        cv::v_expand(p[r], rLow, rHigh);
+        cv::v_expand(p[1], gLow, gHigh);
+        cv::v_expand(p[b], bLow, bHigh);
+        const cv::v_uint16x8 low = (rLow * wr + (gLow << 4) + bLow * wb) >> 5;
+        const cv::v_uint16x8 high = (rHigh * wr + (gHigh << 4) + bHigh * wb) >> 5;
+        cv::v_store(dst + x, cv::v_pack(low, high));
+    }
+#endif
+    for (; x < width; ++x) {
+        const uchar *p = src + x * channels;
+        dst[x] = static_cast<uchar>((p[r] * 11 + p[1] * 16 + p[b] * 5) >> 5);
+    }
+}
+
+void ImageStatistics::grayRow(const ushort *src, ushort *dst, int width, int channels, bool rgbOrder)
+{
+    const int r = rgbOrder ? 0 : 2;
+    const int b = rgbOrder ? 2 : 0;
+    int x = 0;
+#if CV_SIMD128
+    // 16位分量的加权和需要32位
+    const cv::v_uint32x4 wr = cv::v_setall_u32(11);
+    const cv::v_uint32x4 wb = cv::v_setall_u32(5);
+    for (; x <= width - cv::v_uint16x8::nlanes; x += cv::v_uint16x8::nlanes) {
+        cv::v_uint16x8 p[4];
+        if (channels == 3) {
+            cv::v_load_deinterleave(src + x * 3, p[0], p[1], p[2]);
+        } else {
+            cv::v_load_deinterleave(src + x * 4, p[0], p[1], p[2], p[3]);
+        }
+        cv::v_uint32x4 rLow, rHigh, gLow, gHigh, bLow, bHigh;
+        cv::v_expand(p[r], rLow, rHigh);
+        cv::v_expand(p[1], gLow, gHigh);
+        cv::v_expand(p[b], bLow, bHigh);
+        const cv::v_uint32x4 low = (rLow * wr + (gLow << 4) + bLow * wb) >> 5;
+        const cv::v_uint32x4 high = (rHigh * wr + (gHigh << 4) + bHigh * wb) >> 5;
+        cv::v_store(dst + x, cv::v_pack(low, high));
+    }
+#endif
+    for (; x < width; ++x) {
+        const ushort *p = src + x * channels;
+        dst[x] = static_cast<ushort>((p[r] * 11u + p[1] * 16u + p[b] * 5u) >> 5);
+    }
+}
+
+ImageStatistics::Channel ImageStatistics::fromCounts(const int64_t *counts, int levels)
+{
+    // 16位图像的65536级合并为256个区间
+    const int shift = levels > BINS ? 8 : 0;
+    Channel channel;
+    bool first = true;
+    for (int v = 0; v < levels; ++v) {
+        const int64_t n = counts[v];
+        if (n == 0) {
+            continue;
+        }
+        if (first) {
+            channel.min = v;
+            first = false;
+        }
+        channel.max = v;
+        channel.histogram[v >> shift] += n;
+        channel.count += n;
+        channel.sum += static_cast<double>(v) * n;
+        channel.sumSquares += static_cast<double>(v) * v * n;
+    }
+    return channel;
+}
@@ -0,0 +1,75 @@
+#ifndef IMAGESTATISTICS_H
+#define IMAGESTATISTICS_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+#include "TileScheduler.h"
+
+// 图像统计量：直方图、像素数、和、平方和、最小值、最大值，一次遍历全部得到
+// 图像按行带并行，每个行带按像素值逐级计数（8位256级，16位65536级），合并后再由计数推出和、平方和与极值，
+// 逐像素的工作只有计数；彩色图像的灰度在同一次遍历中按行用SIMD计算
+// 逐级计数随结果保存，点运算（查找表）后的统计可以直接由计数换算，不需要重新遍历图像
+class ImageStatistics
+{
+public:
+    // 直方图区间数：8位图像每个灰度一个区间，16位图像按高8位分区间
+    static const int BINS = 256;
+
+    struct Channel {
+        std::vector<int64_t> histogram = std::vector<int64_t>(BINS, 0);
+        int64_t count = 0;
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+
+        double mean() const;
+        double variance() const;
+        double stddev() const;
+    };
+
+    ImageStatistics() = default;
+
+    // 支持8U、16U，任意通道数；3、4通道图像按BGR(A)顺序解释，rgbOrder为true时按RGB(A)
+    // 彩色图像的灰度与qGray一致：(11R + 16G + 5B) / 32
+    static ImageStatistics compute(const cv::Mat &src, bool rgbOrder = false,
+                                   const TileScheduler::Control &control = TileScheduler::Control());
+
+    static bool supports(const cv::Mat &src);
+
+    // 查找表（PointOpChain::compile的结果）作用后的统计，结果与对输出图像重新统计完全一致
+    // 只适用于单通道图像：彩色图像的灰度由各通道组合而来，不能由计数换算
+    bool canMap(const cv::Mat &lut) const;
+    // 不能换算时抛出std::invalid_argument
+    ImageStatistics mapped(const cv::Mat &lut) const;
+
+    bool isEmpty() const;
+    int channelCount() const;
+    const Channel& channel(int index) const;
+    // 灰度统计：单通道图像即通道0，2通道图像为空
+    const Channel& gray() const;
+
+    // 一行3、4通道像素按qGray的权重转换为灰度（SIMD），通道顺序同compute
+    static void grayRow(const uchar *src, uchar *dst, int width, int channels, bool rgbOrder);
+    static void grayRow(const ushort *src, ushort *dst, int width, int channels, bool rgbOrder);
+
+private:
+    // 计算[y0, y1)行，逐级计数写入counts（每通道levels项，灰度在最后）
+    template <typename T>
+    static void countBand(const cv::Mat &src, int y0, int y1, bool rgbOrder, bool withGray,
+                          std::vector<uint32_t> &counts, std::vector<T> &grayBuffer);
+
+    // 由逐级计数推出直方图、和、平方和与极值
+    static Channel fromCounts(const int64_t *counts, int levels);
+
+    // 每个行带至少包含的像素数，使合并计数的开销远小于计数本身
+    static const int MIN_BAND_PIXELS = 1 << 18;
+
+    std::vector<Channel> m_channels;
+    Channel m_gray;
+    int m_levels = 0;                            // 逐级计数的级数：256或65536
+    std::vector<std::vector<int64_t>> m_counts;  // 每个通道的逐级计数
+};
+
+#endif // IMAGESTATISTICS_H
@@ -0,0 +1,87 @@
+#include "ImageStatisticsCache.h"
+#include "ImageMatAdapter.h"
+#include "Metrics.h"
+#include <QDebug>
+#include <QMutexLocker>
+
+QMutex ImageStatisticsCache::s_mutex;
+QCache<qint64, ImageStatistics> ImageStatisticsCache::s_cache(ImageStatisticsCache::MAX_ENTRIES);
+
+ImageStatistics ImageStatisticsCache::get(const QImage &image)
+{
+    if (image.isNull()) {
+        return ImageStatistics();
+    }
+
+    const qint64 key = image.cacheKey();
+    {
+        QMutexLocker locker(&s_mutex);
+        if (const ImageStatistics *cached = s_cache.object(key)) {
+            Metrics::count("stats.cacheHit");
+            return *cached;
+        }
+    }
+    Metrics::count("stats.cacheMiss");
+
+    // 计算时不持有锁，不同图像的统计可以同时进行；同一版本被重复计算时结果相同，后者覆盖前者
+    const ImageStatistics statistics = compute(image);
+    QMutexLocker locker(&s_mutex);
+    s_cache.insert(key, new ImageStatistics(statistics));
+    return statistics;
+}
+
+double ImageStatisticsCache::grayMean(const QImage &image)
+{
+    const ImageStatistics statistics = get(image);
+    if (statistics.isEmpty()) {
+        return 0.0;
+    }
+    const double scale = image.depth() == 16 ? 255.0 / 65535.0 : 1.0;
+    return statistics.gray().mean() * scale;
+}
+
+void ImageStatisticsCache::insert(const QImage &image, const ImageStatistics &statistics)
+{
+    if (image.isNull() || statistics.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&s_mutex);
+    s_cache.insert(image.cacheKey(), new ImageStatistics(statistics));
+}
+
+void ImageStatisticsCache::derive(const QImage &input, const QImage &output, const cv::Mat &lut)
+{
+    if (input.isNull() || output.isNull()) {
+        return;
+    }
+
+    ImageStatistics statistics;
+    {
+        QMutexLocker locker(&s_mutex);
+        const ImageStatistics *cached = s_cache.object(input.cacheKey());
+        if (!cached || !cached->canMap(lut)) {
+            return;
+        }
+        statistics = cached->mapped(lut);
+    }
+    insert(output, statistics);
+}
+
+void ImageStatisticsCache::clear()
+{
+    QMutexLocker locker(&s_mutex);
+    s_cache.clear();
+}
+
+ImageStatistics ImageStatisticsCache::compute(const QImage &image)
+{
+    // 能直接包装的格式零拷贝统计，通道顺序交给统计引擎处理
+    const ImageMatAdapter::ChannelOrder order = ImageMatAdapter::channelOrder(image.format());
+    if (order != ImageMatAdapter::OrderUnknown) {
+        return ImageStatistics::compute(ImageMatAdapter::constView(image),
+                                        order == ImageMatAdapter::OrderRGB);
+    }
+
+    qDebug() << "ImageStatisticsCache: converting format" << image.format() << "before computing statistics";
+    return ImageStatistics::compute(ImageMatAdapter::toMat(image));
+}
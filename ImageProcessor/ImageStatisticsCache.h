@@ -0,0 +1,40 @@
+#ifndef IMAGESTATISTICSCACHE_H
+#define IMAGESTATISTICSCACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include "ImageStatistics.h"
+
+// 按图像版本缓存的统计结果
+// 以QImage::cacheKey()为键：像素被修改后键随之改变，同一版本的图像只遍历一次，
+// 直方图对话框、状态栏、均值标签共用同一份结果；可以在任意线程中调用
+class ImageStatisticsCache
+{
+public:
+    // 返回image的统计结果，未缓存时计算一次；不支持的格式先转换为8位BGR
+    static ImageStatistics get(const QImage &image);
+
+    // 灰度均值，按0-255的范围换算（16位灰度图按比例缩小）
+    static double grayMean(const QImage &image);
+
+    // 统计结果已知的图像（如管线输出）直接登记，不再遍历
+    static void insert(const QImage &image, const ImageStatistics &statistics);
+
+    // 点运算的输出：input的统计已缓存且可以换算时，由查找表直接得到output的统计
+    // input尚未统计时什么也不做，不会为此遍历图像
+    static void derive(const QImage &input, const QImage &output, const cv::Mat &lut);
+
+    static void clear();
+
+private:
+    static ImageStatistics compute(const QImage &image);
+
+    // 只需覆盖同时显示的几个版本（处理结果、灰度版本、原图）
+    static const int MAX_ENTRIES = 8;
+
+    static QMutex s_mutex;
+    static QCache<qint64, ImageStatistics> s_cache;
+};
+
+#endif // IMAGESTATISTICSCACHE_H
@@ -0,0 +1,223 @@
+#include "Metrics.h"
+#include "TraceRecorder.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 对数分桶：第0桶为[0, 1)微秒，第b桶为[2^((b-1)/8), 2^(b/8))微秒，最后一桶约为4.8小时
+static const int SUB_BUCKETS = 8;
+static const int BUCKETS = 34 * SUB_BUCKETS + 1;
+
+struct MetricsHistogram {
+    std::vector<int64_t> buckets = std::vector<int64_t>(BUCKETS, 0);
+    int64_t count = 0;
+    double totalMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+};
+
+struct MetricsRegistry {
+    std::mutex mutex;
+    std::map<std::string, MetricsHistogram> latencies;
+    std::map<std::string, int64_t> counters;
+};
+
+static std::atomic<bool> metricsEnabled(true);
+
+static MetricsRegistry& registry()
+{
+    static MetricsRegistry instance;
+    return instance;
+}
+
+static int bucketOf(double milliseconds)
+{
+    const double microseconds = milliseconds * 1000.0;
+    if (microseconds < 1.0) {
+        return 0;
+    }
+    const int bucket = static_cast<int>(std::log2(microseconds) * SUB_BUCKETS) + 1;
+    return std::min(bucket, BUCKETS - 1);
+}
+
+// 桶的代表值（几何中点），单位为毫秒
+static double bucketValue(int bucket)
+{
+    if (bucket == 0) {
+        return 0.0005;
+    }
+    return std::exp2((bucket - 0.5) / SUB_BUCKETS) / 1000.0;
+}
+
+// 第q分位数所在的桶的代表值，限制在实测的最小值和最大值之间
+static double percentile(const MetricsHistogram &histogram, double q)
+{
+    if (histogram.count == 0) {
+        return 0.0;
+    }
+    const int64_t rank = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(q * histogram.count)));
+    int64_t cumulative = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        cumulative += histogram.buckets[b];
+        if (cumulative >= rank) {
+            return std::clamp(bucketValue(b), histogram.minMs, histogram.maxMs);
+        }
+    }
+    return histogram.maxMs;
+}
+
+double Metrics::Latency::meanMs() const
+{
+    return count > 0 ? totalMs / count : 0.0;
+}
+
+Metrics::ScopedTimer::ScopedTimer(const char *operation)
+    : m_operation(operation), m_active(isEnabled()), m_traced(TraceRecorder::begin(operation))
+{
+    if (m_active) {
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+Metrics::ScopedTimer::~ScopedTimer()
+{
+    // 未调用stop()：操作失败或被取消，只结束跟踪事件
+    if (m_traced) {
+        TraceRecorder::end(m_operation);
+    }
+}
+
+void Metrics::ScopedTimer::stop()
+{
+    if (m_traced) {
+        m_traced = false;
+        TraceRecorder::end(m_operation);
+    }
+    if (m_active) {
+        m_active = false;
+        record(m_operation, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count());
+    }
+}
+
+void Metrics::setEnabled(bool enabled)
+{
+    metricsEnabled.store(enabled);
+}
+
+bool Metrics::isEnabled()
+{
+    return metricsEnabled.load(std::memory_order_relaxed);
+}
+
+void Metrics::record(const char *operation, double milliseconds)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    const int bucket = bucketOf(milliseconds);
+
+    MetricsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    MetricsHistogram &histogram = r.latencies[operation];
+    if (histogram.count == 0 || milliseconds < histogram.minMs) {
+        histogram.minMs = milliseconds;
+    }
+    histogram.maxMs = std::max(histogram.maxMs, milliseconds);
+    histogram.totalMs += milliseconds;
+    ++histogram.count;
+    ++histogram.buckets[bucket];
+}
+
+void Metrics::count(const char *name, int64_t delta)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    MetricsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.counters[name] += delta;
+}
+
+QVector<Metrics::Latency> Metrics::latencies()
+{
+    MetricsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    QVector<Latency> result;
+    result.reserve(static_cast<int>(r.latencies.size()));
+    for (const auto &entry : r.latencies) {
+        const MetricsHistogram &histogram = entry.second;
+        Latency latency;
+        latency.operation = QString::fromStdString(entry.first);
+        latency.count = histogram.count;
+        latency.totalMs = histogram.totalMs;
+        latency.minMs = histogram.minMs;
+        latency.maxMs = histogram.maxMs;
+        latency.p50Ms = percentile(histogram, 0.50);
+        latency.p95Ms = percentile(histogram, 0.95);
+        latency.p99Ms = percentile(histogram, 0.99);
+        result.append(latency);
+    }
+    return result;
+}
+
+QVector<Metrics::Counter> Metrics::counters()
+{
+    MetricsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    QVector<Counter> result;
+    result.reserve(static_cast<int>(r.counters.size()));
+    for (const auto &entry : r.counters) {
+        Counter counter;
+        counter.name = QString::fromStdString(entry.first);
+        counter.value = entry.second;
+        result.append(counter);
+    }
+    return result;
+}
+
+void Metrics::reset()
+{
+    MetricsRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.latencies.clear();
+    r.counters.clear();
+}
+
+QJsonObject Metrics::toJson()
+{
+    QJsonArray operations;
+    for (const Latency &latency : latencies()) {
+        QJsonObject entry;
+        entry.insert("operation", latency.operation);
+        entry.insert("count", static_cast<qint64>(latency.count));
+        entry.insert("totalMs", latency.totalMs);
+        entry.insert("meanMs", latency.meanMs());
+        entry.insert("minMs", latency.minMs);
+        entry.insert("maxMs", latency.maxMs);
+        entry.insert("p50Ms", latency.p50Ms);
+        entry.insert("p95Ms", latency.p95Ms);
+        entry.insert("p99Ms", latency.p99Ms);
+        operations.append(entry);
+    }
+
+    QJsonObject counterValues;
+    for (const Counter &counter : counters()) {
+        counterValues.insert(counter.name, static_cast<qint64>(counter.value));
+    }
+
+    QJsonObject json;
+    json.insert("format", QStringLiteral("QIImageProcess.metrics"));
+    json.insert("version", 1);
+    json.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    json.insert("operations", operations);
+    json.insert("counters", counterValues);
+    return json;
+}
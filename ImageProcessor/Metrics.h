@@ -0,0 +1,74 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <chrono>
+#include <cstdint>
+
+// 轻量的性能统计：按操作名累计耗时分布和计数器，供界面的性能面板显示和导出
+// 耗时按对数分桶（每2倍区间8个桶）计数，p50/p95/p99由桶估计，相对误差不超过一个桶宽（约9%）；
+// 可在任意线程中记录，每次记录只加一次锁并更新几个整数，禁用时直接返回
+class Metrics
+{
+public:
+    // 一个操作的耗时统计，单位为毫秒
+    struct Latency {
+        QString operation;
+        int64_t count = 0;
+        double totalMs = 0.0;
+        double minMs = 0.0;
+        double maxMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+
+        double meanMs() const;
+    };
+
+    struct Counter {
+        QString name;
+        int64_t value = 0;
+    };
+
+    // 作用域计时：构造时开始，成功完成时调用stop()记录；未调用stop()就析构（出错返回、异常、取消）时
+    // 不记录，失败的操作不会混入耗时分布。跟踪启用时同时记录TraceRecorder事件，析构时总会结束
+    // operation必须是字符串字面量或比计时器存活更久的字符串
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(const char *operation);
+        ~ScopedTimer();
+
+        // 记录并结束计时，应在发出会同步触发界面更新的信号之前调用，之后析构时不再记录
+        void stop();
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer& operator=(const ScopedTimer &) = delete;
+
+    private:
+        const char *m_operation;
+        bool m_active;
+        bool m_traced;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // 默认启用
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // 操作名和计数器名按"类别.名称"命名，如"process.meanFilter"、"decode.file"
+    static void record(const char *operation, double milliseconds);
+    static void count(const char *name, int64_t delta = 1);
+
+    // 当前统计的快照，按名称排序
+    static QVector<Latency> latencies();
+    static QVector<Counter> counters();
+    static void reset();
+
+    // {format, version, timestamp, operations: [...], counters: {...}}
+    static QJsonObject toJson();
+};
+
+#endif // METRICS_H
@@ -0,0 +1,604 @@
+#include "OperationGraph.h"
+#include "ImageOperations.h"
+#include "Metrics.h"
+#include <QDebug>
+#include <QJsonArray>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+// 各阶段在性能统计中的名称，按Stage的顺序
+static const char* const STAGE_METRICS[] = {
+    "pipeline.grayscale", "pipeline.filter", "pipeline.linear", "pipeline.gamma", "pipeline.equalize"
+};
+
+// 处理流程文件中的参数检查：数量、类型和取值范围都在设置阶段之前检查，
+// 批处理时错误的处理流程在开始前就被拒绝，而不是每个文件计算时各失败一次
+static double pipelineNumber(const QJsonArray &parameters, int index, const char *stage)
+{
+    const QJsonValue value = parameters.at(index);
+    if (!value.isDouble() || !std::isfinite(value.toDouble())) {
+        throw std::invalid_argument(std::string(stage) + " stage parameter " + std::to_string(index + 1)
+                                    + " must be a number");
+    }
+    return value.toDouble();
+}
+
+static int pipelineInteger(const QJsonArray &parameters, int index, const char *stage)
+{
+    const double value = pipelineNumber(parameters, index, stage);
+    if (value != std::floor(value) || std::fabs(value) > 1e9) {
+        throw std::invalid_argument(std::string(stage) + " stage parameter " + std::to_string(index + 1)
+                                    + " must be an integer");
+    }
+    return static_cast<int>(value);
+}
+
+static void validatePipelineStage(OperationGraph::Stage stage, const QJsonArray &parameters)
+{
+    const char *name = OperationGraph::stageName(stage);
+    switch (stage) {
+        case OperationGraph::StageFilter: {
+            if (parameters.size() < 4 || parameters.size() > 6) {
+                throw std::invalid_argument("Filter stage expects 4 to 6 parameters");
+            }
+            const int type = pipelineInteger(parameters, 0, name);
+            int maxKernelSize = 0;
+            switch (type) {
+                case OperationGraph::FilterMean:
+                    maxKernelSize = ImageOperations::MAX_MEAN_KERNEL_SIZE;
+                    break;
+                case OperationGraph::FilterGaussian:
+                    maxKernelSize = ImageOperations::MAX_GAUSSIAN_KERNEL_SIZE;
+                    break;
+                case OperationGraph::FilterMedian:
+                    maxKernelSize = ImageOperations::MAX_MEDIAN_KERNEL_SIZE;
+                    break;
+                default:
+                    throw std::invalid_argument("Unknown filter type: " + std::to_string(type));
+            }
+            // 核大小为1时不滤波；高斯滤波的核大小为0时由sigma决定
+            const int kernelSize = pipelineInteger(parameters, 1, name);
+            const bool kernelFromSigma = type == OperationGraph::FilterGaussian && kernelSize == 0;
+            if (!kernelFromSigma && (kernelSize % 2 == 0 || kernelSize < 1 || kernelSize > maxKernelSize)) {
+                throw std::invalid_argument("Filter kernel size must be odd and within [1, "
+                                            + std::to_string(maxKernelSize) + "]");
+            }
+            const double sigma = pipelineNumber(parameters, 2, name);
+            if (sigma < 0.0 || (kernelFromSigma && sigma == 0.0)) {
+                throw std::invalid_argument(kernelFromSigma ? "Filter sigma must be positive when the kernel size is 0"
+                                                            : "Filter sigma must not be negative");
+            }
+            if (!parameters.at(3).isBool()) {
+                pipelineInteger(parameters, 3, name);
+            }
+            for (int i = 4; i < parameters.size(); ++i) {
+                pipelineNumber(parameters, i, name);
+            }
+            break;
+        }
+
+        case OperationGraph::StageLinear:
+            if (parameters.size() != 2) {
+                throw std::invalid_argument("Linear stage expects 2 parameters");
+            }
+            pipelineInteger(parameters, 0, name);
+            pipelineInteger(parameters, 1, name);
+            break;
+
+        case OperationGraph::StageGamma:
+            if (parameters.size() != 2) {
+                throw std::invalid_argument("Gamma stage expects 2 parameters");
+            }
+            if (pipelineNumber(parameters, 0, name) <= 0.0) {
+                throw std::invalid_argument("Gamma must be positive");
+            }
+            pipelineInteger(parameters, 1, name);
+            break;
+
+        case OperationGraph::StageGrayscale:
+        case OperationGraph::StageEqualize:
+            if (!parameters.isEmpty()) {
+                throw std::invalid_argument(std::string(name) + " stage takes no parameters");
+            }
+            break;
+
+        case OperationGraph::StageCount:
+            break;
+    }
+}
+
+OperationGraph::OperationGraph()
+    : m_nodes(StageCount)
+{
+}
+
+void OperationGraph::setSource(const cv::Mat &source)
+{
+    m_source = source;
+    m_sourceStatistics = ImageStatistics();
+    invalidateFrom(0);
+}
+
+const cv::Mat& OperationGraph::source() const
+{
+    return m_source;
+}
+
+void OperationGraph::setStage(Stage stage, const QVariantList &parameters)
+{
+    Node &node = m_nodes[stage];
+    if (node.enabled && node.parameters == parameters) {
+        return;  // 参数未变化，保留缓存
+    }
+
+    node.enabled = true;
+    node.parameters = parameters;
+    invalidateFrom(stage);
+}
+
+void OperationGraph::disableStage(Stage stage)
+{
+    Node &node = m_nodes[stage];
+    if (!node.enabled) {
+        return;
+    }
+
+    node.enabled = false;
+    node.parameters.clear();
+    invalidateFrom(stage);
+}
+
+void OperationGraph::disableAllStages()
+{
+    for (int i = 0; i < StageCount; ++i) {
+        m_nodes[i].enabled = false;
+        m_nodes[i].parameters.clear();
+    }
+    invalidateFrom(0);
+}
+
+bool OperationGraph::isStageEnabled(Stage stage) const
+{
+    return m_nodes.at(stage).enabled;
+}
+
+QVariantList OperationGraph::stageParameters(Stage stage) const
+{
+    return m_nodes.at(stage).parameters;
+}
+
+void OperationGraph::setRoi(const RoiMask &roi)
+{
+    if (roi == m_roi) {
+        return;
+    }
+
+    m_roi = roi;
+    invalidateFrom(StageFilter);  // 灰度阶段作用于整幅图像，不受ROI影响
+}
+
+const RoiMask& OperationGraph::roi() const
+{
+    return m_roi;
+}
+
+int OperationGraph::firstDirtyStage() const
+{
+    for (int i = 0; i < StageCount; ++i) {
+        if (!m_nodes.at(i).valid) {
+            return i;
+        }
+    }
+    return StageCount;
+}
+
+cv::Mat OperationGraph::evaluate(const TileScheduler::Control &control)
+{
+    if (m_source.empty()) {
+        throw std::runtime_error("Pipeline source is empty");
+    }
+
+    Metrics::ScopedTimer timer("pipeline.evaluate");
+    cv::Mat current = m_source;
+    int i = 0;
+    while (i < StageCount) {
+        if (control.cancelled && control.cancelled()) {
+            qDebug() << "OperationGraph: evaluation cancelled before stage" << stageName(static_cast<Stage>(i));
+            return cv::Mat();
+        }
+
+        if (isPointStage(static_cast<Stage>(i))) {
+            // 相邻的点运算阶段合并为一张查找表，只遍历一次图像
+            int last = i;
+            while (last + 1 < StageCount && isPointStage(static_cast<Stage>(last + 1))) {
+                ++last;
+            }
+
+            bool runValid = true;
+            for (int k = i; k <= last; ++k) {
+                runValid = runValid && m_nodes.at(k).valid;
+            }
+
+            if (!runValid) {
+                PointOpChain chain;
+                for (int k = i; k <= last; ++k) {
+                    if (m_nodes.at(k).enabled) {
+                        chain.append(pointOps(static_cast<Stage>(k), m_nodes.at(k).parameters));
+                    }
+                }
+
+                cv::Mat output = current;
+                if (!chain.isEmpty()) {
+                    Metrics::ScopedTimer stageTimer("pipeline.pointOps");
+                    qDebug() << "OperationGraph: recomputing fused point stages"
+                             << stageName(static_cast<Stage>(i)) << "to" << stageName(static_cast<Stage>(last));
+                    output = ImageOperations::applyInRoi(ImageOperations::toGrayscale(current), m_roi, 0,
+                        [&chain](const cv::Mat &tile, const cv::Rect &) {
+                            return ImageOperations::applyPointOps(tile, chain);
+                        });
+                    stageTimer.stop();
+                }
+
+                // 合并段内只在最后一个阶段保存输出，中间结果不再单独计算
+                for (int k = i; k <= last; ++k) {
+                    m_nodes[k].valid = true;
+                    m_nodes[k].output = (k == last) ? output : cv::Mat();
+                }
+            }
+
+            current = m_nodes.at(last).output;
+            i = last + 1;
+            continue;
+        }
+
+        Node &node = m_nodes[i];
+        if (!node.valid) {
+            if (node.enabled) {
+                qDebug() << "OperationGraph: recomputing stage" << stageName(static_cast<Stage>(i))
+                         << "with parameters" << node.parameters;
+                try {
+                    Metrics::ScopedTimer stageTimer(STAGE_METRICS[i]);
+                    node.output = runStage(static_cast<Stage>(i), node.parameters, current, control, m_roi);
+                    stageTimer.stop();
+                } catch (const TileScheduler::Cancelled &) {
+                    qDebug() << "OperationGraph: stage" << stageName(static_cast<Stage>(i)) << "cancelled";
+                    node.output.release();
+                    return cv::Mat();
+                }
+            } else {
+                node.output = current;  // 禁用的阶段直接透传，不复制数据
+            }
+            node.valid = true;
+        } else if (node.enabled) {
+            Metrics::count("pipeline.stageReused");
+        }
+        current = node.output;
+        ++i;
+    }
+    timer.stop();
+    return current;
+}
+
+ImageStatistics OperationGraph::statistics(const TileScheduler::Control &control)
+{
+    if (evaluate(control).empty()) {
+        return ImageStatistics();
+    }
+
+    try {
+        return statisticsAt(StageCount - 1, control);
+    } catch (const TileScheduler::Cancelled &) {
+        qDebug() << "OperationGraph: statistics cancelled";
+        return ImageStatistics();
+    }
+}
+
+const ImageStatistics& OperationGraph::statisticsAt(int stage, const TileScheduler::Control &control)
+{
+    ImageStatistics &cached = stage < 0 ? m_sourceStatistics : m_nodes[stage].statistics;
+    if (!cached.isEmpty()) {
+        return cached;
+    }
+
+    if (stage >= 0 && isPointStage(static_cast<Stage>(stage))) {
+        // 点运算段的输出保存在最后一个阶段：由段输入的统计经合并后的查找表换算
+        int first = stage;
+        while (first > 0 && isPointStage(static_cast<Stage>(first - 1))) {
+            --first;
+        }
+        PointOpChain chain;
+        for (int k = first; k <= stage; ++k) {
+            if (m_nodes.at(k).enabled) {
+                chain.append(pointOps(static_cast<Stage>(k), m_nodes.at(k).parameters));
+            }
+        }
+
+        // 只作用于ROI时输出的统计不能由整幅输入的统计换算
+        const cv::Mat &input = first > 0 ? m_nodes.at(first - 1).output : m_source;
+        if (m_roi.isEmpty() && input.channels() == 1 && ImageStatistics::supports(input)) {
+            const ImageStatistics &inputStatistics = statisticsAt(first - 1, control);
+            cached = chain.isEmpty() ? inputStatistics : inputStatistics.mapped(chain.compile(input.depth()));
+            return cached;
+        }
+    } else if (stage >= 0 && !m_nodes.at(stage).enabled) {
+        // 禁用的阶段透传输入
+        cached = statisticsAt(stage - 1, control);
+        return cached;
+    }
+
+    const cv::Mat &output = stage < 0 ? m_source : m_nodes.at(stage).output;
+    if (ImageStatistics::supports(output)) {
+        qDebug() << "OperationGraph: scanning statistics of"
+                 << (stage < 0 ? "source" : stageName(static_cast<Stage>(stage)));
+        cached = ImageStatistics::compute(output, false, control);
+    }
+    return cached;
+}
+
+void OperationGraph::adoptCache(const OperationGraph &evaluated)
+{
+    // 源图像不同则缓存全部无效
+    if (m_source.data != evaluated.m_source.data || m_source.size() != evaluated.m_source.size()) {
+        return;
+    }
+    if (m_sourceStatistics.isEmpty()) {
+        m_sourceStatistics = evaluated.m_sourceStatistics;
+    }
+
+    const bool sameRoi = m_roi == evaluated.m_roi;
+    for (int i = 0; i < StageCount; ++i) {
+        Node &node = m_nodes[i];
+        const Node &other = evaluated.m_nodes.at(i);
+        if (node.enabled != other.enabled || node.parameters != other.parameters || !other.valid
+            || (i >= StageFilter && !sameRoi)) {
+            break;  // 该阶段及其下游以本管线为准
+        }
+        if (!node.valid) {
+            node.output = other.output;
+            node.valid = true;
+        }
+        if (node.statistics.isEmpty()) {
+            node.statistics = other.statistics;
+        }
+    }
+}
+
+void OperationGraph::copyStages(const OperationGraph &other, double scale)
+{
+    for (int i = 0; i < StageCount; ++i) {
+        const Stage stage = static_cast<Stage>(i);
+        const Node &node = other.m_nodes.at(i);
+        if (node.enabled) {
+            setStage(stage, scaledParameters(stage, node.parameters, scale));
+        } else {
+            disableStage(stage);
+        }
+    }
+
+    // ROI按本管线源图像的尺寸缩放
+    setRoi(other.m_roi.isEmpty() || m_source.empty() ? RoiMask()
+                                                     : other.m_roi.resized(cv::Size(m_source.cols, m_source.rows)));
+}
+
+QJsonObject OperationGraph::stagesToJson() const
+{
+    QJsonArray stages;
+    for (int i = 0; i < StageCount; ++i) {
+        const Node &node = m_nodes.at(i);
+        if (!node.enabled) {
+            continue;
+        }
+        QJsonObject stage;
+        stage.insert("stage", QString::fromLatin1(stageName(static_cast<Stage>(i))));
+        stage.insert("parameters", QJsonArray::fromVariantList(node.parameters));
+        stages.append(stage);
+    }
+
+    QJsonObject json;
+    json.insert("format", QString::fromLatin1(PIPELINE_FORMAT));
+    json.insert("version", PIPELINE_VERSION);
+    json.insert("stages", stages);
+    return json;
+}
+
+void OperationGraph::setStagesFromJson(const QJsonObject &json)
+{
+    if (json.value("format").toString() != QLatin1String(PIPELINE_FORMAT)) {
+        throw std::invalid_argument("Not a pipeline file");
+    }
+    if (json.value("version").toInt() > PIPELINE_VERSION) {
+        throw std::invalid_argument("Pipeline file version is not supported");
+    }
+
+    // 先完整解析，格式错误时不改动当前配置
+    QVector<bool> enabled(StageCount, false);
+    QVector<QVariantList> parameters(StageCount);
+    const QJsonArray stages = json.value("stages").toArray();
+    for (const QJsonValue &value : stages) {
+        const QJsonObject stage = value.toObject();
+        const QString name = stage.value("stage").toString();
+        int index = 0;
+        while (index < StageCount && name != QLatin1String(stageName(static_cast<Stage>(index)))) {
+            ++index;
+        }
+        if (index == StageCount) {
+            throw std::invalid_argument("Unknown pipeline stage: " + name.toStdString());
+        }
+        const QJsonArray stageParameters = stage.value("parameters").toArray();
+        validatePipelineStage(static_cast<Stage>(index), stageParameters);
+        enabled[index] = true;
+        parameters[index] = stageParameters.toVariantList();
+    }
+
+    for (int i = 0; i < StageCount; ++i) {
+        if (enabled[i]) {
+            setStage(static_cast<Stage>(i), parameters[i]);
+        } else {
+            disableStage(static_cast<Stage>(i));
+        }
+    }
+}
+
+QVariantList OperationGraph::scaledParameters(Stage stage, const QVariantList &parameters, double scale)
+{
+    if (stage != StageFilter || parameters.size() < 4 || scale >= 1.0) {
+        return parameters;
+    }
+
+    QVariantList scaled = parameters;
+    const int kernelSize = parameters.at(1).toInt();
+    const double sigma = parameters.at(2).toDouble();
+    scaled[2] = sigma * scale;
+
+    // 完整的高斯核（全分辨率时核由sigma决定或覆盖完整支撑，大sigma时为递归高斯）只缩放sigma，
+    // 代理图像上的核同样由缩放后的sigma决定；只缩放核会使核退化为1，预览变成未模糊的图像
+    if (parameters.at(0).toInt() == FilterGaussian && sigma > 0.0
+        && (kernelSize == 0 || kernelSize >= ImageOperations::gaussianKernelSize(sigma))) {
+        scaled[1] = 0;
+        return scaled;
+    }
+
+    // 截断的核按核的空间范围缩放，保持为奇数；小于一个代理像素时滤波退化为恒等
+    int scaledKernel = qRound(kernelSize * scale);
+    if (scaledKernel % 2 == 0) {
+        scaledKernel += 1;
+    }
+    scaled[1] = qMax(1, scaledKernel);
+    return scaled;
+}
+
+void OperationGraph::invalidateFrom(int stage)
+{
+    for (int i = stage; i < StageCount; ++i) {
+        m_nodes[i].valid = false;
+        m_nodes[i].output.release();
+        m_nodes[i].statistics = ImageStatistics();
+    }
+}
+
+cv::Mat OperationGraph::runStage(Stage stage, const QVariantList &parameters, const cv::Mat &input,
+                                 const TileScheduler::Control &control, const RoiMask &roi)
+{
+    switch (stage) {
+        case StageGrayscale:
+            return ImageOperations::toGrayscale(input);
+
+        case StageFilter: {
+            if (parameters.size() < 4) {
+                throw std::invalid_argument("Filter stage expects 4 parameters");
+            }
+            const int type = parameters.at(0).toInt();
+            const int kernelSize = parameters.at(1).toInt();
+            const double sigma = parameters.at(2).toDouble();
+            const bool subtractFromOriginal = parameters.at(3).toBool();
+            const double gain = parameters.size() > 4 ? parameters.at(4).toDouble() : 1.0;
+            const double offset = parameters.size() > 5 ? parameters.at(5).toDouble() : 0.0;
+
+            // 管线中的高通以本阶段的输入作为“原图”
+            return filterInRoi(static_cast<FilterType>(type), kernelSize, sigma, input, roi,
+                               subtractFromOriginal ? HighPass(input, gain, offset) : HighPass(), control);
+        }
+
+        case StageLinear:
+        case StageGamma: {
+            const PointOpChain chain = pointOps(stage, parameters);
+            return ImageOperations::applyInRoi(ImageOperations::toGrayscale(input), roi, 0,
+                [&chain](const cv::Mat &tile, const cv::Rect &) {
+                    return ImageOperations::applyPointOps(tile, chain);
+                });
+        }
+
+        case StageEqualize:
+            return ImageOperations::equalizeHistogram(input);
+
+        case StageCount:
+            break;
+    }
+    throw std::invalid_argument("Unknown pipeline stage");
+}
+
+bool OperationGraph::isPointStage(Stage stage)
+{
+    return stage == StageLinear || stage == StageGamma;
+}
+
+PointOpChain OperationGraph::pointOps(Stage stage, const QVariantList &parameters)
+{
+    if (parameters.size() < 2) {
+        throw std::invalid_argument("Point stage expects 2 parameters");
+    }
+
+    if (stage == StageLinear) {
+        return ImageOperations::linearChain(parameters.at(0).toInt(), parameters.at(1).toInt());
+    }
+    if (stage == StageGamma) {
+        return ImageOperations::gammaContrastChain(parameters.at(0).toDouble(), parameters.at(1).toInt());
+    }
+    throw std::invalid_argument("Stage is not a point operation");
+}
+
+cv::Mat OperationGraph::filter(FilterType type, int kernelSize, double sigma, const cv::Mat &input,
+                               const HighPass &highPass, const TileScheduler::Control &control)
+{
+    if (kernelSize == 1) {
+        // 缩放到代理分辨率后核小于一个像素，滤波退化为恒等
+        if (!highPass.isEnabled()) {
+            return input;
+        }
+        const HighPass matched = highPass.matchedTo(input);
+        cv::Mat dst(input.size(), input.type());
+        matched.combine(matched.original(), input, dst);
+        return dst;
+    }
+
+    switch (type) {
+        case FilterMean:
+            return ImageOperations::meanFilter(input, kernelSize, control, highPass);
+        case FilterGaussian:
+            return ImageOperations::gaussianFilter(input, kernelSize, sigma, control, highPass);
+        case FilterMedian:
+            return ImageOperations::medianFilter(input, kernelSize, control, highPass);
+    }
+    throw std::invalid_argument("Unknown filter type");
+}
+
+cv::Mat OperationGraph::filterInRoi(FilterType type, int kernelSize, double sigma, const cv::Mat &input,
+                                    const RoiMask &roi, const HighPass &highPass,
+                                    const TileScheduler::Control &control)
+{
+    if (roi.isEmpty()) {
+        return filter(type, kernelSize, sigma, input, highPass, control);
+    }
+
+    // 高通的原图裁剪到与块相同的区域
+    const HighPass matched = highPass.matchedTo(input);
+    return ImageOperations::applyInRoi(input, roi, filterHalo(type, kernelSize, sigma),
+        [&](const cv::Mat &tile, const cv::Rect &rect) {
+            const HighPass tileHighPass = matched.isEnabled()
+                ? HighPass(matched.original()(rect), matched.gain(), matched.offset())
+                : HighPass();
+            return filter(type, kernelSize, sigma, tile, tileHighPass, control);
+        });
+}
+
+int OperationGraph::filterHalo(FilterType type, int kernelSize, double sigma)
+{
+    if (type == FilterGaussian) {
+        return kernelSize == 1 ? 0 : ImageOperations::gaussianHalo(kernelSize, sigma);
+    }
+    return kernelSize <= 1 ? 0 : kernelSize / 2;
+}
+
+const char* OperationGraph::stageName(Stage stage)
+{
+    switch (stage) {
+        case StageGrayscale: return "Grayscale";
+        case StageFilter:    return "Filter";
+        case StageLinear:    return "Linear";
+        case StageGamma:     return "Gamma";
+        case StageEqualize:  return "Equalize";
+        case StageCount:     break;
+    }
+    return "Unknown";
+}
@@ -0,0 +1,129 @@
+#ifndef OPERATIONGRAPH_H
+#define OPERATIONGRAPH_H
+
+#include <QJsonObject>
+#include <QVariantList>
+#include <QVector>
+#include <opencv2/core.hpp>
+#include "HighPass.h"
+#include "ImageStatistics.h"
+#include "PointOpChain.h"
+#include "RoiMask.h"
+#include "TileScheduler.h"
+
+// 非破坏式处理管线：源图像 -> 灰度 -> 滤波 -> 线性变换 -> Gamma -> 直方图均衡
+// 每个阶段缓存自己的输出，参数没有变化时直接复用，
+// 某个阶段的参数改变后只重算该阶段及其下游；
+// 相邻的点运算阶段合并执行，缓存只保存在合并段的最后一个阶段
+class OperationGraph
+{
+public:
+    enum Stage {
+        StageGrayscale = 0,  // 无参数
+        StageFilter,         // {滤波类型, 核大小, sigma, 是否从原图中减去[, 高通增益, 高通偏移]}，核大小为1时不滤波，
+                             // 高斯滤波的核大小为0时由sigma决定
+        StageLinear,         // {k滑块值, b偏移值}
+        StageGamma,          // {gamma, 对比度}
+        StageEqualize,       // 无参数
+        StageCount
+    };
+
+    enum FilterType {
+        FilterMean = 0,
+        FilterGaussian,
+        FilterMedian
+    };
+
+    OperationGraph();
+
+    // 设置源图像，所有阶段的缓存失效
+    void setSource(const cv::Mat &source);
+    const cv::Mat& source() const;
+
+    // 启用阶段并设置参数，参数与当前相同时缓存保持有效
+    void setStage(Stage stage, const QVariantList &parameters = QVariantList());
+    void disableStage(Stage stage);
+    void disableAllStages();
+    bool isStageEnabled(Stage stage) const;
+    QVariantList stageParameters(Stage stage) const;
+
+    // 处理范围：非空时滤波和点运算阶段只计算ROI（包围盒加上核的halo），ROI以外保持阶段输入不变
+    // 灰度和直方图均衡作用于整幅图像；ROI改变时灰度之后的阶段缓存失效
+    void setRoi(const RoiMask &roi);
+    const RoiMask& roi() const;
+
+    // 计算管线输出，只重算缓存失效的阶段
+    // control.cancelled在阶段之间和滤波的块之间检查，返回true时停止计算并返回空矩阵
+    cv::Mat evaluate(const TileScheduler::Control &control = TileScheduler::Control());
+
+    // 管线输出的统计结果（必要时先计算管线），与输出一同缓存
+    // 点运算段的输出统计由其输入的统计经查找表换算，只有滤波等空间运算之后才需要重新遍历图像；
+    // 取消时返回空结果
+    ImageStatistics statistics(const TileScheduler::Control &control = TileScheduler::Control());
+
+    // 采用另一份管线（通常是后台线程中计算过的副本）的缓存：
+    // 源图像相同时，从第一个阶段开始逐个比较，配置一致且已计算的阶段直接使用其输出
+    void adoptCache(const OperationGraph &evaluated);
+
+    // 第一个缓存失效的阶段，全部有效时返回StageCount
+    int firstDirtyStage() const;
+
+    // 复制另一份管线的阶段配置，参数按scale缩放；源图像和配置未变化阶段的缓存保持不变
+    // 用于在缩小的代理图像上以相同的语义预览处理结果
+    void copyStages(const OperationGraph &other, double scale = 1.0);
+
+    // 阶段配置的JSON表示（处理流程文件）：只记录启用的阶段及其参数，不包括源图像和处理范围
+    // 界面中记录的处理流程可以保存下来，由批处理工具对整个文件夹重放
+    QJsonObject stagesToJson() const;
+    // 按JSON设置阶段配置，未列出的阶段禁用；格式、参数数量、类型或取值范围不正确时
+    // 抛出std::invalid_argument，配置保持不变
+    void setStagesFromJson(const QJsonObject &json);
+
+    // 按图像缩放比例换算阶段参数：滤波核大小和sigma随尺寸缩放，完整的高斯核只缩放sigma（核由sigma决定），
+    // 点运算参数不变
+    static QVariantList scaledParameters(Stage stage, const QVariantList &parameters, double scale);
+
+    // 运行单个阶段，roi非空时滤波和点运算只作用于ROI
+    static cv::Mat runStage(Stage stage, const QVariantList &parameters, const cv::Mat &input,
+                            const TileScheduler::Control &control = TileScheduler::Control(),
+                            const RoiMask &roi = RoiMask());
+    static const char* stageName(Stage stage);
+
+    // 按类型滤波；highPass启用时在同一遍中输出高通结果，核大小为1时滤波退化为恒等
+    static cv::Mat filter(FilterType type, int kernelSize, double sigma, const cv::Mat &input,
+                          const HighPass &highPass = HighPass(),
+                          const TileScheduler::Control &control = TileScheduler::Control());
+    // 只在roi的包围盒加上halo的块内滤波，结果按掩码合成，ROI以外保持input不变；roi为空时即filter
+    static cv::Mat filterInRoi(FilterType type, int kernelSize, double sigma, const cv::Mat &input,
+                               const RoiMask &roi, const HighPass &highPass = HighPass(),
+                               const TileScheduler::Control &control = TileScheduler::Control());
+    // 滤波结果依赖的邻域半径
+    static int filterHalo(FilterType type, int kernelSize, double sigma);
+
+    // 线性变换和Gamma属于点运算，相邻的点运算阶段合并为一张查找表执行
+    static bool isPointStage(Stage stage);
+    static PointOpChain pointOps(Stage stage, const QVariantList &parameters);
+
+private:
+    static constexpr const char *PIPELINE_FORMAT = "QIImageProcess.pipeline";
+    static const int PIPELINE_VERSION = 1;
+
+    struct Node {
+        bool enabled = false;
+        bool valid = false;
+        QVariantList parameters;
+        cv::Mat output;  // 缓存的输出，禁用的阶段直接共享输入
+        ImageStatistics statistics;  // 输出的统计结果，第一次需要时才计算
+    };
+
+    void invalidateFrom(int stage);
+    // 阶段输出（stage为-1时为源图像）的统计结果，阶段必须已计算
+    const ImageStatistics& statisticsAt(int stage, const TileScheduler::Control &control);
+
+    cv::Mat m_source;
+    ImageStatistics m_sourceStatistics;
+    RoiMask m_roi;
+    QVector<Node> m_nodes;
+};
+
+#endif // OPERATIONGRAPH_H
@@ -0,0 +1,182 @@
+#include "PointOpChain.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+PointOpChain& PointOpChain::linear(double k, double b)
+{
+    m_ops.push_back({OpLinear, k, b});
+    return *this;
+}
+
+PointOpChain& PointOpChain::gamma(double gamma)
+{
+    if (gamma <= 0.0) {
+        throw std::invalid_argument("Gamma must be positive");
+    }
+    m_ops.push_back({OpGamma, gamma, 0.0});
+    return *this;
+}
+
+PointOpChain& PointOpChain::contrast(double factor, double center)
+{
+    m_ops.push_back({OpContrast, factor, center});
+    return *this;
+}
+
+PointOpChain& PointOpChain::invert()
+{
+    m_ops.push_back({OpInvert, 0.0, 0.0});
+    return *this;
+}
+
+PointOpChain& PointOpChain::clip(double low, double high)
+{
+    if (low > high) {
+        std::swap(low, high);
+    }
+    m_ops.push_back({OpClip, low, high});
+    return *this;
+}
+
+PointOpChain& PointOpChain::append(const PointOpChain &other)
+{
+    m_ops.insert(m_ops.end(), other.m_ops.begin(), other.m_ops.end());
+    return *this;
+}
+
+bool PointOpChain::isEmpty() const
+{
+    return m_ops.empty();
+}
+
+void PointOpChain::clear()
+{
+    m_ops.clear();
+}
+
+double PointOpChain::evaluate(double value) const
+{
+    return evaluateScaled(value, 255.0);
+}
+
+double PointOpChain::evaluateScaled(double value, double maxValue) const
+{
+    // 参数以8位为单位，16位时按比例放大
+    const double scale = maxValue / 255.0;
+    double v = std::min(maxValue, std::max(0.0, value));
+
+    for (const Op &op : m_ops) {
+        switch (op.type) {
+            case OpLinear:
+                v = op.a * v + op.b * scale;
+                break;
+            case OpGamma:
+                v = std::pow(v / maxValue, 1.0 / op.a) * maxValue;
+                break;
+            case OpContrast:
+                v = (v - op.b * scale) * op.a + op.b * scale;
+                break;
+            case OpInvert:
+                v = maxValue - v;
+                break;
+            case OpClip:
+                v = std::min(op.b * scale, std::max(op.a * scale, v));
+                break;
+        }
+        // 每一步都截断到有效范围，后续的Gamma等运算不会遇到负值
+        v = std::min(maxValue, std::max(0.0, v));
+    }
+    return v;
+}
+
+cv::Mat PointOpChain::compile(int depth) const
+{
+    if (depth == CV_8U) {
+        cv::Mat lut(1, 256, CV_8U);
+        uchar *p = lut.ptr<uchar>();
+        for (int i = 0; i < 256; ++i) {
+            p[i] = cv::saturate_cast<uchar>(evaluateScaled(i, 255.0));
+        }
+        return lut;
+    }
+
+    if (depth == CV_16U) {
+        cv::Mat lut(1, 65536, CV_16U);
+        ushort *p = lut.ptr<ushort>();
+        for (int i = 0; i < 65536; ++i) {
+            p[i] = cv::saturate_cast<ushort>(evaluateScaled(i, 65535.0));
+        }
+        return lut;
+    }
+
+    throw std::invalid_argument("Point operations support only 8-bit and 16-bit images");
+}
+
+cv::Mat PointOpChain::compilePerChannel(const std::vector<PointOpChain> &chains)
+{
+    const int channels = static_cast<int>(chains.size());
+    if (channels < 1 || channels > 4) {
+        throw std::invalid_argument("Per-channel lookup tables support 1 to 4 channels");
+    }
+
+    cv::Mat lut(1, 256, CV_8UC(channels));
+    uchar *p = lut.ptr<uchar>();
+    for (int i = 0; i < 256; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            p[i * channels + c] = cv::saturate_cast<uchar>(chains[c].evaluateScaled(i, 255.0));
+        }
+    }
+    return lut;
+}
+
+cv::Mat PointOpChain::apply(const cv::Mat &src) const
+{
+    return applyLut(src, compile(src.depth()));
+}
+
+cv::Mat PointOpChain::applyLut(const cv::Mat &src, const cv::Mat &lut)
+{
+    if (src.empty()) {
+        throw std::invalid_argument("Input image is empty");
+    }
+
+    cv::Mat dst;
+    if (src.depth() == CV_8U) {
+        // cv::LUT对8位数据有向量化和并行实现
+        cv::LUT(src, lut, dst);
+        return dst;
+    }
+
+    if (src.depth() != CV_16U || lut.type() != CV_16U || lut.total() != 65536) {
+        throw std::invalid_argument("Lookup table does not match image depth");
+    }
+
+    dst.create(src.size(), src.type());
+    const ushort *table = lut.ptr<ushort>();
+    const int width = src.cols * src.channels();
+
+    // 16位查表：按行分块并行，每个像素只读写一次
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range &range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const ushort *s = src.ptr<ushort>(y);
+            ushort *d = dst.ptr<ushort>(y);
+            int x = 0;
+            for (; x <= width - 4; x += 4) {
+                const ushort t0 = table[s[x]];
+                const ushort t1 = table[s[x + 1]];
+                const ushort t2 = table[s[x + 2]];
+                const ushort t3 = table[s[x + 3]];
+                d[x] = t0;
+                d[x + 1] = t1;
+                d[x + 2] = t2;
+                d[x + 3] = t3;
+            }
+            for (; x < width; ++x) {
+                d[x] = table[s[x]];
+            }
+        }
+    });
+    return dst;
+}
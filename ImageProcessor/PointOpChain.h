@@ -0,0 +1,59 @@
+#ifndef POINTOPCHAIN_H
+#define POINTOPCHAIN_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+// 点运算链：把连续的逐像素变换（y = kx + b、Gamma、对比度、反相、截断）
+// 编译成一张查找表，只需一次遍历图像即可完成任意数量的色调调整
+// 所有参数都以8位灰度为单位给出，编译16位查找表时按比例换算
+class PointOpChain
+{
+public:
+    PointOpChain& linear(double k, double b);            // y = kx + b
+    PointOpChain& gamma(double gamma);                   // y = 255 * (x / 255)^(1 / gamma)
+    PointOpChain& contrast(double factor, double center = 128.0);  // y = (x - center) * factor + center
+    PointOpChain& invert();                              // y = 255 - x
+    PointOpChain& clip(double low, double high);         // y = clamp(x, low, high)
+    PointOpChain& append(const PointOpChain &other);
+
+    bool isEmpty() const;
+    void clear();
+
+    // 单个输入值经过整条链后的结果（0-255的尺度，未取整）
+    double evaluate(double value) const;
+
+    // 编译为查找表：CV_8U得到1x256的CV_8U表，CV_16U得到1x65536的CV_16U表
+    cv::Mat compile(int depth) const;
+
+    // 每个通道各自的点运算链编译为一张多通道查找表（仅8位）
+    static cv::Mat compilePerChannel(const std::vector<PointOpChain> &chains);
+
+    // 整条链应用到图像，所有通道共用同一查找表
+    cv::Mat apply(const cv::Mat &src) const;
+
+    // 用已编译的查找表做一次遍历：8位走cv::LUT，16位按行并行查表
+    static cv::Mat applyLut(const cv::Mat &src, const cv::Mat &lut);
+
+private:
+    enum OpType {
+        OpLinear,
+        OpGamma,
+        OpContrast,
+        OpInvert,
+        OpClip
+    };
+
+    struct Op {
+        OpType type;
+        double a;
+        double b;
+    };
+
+    // 在[0, maxValue]区间上计算，每一步的结果都截断到有效范围，与逐步保存图像的语义一致
+    double evaluateScaled(double value, double maxValue) const;
+
+    std::vector<Op> m_ops;
+};
+
+#endif // POINTOPCHAIN_H
@@ -0,0 +1,198 @@
+#include "ProcessingJobExecutor.h"
+#include "TraceRecorder.h"
+#include <QRunnable>
+#include <QMetaObject>
+#include <QThread>
+#include <QDebug>
+#include <exception>
+
+ProcessingJob::ProcessingJob(const QSharedPointer<State> &state)
+    : d(state)
+{
+}
+
+bool ProcessingJob::isValid() const
+{
+    return !d.isNull();
+}
+
+quint64 ProcessingJob::id() const
+{
+    return d ? d->id : 0;
+}
+
+QString ProcessingJob::key() const
+{
+    return d ? d->key : QString();
+}
+
+void ProcessingJob::cancel()
+{
+    if (d) {
+        d->cancelled.storeRelease(1);
+    }
+}
+
+bool ProcessingJob::isCancelled() const
+{
+    return d && d->cancelled.loadAcquire() != 0;
+}
+
+bool ProcessingJob::isFinished() const
+{
+    return d && d->finished.loadAcquire() != 0;
+}
+
+int ProcessingJob::progress() const
+{
+    return d ? d->progress.loadAcquire() : 0;
+}
+
+// 线程池中运行的任务，结果通过排队调用送回执行器所在线程
+class ProcessingJobExecutor::Runnable : public QRunnable
+{
+public:
+    Runnable(ProcessingJobExecutor *executor, const ProcessingJob &job, Task task, Completion completion)
+        : m_executor(executor), m_job(job), m_task(std::move(task)), m_completion(std::move(completion))
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        TraceRecorder::setThreadName("Processing worker");
+        cv::Mat result;
+        QString errorMessage;
+
+        // 排队期间已被取代的任务不再执行
+        if (!m_job.isCancelled()) {
+            emit m_executor->jobStarted(m_job.id(), m_job.key());
+            try {
+                result = m_task(m_job);
+            } catch (const cv::Exception& e) {
+                errorMessage = QString::fromStdString(e.what());
+            } catch (const std::exception& e) {
+                errorMessage = QString::fromStdString(e.what());
+            } catch (...) {
+                errorMessage = QStringLiteral("Unknown error");
+            }
+        }
+        m_job.d->finished.storeRelease(1);
+
+        // 执行器被销毁时排队的调用会被丢弃
+        ProcessingJobExecutor *executor = m_executor;
+        ProcessingJob job = m_job;
+        Completion completion = m_completion;
+        QMetaObject::invokeMethod(executor, [executor, job, completion, result, errorMessage]() {
+            executor->handleFinished(job, completion, result, errorMessage);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    ProcessingJobExecutor *m_executor;
+    ProcessingJob m_job;
+    Task m_task;
+    Completion m_completion;
+};
+
+ProcessingJobExecutor::ProcessingJobExecutor(QObject *parent)
+    : QObject(parent), m_nextId(1)
+{
+    // 保留一个核心给界面线程
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+ProcessingJobExecutor::~ProcessingJobExecutor()
+{
+    cancelAll();
+    m_pool.waitForDone();
+}
+
+ProcessingJob ProcessingJobExecutor::submit(const QString &key, Task task, Completion completion)
+{
+    // 同一key的旧任务被新任务取代
+    cancel(key);
+
+    QSharedPointer<ProcessingJob::State> state(new ProcessingJob::State);
+    state->id = m_nextId++;
+    state->key = key;
+    ProcessingJob job(state);
+    m_current.insert(key, job);
+
+    qDebug() << "ProcessingJobExecutor: submit job" << job.id() << "key=" << key;
+    m_pool.start(new Runnable(this, job, std::move(task), std::move(completion)));
+    return job;
+}
+
+void ProcessingJobExecutor::cancel(const QString &key)
+{
+    auto it = m_current.find(key);
+    if (it != m_current.end()) {
+        it.value().cancel();
+        m_current.erase(it);
+    }
+}
+
+void ProcessingJobExecutor::cancelAll()
+{
+    for (auto it = m_current.begin(); it != m_current.end(); ++it) {
+        it.value().cancel();
+    }
+    m_current.clear();
+}
+
+void ProcessingJobExecutor::reportProgress(const ProcessingJob &job, int done, int total)
+{
+    if (!job.isValid() || total <= 0 || job.isCancelled()) {
+        return;
+    }
+
+    const int percent = qBound(0, done * 100 / total, 100);
+    // 百分比不变时不发信号，避免每个块都排队一次跨线程调用
+    if (job.d->progress.fetchAndStoreOrdered(percent) != percent) {
+        emit jobProgress(job.id(), job.key(), percent);
+    }
+}
+
+bool ProcessingJobExecutor::isBusy() const
+{
+    return !m_current.isEmpty();
+}
+
+bool ProcessingJobExecutor::waitForDone(int msecs)
+{
+    return m_pool.waitForDone(msecs);
+}
+
+QThreadPool* ProcessingJobExecutor::threadPool()
+{
+    return &m_pool;
+}
+
+bool ProcessingJobExecutor::isCurrent(const ProcessingJob &job) const
+{
+    auto it = m_current.constFind(job.key());
+    return it != m_current.constEnd() && it.value().id() == job.id() && !job.isCancelled();
+}
+
+void ProcessingJobExecutor::handleFinished(const ProcessingJob &job, const Completion &completion,
+                                           const cv::Mat &result, const QString &errorMessage)
+{
+    if (!isCurrent(job)) {
+        qDebug() << "ProcessingJobExecutor: drop stale job" << job.id() << "key=" << job.key();
+        emit jobCancelled(job.id(), job.key());
+        return;
+    }
+    m_current.remove(job.key());
+
+    if (!errorMessage.isEmpty()) {
+        qDebug() << "ProcessingJobExecutor: job" << job.id() << "failed:" << errorMessage;
+        emit jobFailed(job.id(), job.key(), errorMessage);
+        return;
+    }
+
+    if (completion) {
+        completion(result);
+    }
+    emit jobFinished(job.id(), job.key());
+}
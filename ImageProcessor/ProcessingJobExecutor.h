@@ -0,0 +1,89 @@
+#ifndef PROCESSINGJOBEXECUTOR_H
+#define PROCESSINGJOBEXECUTOR_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QHash>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <functional>
+#include <opencv2/core.hpp>
+
+// 后台任务句柄：可在任意线程查询状态或请求取消
+// 取消是协作式的，耗时任务应在各步骤之间检查isCancelled()
+class ProcessingJob
+{
+public:
+    ProcessingJob() = default;
+
+    bool isValid() const;
+    quint64 id() const;
+    QString key() const;
+
+    void cancel();
+    bool isCancelled() const;
+    bool isFinished() const;
+    int progress() const;  // 0-100，未报告过进度时为0
+
+private:
+    friend class ProcessingJobExecutor;
+
+    struct State {
+        quint64 id = 0;
+        QString key;
+        QAtomicInt cancelled;
+        QAtomicInt finished;
+        QAtomicInt progress;
+    };
+
+    explicit ProcessingJob(const QSharedPointer<State> &state);
+
+    QSharedPointer<State> d;
+};
+
+// 后台任务执行器：任务在线程池中运行，结果回到执行器所在线程（GUI线程）
+// 同一个key只保留最新的请求，新请求提交时旧请求被取消，旧结果即使算完也会被丢弃
+class ProcessingJobExecutor : public QObject
+{
+    Q_OBJECT
+public:
+    // 工作函数在线程池中运行，不能访问界面对象
+    using Task = std::function<cv::Mat(const ProcessingJob &job)>;
+    // 完成回调在执行器所在线程中运行，只有未被取代的任务才会调用
+    using Completion = std::function<void(const cv::Mat &result)>;
+
+    explicit ProcessingJobExecutor(QObject *parent = nullptr);
+    ~ProcessingJobExecutor() override;
+
+    ProcessingJob submit(const QString &key, Task task, Completion completion);
+
+    void cancel(const QString &key);
+    void cancelAll();
+    // 报告任务进度，可在工作线程中调用；百分比变化时发出jobProgress
+    void reportProgress(const ProcessingJob &job, int done, int total);
+    bool isBusy() const;
+    bool waitForDone(int msecs = -1);
+
+    QThreadPool* threadPool();
+
+signals:
+    void jobStarted(quint64 id, const QString &key);
+    void jobProgress(quint64 id, const QString &key, int percent);
+    void jobFinished(quint64 id, const QString &key);
+    void jobFailed(quint64 id, const QString &key, const QString &message);
+    void jobCancelled(quint64 id, const QString &key);
+
+private:
+    class Runnable;
+
+    // 以下函数都在执行器所在线程中调用
+    void handleFinished(const ProcessingJob &job, const Completion &completion,
+                        const cv::Mat &result, const QString &errorMessage);
+    bool isCurrent(const ProcessingJob &job) const;
+
+    QThreadPool m_pool;
+    QHash<QString, ProcessingJob> m_current;  // 每个key最新的任务
+    quint64 m_nextId;
+};
+
+#endif // PROCESSINGJOBEXECUTOR_H
@@ -0,0 +1,163 @@
+#include "RecursiveGaussian.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+cv::Mat RecursiveGaussian::apply(const cv::Mat &src, double sigma, const TileScheduler::Control &control,
+                                 const HighPass &highPass)
+{
+    if (src.empty()) {
+        throw std::runtime_error("Input image is empty");
+    }
+    if (sigma < MIN_SIGMA) {
+        throw std::invalid_argument("Recursive Gaussian requires sigma >= 0.5");
+    }
+
+    const Coefficients k = coefficients(sigma);
+
+    // 中间结果用浮点保存，最后舍入并饱和到输入类型
+    cv::Mat image;
+    src.convertTo(image, CV_MAKETYPE(CV_32F, src.channels()));
+
+    // 进度按两个方向的列条总数计算，转置后的浮点列数为rows * channels
+    const int columnStrips = stripCount(image);
+    const int total = columnStrips + (image.rows * image.channels() + STRIP_WIDTH - 1) / STRIP_WIDTH;
+
+    // 列方向
+    filterColumns(image, k, 0, total, control);
+    // 行方向：转置后同样按列处理
+    cv::Mat transposed;
+    cv::transpose(image, transposed);
+    filterColumns(transposed, k, columnStrips, total, control);
+    cv::transpose(transposed, image);
+
+    cv::Mat dst;
+    const HighPass matched = highPass.matchedTo(src);
+    if (matched.isEnabled()) {
+        dst.create(src.size(), src.type());
+        matched.combine(matched.original(), image, dst);
+    } else {
+        image.convertTo(dst, src.type());
+    }
+    return dst;
+}
+
+RecursiveGaussian::Coefficients RecursiveGaussian::coefficients(double sigma)
+{
+    auto fromQ = [](double q) {
+        const double q2 = q * q;
+        const double q3 = q2 * q;
+        const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+        const double b1 = 2.44413 * q + 2.85619 * q2 + 1.26661 * q3;
+        const double b2 = -(1.4281 * q2 + 1.26661 * q3);
+        const double b3 = 0.422205 * q3;
+        return std::vector<double>{b1 / b0, b2 / b0, b3 / b0};
+    };
+    // 前向加后向的冲激响应方差：2 * (Σi²aᵢ / B + (Σiaᵢ)² / B²)，B = 1 - Σaᵢ
+    auto variance = [](const std::vector<double> &a) {
+        const double b = 1.0 - (a[0] + a[1] + a[2]);
+        const double m1 = a[0] + 2.0 * a[1] + 3.0 * a[2];
+        const double m2 = a[0] + 4.0 * a[1] + 9.0 * a[2];
+        return 2.0 * (m2 / b + m1 * m1 / (b * b));
+    };
+
+    // 论文中q的经验公式得到的实际sigma偏大5%到10%，以它为初值二分求解，使方差严格等于sigma²
+    double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330
+                            : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+    double low = 0.0;
+    double high = std::max(q, 0.5);
+    while (variance(fromQ(high)) < sigma * sigma) {
+        high *= 2.0;
+    }
+    for (int i = 0; i < 50; ++i) {
+        q = 0.5 * (low + high);
+        if (variance(fromQ(q)) < sigma * sigma) {
+            low = q;
+        } else {
+            high = q;
+        }
+    }
+
+    const std::vector<double> a = fromQ(q);
+    Coefficients k;
+    k.a1 = static_cast<float>(a[0]);
+    k.a2 = static_cast<float>(a[1]);
+    k.a3 = static_cast<float>(a[2]);
+    // 保证系数之和为1，常数区域滤波后不变
+    k.b = 1.0f - (k.a1 + k.a2 + k.a3);
+    return k;
+}
+
+int RecursiveGaussian::stripCount(const cv::Mat &image)
+{
+    const int width = image.cols * image.channels();
+    return (width + STRIP_WIDTH - 1) / STRIP_WIDTH;
+}
+
+void RecursiveGaussian::filterColumns(cv::Mat &image, const Coefficients &k, int progressOffset,
+                                      int progressTotal, const TileScheduler::Control &control)
+{
+    const int width = image.cols * image.channels();
+
+    // 两个方向的进度合并为一个总进度
+    TileScheduler::Control stripControl;
+    stripControl.cancelled = control.cancelled;
+    if (control.progress) {
+        stripControl.progress = [&control, progressOffset, progressTotal](int done, int) {
+            control.progress(progressOffset + done, progressTotal);
+        };
+    }
+
+    TileScheduler::forEach(stripCount(image), [&](int index) {
+        filterStrip(image, index * STRIP_WIDTH, std::min(width, (index + 1) * STRIP_WIDTH), k);
+    }, stripControl);
+}
+
+void RecursiveGaussian::filterStrip(cv::Mat &image, int first, int last, const Coefficients &k)
+{
+    const int n = last - first;
+    const int rows = image.rows;
+    auto row = [&](int y) { return image.ptr<float>(y) + first; };
+
+    // 前向：首行之前按稳态处理，即等于首行的值
+    std::vector<float> edge(row(0), row(0) + n);
+    for (int y = 0; y < rows; ++y) {
+        recurseRow(row(y),
+                   y >= 1 ? row(y - 1) : edge.data(),
+                   y >= 2 ? row(y - 2) : edge.data(),
+                   y >= 3 ? row(y - 3) : edge.data(), n, k);
+    }
+
+    // 后向：末行之后等于前向结果的末行
+    edge.assign(row(rows - 1), row(rows - 1) + n);
+    for (int y = rows - 1; y >= 0; --y) {
+        recurseRow(row(y),
+                   y + 1 < rows ? row(y + 1) : edge.data(),
+                   y + 2 < rows ? row(y + 2) : edge.data(),
+                   y + 3 < rows ? row(y + 3) : edge.data(), n, k);
+    }
+}
+
+void RecursiveGaussian::recurseRow(float *x, const float *p1, const float *p2, const float *p3, int n,
+                                   const Coefficients &k)
+{
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 b = cv::v_setall_f32(k.b);
+    const cv::v_float32x4 a1 = cv::v_setall_f32(k.a1);
+    const cv::v_float32x4 a2 = cv::v_setall_f32(k.a2);
+    const cv::v_float32x4 a3 = cv::v_setall_f32(k.a3);
+    for (; i <= n - cv::v_float32x4::nlanes; i += cv::v_float32x4::nlanes) {
+        cv::v_float32x4 sum = cv::v_load(x + i) * b;
+        sum = cv::v_muladd(cv::v_load(p1 + i), a1, sum);
+        sum = cv::v_muladd(cv::v_load(p2 + i), a2, sum);
+        sum = cv::v_muladd(cv::v_load(p3 + i), a3, sum);
+        cv::v_store(x + i, sum);
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] = k.b * x[i] + k.a1 * p1[i] + k.a2 * p2[i] + k.a3 * p3[i];
+    }
+}
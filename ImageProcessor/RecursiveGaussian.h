@@ -0,0 +1,49 @@
+#ifndef RECURSIVEGAUSSIAN_H
+#define RECURSIVEGAUSSIAN_H
+
+#include <opencv2/core.hpp>
+#include "HighPass.h"
+#include "TileScheduler.h"
+
+// 递归（IIR）高斯滤波（Young & van Vliet, 1995）
+// 每个方向一次前向、一次后向的三阶递归，每像素的运算量与sigma无关，适合大sigma的背景估计
+// 先沿列方向滤波（各列独立，整行向量化），转置后再滤一次，最后转置回来
+// 边界按复制边缘像素处理；sigma较小时精度不如FIR核，因此只在sigma不小于SIGMA_THRESHOLD时使用
+class RecursiveGaussian
+{
+public:
+    // 输入任意深度、任意通道数，输出与输入类型相同；control可用于取消（抛出TileScheduler::Cancelled）
+    // highPass启用时由浮点中间结果直接合成高通，代替最后的类型转换
+    static cv::Mat apply(const cv::Mat &src, double sigma,
+                         const TileScheduler::Control &control = TileScheduler::Control(),
+                         const HighPass &highPass = HighPass());
+
+    // sigma不小于该值、且核覆盖完整的高斯支撑时，高斯滤波自动使用递归实现（见ImageOperations::usesRecursiveGaussian）
+    static constexpr double SIGMA_THRESHOLD = 5.0;
+    // Young-van Vliet系数公式的适用下限
+    static constexpr double MIN_SIGMA = 0.5;
+
+private:
+    // 递归系数：y[n] = b * x[n] + a1 * y[n-1] + a2 * y[n-2] + a3 * y[n-3]
+    struct Coefficients {
+        float b;
+        float a1;
+        float a2;
+        float a3;
+    };
+
+    static Coefficients coefficients(double sigma);
+    // 对32位浮点矩阵的每一列原地滤波，按列条并行；progressOffset/progressTotal用于进度通知
+    static void filterColumns(cv::Mat &image, const Coefficients &k, int progressOffset, int progressTotal,
+                              const TileScheduler::Control &control);
+    static int stripCount(const cv::Mat &image);
+    // 对[first, last)范围内的浮点列做前向和后向递归
+    static void filterStrip(cv::Mat &image, int first, int last, const Coefficients &k);
+    // 一行的递归：x[i] = b * x[i] + a1 * p1[i] + a2 * p2[i] + a3 * p3[i]
+    static void recurseRow(float *x, const float *p1, const float *p2, const float *p3, int n,
+                           const Coefficients &k);
+
+    static const int STRIP_WIDTH = 64;  // 每个并行任务处理的浮点列数
+};
+
+#endif // RECURSIVEGAUSSIAN_H
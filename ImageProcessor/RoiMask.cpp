@@ -0,0 +1,313 @@
+#include "RoiMask.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+RoiMask::RoiMask(const cv::Size &size, RoiRasterizer::Spans spans)
+    : m_size(size)
+{
+    const auto byPosition = [](const RoiRasterizer::Span &a, const RoiRasterizer::Span &b) {
+        return a.y < b.y || (a.y == b.y && a.x0 < b.x0);
+    };
+    if (!std::is_sorted(spans.begin(), spans.end(), byPosition)) {
+        std::sort(spans.begin(), spans.end(), byPosition);
+    }
+
+    // 裁剪到图像内，同一行重叠或相接的段合并为一段
+    m_spans.reserve(spans.size());
+    for (RoiRasterizer::Span s : spans) {
+        if (s.y < 0 || s.y >= m_size.height) {
+            continue;
+        }
+        s.x0 = std::max(0, s.x0);
+        s.x1 = std::min(m_size.width, s.x1);
+        if (s.x0 >= s.x1) {
+            continue;
+        }
+        if (!m_spans.empty() && m_spans.back().y == s.y && s.x0 <= m_spans.back().x1) {
+            m_spans.back().x1 = std::max(m_spans.back().x1, s.x1);
+        } else {
+            m_spans.push_back(s);
+        }
+    }
+}
+
+RoiMask RoiMask::rect(const cv::Rect &rect, const cv::Size &size)
+{
+    const cv::Rect r = rect & cv::Rect(0, 0, size.width, size.height);
+    RoiRasterizer::Spans spans;
+    spans.reserve(r.height);
+    for (int y = r.y; y < r.y + r.height; ++y) {
+        spans.push_back({y, r.x, r.x + r.width});
+    }
+    return RoiMask(size, std::move(spans));
+}
+
+RoiMask RoiMask::circle(const cv::Point &center, int radius, const cv::Size &size)
+{
+    return RoiMask(size, RoiRasterizer::circle(center, radius, size));
+}
+
+RoiMask RoiMask::ring(const cv::Point &firstCenter, int firstRadius,
+                      const cv::Point &secondCenter, int secondRadius, const cv::Size &size)
+{
+    return RoiMask(size, RoiRasterizer::ring(firstCenter, firstRadius, secondCenter, secondRadius, size));
+}
+
+RoiMask RoiMask::polygon(const std::vector<cv::Point> &points, const cv::Size &size)
+{
+    return RoiMask(size, RoiRasterizer::polygon(points, size));
+}
+
+RoiMask RoiMask::united(const RoiMask &other) const
+{
+    return combined(other, Union);
+}
+
+RoiMask RoiMask::intersected(const RoiMask &other) const
+{
+    return combined(other, Intersection);
+}
+
+RoiMask RoiMask::subtracted(const RoiMask &other) const
+{
+    return combined(other, Difference);
+}
+
+bool RoiMask::operator==(const RoiMask &other) const
+{
+    if (m_size != other.m_size || m_spans.size() != other.m_spans.size()) {
+        return false;
+    }
+    return std::equal(m_spans.begin(), m_spans.end(), other.m_spans.begin(),
+                      [](const RoiRasterizer::Span &a, const RoiRasterizer::Span &b) {
+                          return a.y == b.y && a.x0 == b.x0 && a.x1 == b.x1;
+                      });
+}
+
+bool RoiMask::operator!=(const RoiMask &other) const
+{
+    return !(*this == other);
+}
+
+bool RoiMask::isEmpty() const
+{
+    return m_spans.empty();
+}
+
+cv::Size RoiMask::size() const
+{
+    return m_size;
+}
+
+int64_t RoiMask::area() const
+{
+    return RoiRasterizer::area(m_spans);
+}
+
+cv::Rect RoiMask::boundingRect() const
+{
+    if (m_spans.empty()) {
+        return cv::Rect();
+    }
+    int left = m_spans.front().x0;
+    int right = m_spans.front().x1;
+    for (const RoiRasterizer::Span &s : m_spans) {
+        left = std::min(left, s.x0);
+        right = std::max(right, s.x1);
+    }
+    const int top = m_spans.front().y;
+    const int bottom = m_spans.back().y + 1;
+    return cv::Rect(left, top, right - left, bottom - top);
+}
+
+bool RoiMask::contains(int x, int y) const
+{
+    size_t first = 0, last = 0;
+    rowRange(y, first, last);
+    // 同一行的段有序且互不相交，第一个右端在x右侧的段即唯一可能包含x的段
+    const auto it = std::upper_bound(m_spans.begin() + first, m_spans.begin() + last, x,
+                                     [](int value, const RoiRasterizer::Span &s) { return value < s.x1; });
+    return it != m_spans.begin() + last && it->x0 <= x;
+}
+
+const RoiRasterizer::Spans& RoiMask::spans() const
+{
+    return m_spans;
+}
+
+RoiMask RoiMask::resized(const cv::Size &size) const
+{
+    RoiMask result;
+    result.m_size = size;
+    if (m_spans.empty() || size.width <= 0 || size.height <= 0) {
+        return result;
+    }
+
+    // 目标像素dx的中心对应源像素floor((2dx + 1) * w / 2W)，落在[x0, x1)内的dx满足
+    // ceil((2 * x0 * W - w) / 2w) <= dx < ceil((2 * x1 * W - w) / 2w)
+    const int64_t w = m_size.width;
+    const int64_t h = m_size.height;
+    const auto scaleX = [w, &size](int x) {
+        const int64_t numerator = 2 * static_cast<int64_t>(x) * size.width - w;
+        const int64_t quotient = numerator / (2 * w);
+        return static_cast<int>(quotient + (numerator % (2 * w) > 0 ? 1 : 0));
+    };
+
+    RoiRasterizer::Spans spans;
+    for (int y = 0; y < size.height; ++y) {
+        const int sourceY = static_cast<int>((2 * static_cast<int64_t>(y) + 1) * h / (2 * static_cast<int64_t>(size.height)));
+        size_t first = 0, last = 0;
+        rowRange(sourceY, first, last);
+        for (size_t i = first; i < last; ++i) {
+            spans.push_back({y, scaleX(m_spans[i].x0), scaleX(m_spans[i].x1)});
+        }
+    }
+    return RoiMask(size, std::move(spans));
+}
+
+cv::Mat RoiMask::toMat(const cv::Rect &region) const
+{
+    cv::Mat mask = cv::Mat::zeros(region.size(), CV_8UC1);
+    for (int r = 0; r < region.height; ++r) {
+        size_t first = 0, last = 0;
+        rowRange(region.y + r, first, last);
+        uchar *row = mask.ptr<uchar>(r);
+        for (size_t i = first; i < last; ++i) {
+            const int x0 = std::max(m_spans[i].x0 - region.x, 0);
+            const int x1 = std::min(m_spans[i].x1 - region.x, region.width);
+            if (x0 < x1) {
+                std::memset(row + x0, 255, x1 - x0);
+            }
+        }
+    }
+    return mask;
+}
+
+void RoiMask::clearOutside(cv::Mat &image, const cv::Point &origin) const
+{
+    const size_t pixelBytes = image.elemSize();
+    for (int r = 0; r < image.rows; ++r) {
+        size_t first = 0, last = 0;
+        rowRange(origin.y + r, first, last);
+        uchar *row = image.ptr<uchar>(r);
+
+        // 逐段清除段与段之间的间隙
+        int position = 0;
+        for (size_t i = first; i < last; ++i) {
+            const int x0 = std::min(std::max(m_spans[i].x0 - origin.x, 0), image.cols);
+            const int x1 = std::min(std::max(m_spans[i].x1 - origin.x, 0), image.cols);
+            if (x0 > position) {
+                std::memset(row + position * pixelBytes, 0, (x0 - position) * pixelBytes);
+            }
+            position = std::max(position, x1);
+        }
+        if (position < image.cols) {
+            std::memset(row + position * pixelBytes, 0, (image.cols - position) * pixelBytes);
+        }
+    }
+}
+
+void RoiMask::copyInside(const cv::Mat &src, cv::Mat &dst, const cv::Point &origin) const
+{
+    CV_Assert(src.size() == dst.size() && src.type() == dst.type());
+
+    const size_t pixelBytes = src.elemSize();
+    for (int r = 0; r < src.rows; ++r) {
+        size_t first = 0, last = 0;
+        rowRange(origin.y + r, first, last);
+        const uchar *srcRow = src.ptr<uchar>(r);
+        uchar *dstRow = dst.ptr<uchar>(r);
+        for (size_t i = first; i < last; ++i) {
+            const int x0 = std::max(m_spans[i].x0 - origin.x, 0);
+            const int x1 = std::min(m_spans[i].x1 - origin.x, src.cols);
+            if (x0 < x1) {
+                std::memcpy(dstRow + x0 * pixelBytes, srcRow + x0 * pixelBytes, (x1 - x0) * pixelBytes);
+            }
+        }
+    }
+}
+
+RoiMask RoiMask::combined(const RoiMask &other, Operation operation) const
+{
+    RoiRasterizer::Spans spans;
+    size_t i = 0, j = 0;
+    while (i < m_spans.size() || j < other.m_spans.size()) {
+        // 取两组段中下一个有段的行
+        int y = INT_MAX;
+        if (i < m_spans.size()) {
+            y = std::min(y, m_spans[i].y);
+        }
+        if (j < other.m_spans.size()) {
+            y = std::min(y, other.m_spans[j].y);
+        }
+        size_t iEnd = i, jEnd = j;
+        while (iEnd < m_spans.size() && m_spans[iEnd].y == y) {
+            ++iEnd;
+        }
+        while (jEnd < other.m_spans.size() && other.m_spans[jEnd].y == y) {
+            ++jEnd;
+        }
+
+        // 按x从左到右扫过两组段的端点，每个端点切换所在掩码的内外状态
+        const size_t aBounds = 2 * (iEnd - i);
+        const size_t bBounds = 2 * (jEnd - j);
+        const auto boundA = [&](size_t k) { return k % 2 == 0 ? m_spans[i + k / 2].x0 : m_spans[i + k / 2].x1; };
+        const auto boundB = [&](size_t k) { return k % 2 == 0 ? other.m_spans[j + k / 2].x0 : other.m_spans[j + k / 2].x1; };
+        size_t ka = 0, kb = 0;
+        bool inA = false, inB = false, inside = false;
+        int start = 0;
+        while (ka < aBounds || kb < bBounds) {
+            int x = INT_MAX;
+            if (ka < aBounds) {
+                x = std::min(x, boundA(ka));
+            }
+            if (kb < bBounds) {
+                x = std::min(x, boundB(kb));
+            }
+            if (ka < aBounds && boundA(ka) == x) {
+                inA = !inA;
+                ++ka;
+            }
+            if (kb < bBounds && boundB(kb) == x) {
+                inB = !inB;
+                ++kb;
+            }
+
+            bool now = false;
+            switch (operation) {
+            case Union:
+                now = inA || inB;
+                break;
+            case Intersection:
+                now = inA && inB;
+                break;
+            case Difference:
+                now = inA && !inB;
+                break;
+            }
+            if (now && !inside) {
+                start = x;
+            } else if (!now && inside) {
+                spans.push_back({y, start, x});
+            }
+            inside = now;
+        }
+
+        i = iEnd;
+        j = jEnd;
+    }
+    return RoiMask(m_size, std::move(spans));
+}
+
+void RoiMask::rowRange(int y, size_t &first, size_t &last) const
+{
+    const auto begin = std::lower_bound(m_spans.begin(), m_spans.end(), y,
+                                        [](const RoiRasterizer::Span &s, int value) { return s.y < value; });
+    auto end = begin;
+    while (end != m_spans.end() && end->y == y) {
+        ++end;
+    }
+    first = static_cast<size_t>(begin - m_spans.begin());
+    last = static_cast<size_t>(end - m_spans.begin());
+}
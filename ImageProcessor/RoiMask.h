@@ -0,0 +1,63 @@
+#ifndef ROIMASK_H
+#define ROIMASK_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include "RoiRasterizer.h"
+
+// ROI掩码：按行的游程编码（每行若干互不相交的[x0, x1)段），内存与ROI的高度成正比，不需要整幅图像大小的掩码图
+// 几何变化时构建一次，绘制、统计、掩码处理和导出共用同一份掩码，各处对ROI的解释保持一致
+class RoiMask
+{
+public:
+    RoiMask() = default;
+    // spans可以无序、重叠，构造时裁剪到size并整理为有序、互不相交的段
+    RoiMask(const cv::Size &size, RoiRasterizer::Spans spans);
+
+    static RoiMask rect(const cv::Rect &rect, const cv::Size &size);
+    static RoiMask circle(const cv::Point &center, int radius, const cv::Size &size);
+    static RoiMask ring(const cv::Point &firstCenter, int firstRadius,
+                        const cv::Point &secondCenter, int secondRadius, const cv::Size &size);
+    static RoiMask polygon(const std::vector<cv::Point> &points, const cv::Size &size);
+
+    // 集合运算：逐行合并两组有序的段，开销与段数成正比；结果的尺寸取当前掩码的尺寸
+    RoiMask united(const RoiMask &other) const;
+    RoiMask intersected(const RoiMask &other) const;
+    RoiMask subtracted(const RoiMask &other) const;
+
+    bool operator==(const RoiMask &other) const;
+    bool operator!=(const RoiMask &other) const;
+
+    bool isEmpty() const;
+    cv::Size size() const;
+    int64_t area() const;
+    cv::Rect boundingRect() const;
+    bool contains(int x, int y) const;
+    const RoiRasterizer::Spans& spans() const;
+
+    // 最近邻缩放到另一尺寸（如显示尺寸），按像素中心取样
+    RoiMask resized(const cv::Size &size) const;
+
+    // 区域对应的CV_8UC1掩码（ROI内为255），region超出掩码的部分为0
+    cv::Mat toMat(const cv::Rect &region) const;
+    // image覆盖掩码坐标中从origin开始的区域，把ROI以外的像素清零（4通道图像即变为透明）
+    void clearOutside(cv::Mat &image, const cv::Point &origin) const;
+    // src与dst尺寸类型相同且覆盖从origin开始的区域，把ROI以内的像素从src复制到dst
+    void copyInside(const cv::Mat &src, cv::Mat &dst, const cv::Point &origin) const;
+
+private:
+    enum Operation {
+        Union,
+        Intersection,
+        Difference
+    };
+
+    RoiMask combined(const RoiMask &other, Operation operation) const;
+    // 第y行的段在m_spans中的范围[first, last)
+    void rowRange(int y, size_t &first, size_t &last) const;
+
+    cv::Size m_size;
+    RoiRasterizer::Spans m_spans;
+};
+
+#endif // ROIMASK_H
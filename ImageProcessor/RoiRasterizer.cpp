@@ -0,0 +1,159 @@
+#include "RoiRasterizer.h"
+#include <algorithm>
+#include <cmath>
+
+RoiRasterizer::Spans RoiRasterizer::circle(const cv::Point &center, int radius, const cv::Size &bounds)
+{
+    Spans spans;
+    if (radius <= 0) {
+        return spans;
+    }
+
+    const int y0 = std::max(0, center.y - radius);
+    const int y1 = std::min(bounds.height - 1, center.y + radius);
+    for (int y = y0; y <= y1; ++y) {
+        const int halfWidth = circleHalfWidth(y - center.y, radius);
+        appendSpan(spans, y, center.x - halfWidth, center.x + halfWidth + 1, bounds.width);
+    }
+    return spans;
+}
+
+RoiRasterizer::Spans RoiRasterizer::ring(const cv::Point &firstCenter, int firstRadius,
+                                         const cv::Point &secondCenter, int secondRadius, const cv::Size &bounds)
+{
+    Spans spans;
+    if (firstRadius <= 0 || secondRadius <= 0) {
+        return spans;
+    }
+
+    const int y0 = std::max(0, std::min(firstCenter.y - firstRadius, secondCenter.y - secondRadius));
+    const int y1 = std::min(bounds.height - 1, std::max(firstCenter.y + firstRadius, secondCenter.y + secondRadius));
+    for (int y = y0; y <= y1; ++y) {
+        // 每行两个圆各覆盖一个区间（可能为空），环为两个区间的对称差，最多两段
+        const int h1 = circleHalfWidth(y - firstCenter.y, firstRadius);
+        const int h2 = circleHalfWidth(y - secondCenter.y, secondRadius);
+        int a1 = firstCenter.x - h1, b1 = firstCenter.x + h1 + 1;
+        int a2 = secondCenter.x - h2, b2 = secondCenter.x + h2 + 1;
+
+        if (h1 < 0 || h2 < 0) {
+            if (h1 >= 0) {
+                appendSpan(spans, y, a1, b1, bounds.width);
+            } else if (h2 >= 0) {
+                appendSpan(spans, y, a2, b2, bounds.width);
+            }
+            continue;
+        }
+
+        if (a2 < a1) {
+            std::swap(a1, a2);
+            std::swap(b1, b2);
+        }
+        if (b1 <= a2) {
+            // 不相交：两个区间都属于环
+            appendSpan(spans, y, a1, b1, bounds.width);
+            appendSpan(spans, y, a2, b2, bounds.width);
+        } else {
+            // 相交：去掉重叠部分后剩下左右两段
+            appendSpan(spans, y, a1, a2, bounds.width);
+            appendSpan(spans, y, std::min(b1, b2), std::max(b1, b2), bounds.width);
+        }
+    }
+    return spans;
+}
+
+RoiRasterizer::Spans RoiRasterizer::polygon(const std::vector<cv::Point> &points, const cv::Size &bounds)
+{
+    Spans spans;
+    if (points.size() < 3) {
+        return spans;
+    }
+
+    // 边按上端点排序，扫描时只维护与当前行相交的活动边
+    struct Edge {
+        int top;        // 覆盖的行为[top, bottom)
+        int bottom;
+        int x;          // top行处的x
+        int dx;         // 下移dy行x的增量
+        int dy;
+    };
+    std::vector<Edge> edges;
+    int minY = points.front().y;
+    int maxY = points.front().y;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const cv::Point &p = points[i];
+        const cv::Point &q = points[(i + 1) % points.size()];
+        minY = std::min(minY, p.y);
+        maxY = std::max(maxY, p.y);
+        if (p.y == q.y) {
+            continue;  // 水平边不与扫描线相交
+        }
+        const cv::Point &upper = p.y < q.y ? p : q;
+        const cv::Point &lower = p.y < q.y ? q : p;
+        edges.push_back({upper.y, lower.y, upper.x, lower.x - upper.x, lower.y - upper.y});
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) { return a.top < b.top; });
+
+    const int y0 = std::max(0, minY);
+    const int y1 = std::min(bounds.height, maxY);
+    std::vector<const Edge*> active;
+    std::vector<int> crossings;
+    size_t next = 0;
+    for (int y = y0; y < y1; ++y) {
+        while (next < edges.size() && edges[next].top <= y) {
+            active.push_back(&edges[next++]);
+        }
+        active.erase(std::remove_if(active.begin(), active.end(),
+                                    [y](const Edge *e) { return e->bottom <= y; }),
+                     active.end());
+
+        // 交点x0处右侧第一个像素为ceil(x0)，用整数运算求出，避免浮点误差使恰好落在像素上的交点偏移
+        crossings.clear();
+        for (const Edge *e : active) {
+            const int64_t numerator = static_cast<int64_t>(e->x) * e->dy + static_cast<int64_t>(y - e->top) * e->dx;
+            const int64_t quotient = numerator / e->dy;
+            crossings.push_back(static_cast<int>(quotient + (numerator % e->dy > 0 ? 1 : 0)));
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        // 奇偶规则：相邻两个交点之间的像素交替位于内外，ceil(x0) <= x < ceil(x1)的像素在区间内
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            appendSpan(spans, y, crossings[i], crossings[i + 1], bounds.width);
+        }
+    }
+    return spans;
+}
+
+int64_t RoiRasterizer::area(const Spans &spans)
+{
+    int64_t total = 0;
+    for (const Span &span : spans) {
+        total += span.length();
+    }
+    return total;
+}
+
+int RoiRasterizer::circleHalfWidth(int dy, int radius)
+{
+    const int64_t limit = static_cast<int64_t>(radius) * radius - static_cast<int64_t>(dy) * dy;
+    if (limit < 0) {
+        return -1;
+    }
+    // 浮点开方后修正到整数精确结果：满足dx * dx <= limit的最大dx
+    int64_t dx = static_cast<int64_t>(std::sqrt(static_cast<double>(limit)));
+    while (dx * dx > limit) {
+        --dx;
+    }
+    while ((dx + 1) * (dx + 1) <= limit) {
+        ++dx;
+    }
+    return static_cast<int>(dx);
+}
+
+void RoiRasterizer::appendSpan(Spans &spans, int y, int x0, int x1, int width)
+{
+    x0 = std::max(0, x0);
+    x1 = std::min(width, x1);
+    if (x0 < x1) {
+        spans.push_back({y, x0, x1});
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef ROIRASTERIZER_H
+#define ROIRASTERIZER_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+// ROI光栅化：把圆、环、多边形转换为逐行的像素段
+// 每行只需求出边界与扫描线的交点，不对每个像素做包含判断；
+// 区域统计按段累加（配合积分图每段为常数时间），开销与ROI的周长成正比而不是与面积成正比
+class RoiRasterizer
+{
+public:
+    // 第y行[x0, x1)的像素
+    struct Span {
+        int y;
+        int x0;
+        int x1;
+
+        int length() const { return x1 - x0; }
+    };
+    // 按行从上到下排列，同一行的段从左到右且互不重叠
+    using Spans = std::vector<Span>;
+
+    // 圆：dx * dx + dy * dy <= radius * radius 的像素
+    static Spans circle(const cv::Point &center, int radius, const cv::Size &bounds);
+
+    // 环：只属于两个圆之一的像素（两个圆的对称差），两个圆的位置关系任意
+    static Spans ring(const cv::Point &firstCenter, int firstRadius,
+                      const cv::Point &secondCenter, int secondRadius, const cv::Size &bounds);
+
+    // 多边形：奇偶规则（与QPainterPath::addPolygon的默认填充规则一致），在像素坐标处取样
+    static Spans polygon(const std::vector<cv::Point> &points, const cv::Size &bounds);
+
+    // 段覆盖的像素总数
+    static int64_t area(const Spans &spans);
+
+private:
+    // 圆在第y行覆盖的半宽，该行与圆不相交时返回-1
+    static int circleHalfWidth(int dy, int radius);
+    // 把[x0, x1)裁剪到[0, width)后追加，为空时不追加
+    static void appendSpan(Spans &spans, int y, int x0, int x1, int width);
+};
+
+#endif // ROIRASTERIZER_H
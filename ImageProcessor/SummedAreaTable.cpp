@@ -0,0 +1,200 @@
+#include "SummedAreaTable.h"
+#include "ImageStatistics.h"
+#include "Metrics.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+double SummedAreaTable::Moments::mean() const
+{
+    return count > 0 ? static_cast<double>(sum) / count : 0.0;
+}
+
+double SummedAreaTable::Moments::variance() const
+{
+    if (count <= 0) {
+        return 0.0;
+    }
+    const double m = mean();
+    return std::max(0.0, static_cast<double>(sumSquares) / count - m * m);
+}
+
+SummedAreaTable::Moments& SummedAreaTable::Moments::operator+=(const Moments &other)
+{
+    count += other.count;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+    return *this;
+}
+
+SummedAreaTable::SummedAreaTable(const cv::Mat &src, bool rgbOrder, const TileScheduler::Control &control)
+{
+    if (src.empty()) {
+        throw std::runtime_error("Input image is empty");
+    }
+    if (!supports(src)) {
+        throw std::invalid_argument("Summed-area table supports 8-bit and 16-bit images with 1, 3 or 4 channels");
+    }
+    Metrics::ScopedTimer timer("stats.summedAreaTable");
+
+    m_rows = src.rows;
+    m_cols = src.cols;
+    const size_t cells = static_cast<size_t>(m_rows + 1) * (m_cols + 1);
+    m_sum.assign(cells, 0);
+    m_sumSquares.assign(cells, 0);
+
+    // 第一步：各行带从0开始独立累加
+    const int bands = (m_rows + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    TileScheduler::forEach(bands, [&](int band) {
+        const int y0 = band * BAND_HEIGHT;
+        const int y1 = std::min(m_rows, y0 + BAND_HEIGHT);
+        if (src.depth() == CV_8U) {
+            buildBand<uchar>(src, rgbOrder, y0, y1);
+        } else {
+            buildBand<ushort>(src, rgbOrder, y0, y1);
+        }
+    }, control);
+
+    if (bands <= 1) {
+        timer.stop();
+        return;
+    }
+
+    // 第二步：每个行带的累计值为上方所有行带最后一行之和，依次求出后各行带并行加上
+    const int width = m_cols + 1;
+    std::vector<int64_t> sumCarry(static_cast<size_t>(bands) * width, 0);
+    std::vector<uint64_t> squaresCarry(static_cast<size_t>(bands) * width, 0);
+    for (int band = 1; band < bands; ++band) {
+        const size_t offset = static_cast<size_t>(band) * width;
+        const size_t lastRow = index(band * BAND_HEIGHT, 0);
+        std::copy_n(&sumCarry[offset - width], width, &sumCarry[offset]);
+        std::copy_n(&squaresCarry[offset - width], width, &squaresCarry[offset]);
+        addRow(&sumCarry[offset], &m_sum[lastRow], width);
+        addRow(&squaresCarry[offset], &m_sumSquares[lastRow], width);
+    }
+
+    TileScheduler::forEach(bands - 1, [&](int task) {
+        const int band = task + 1;
+        const size_t offset = static_cast<size_t>(band) * width;
+        const int y1 = std::min(m_rows, (band + 1) * BAND_HEIGHT);
+        for (int y = band * BAND_HEIGHT; y < y1; ++y) {
+            addRow(&m_sum[index(y + 1, 0)], &sumCarry[offset], width);
+            addRow(&m_sumSquares[index(y + 1, 0)], &squaresCarry[offset], width);
+        }
+    }, control);
+    timer.stop();
+}
+
+bool SummedAreaTable::supports(const cv::Mat &src)
+{
+    const int channels = src.channels();
+    return (src.depth() == CV_8U || src.depth() == CV_16U)
+        && (channels == 1 || channels == 3 || channels == 4);
+}
+
+bool SummedAreaTable::isEmpty() const
+{
+    return m_sum.empty();
+}
+
+cv::Size SummedAreaTable::size() const
+{
+    return cv::Size(m_cols, m_rows);
+}
+
+SummedAreaTable::Moments SummedAreaTable::rect(const cv::Rect &rect) const
+{
+    const cv::Rect r = rect & cv::Rect(0, 0, m_cols, m_rows);
+    Moments moments;
+    if (r.empty()) {
+        return moments;
+    }
+
+    const size_t a = index(r.y, r.x);
+    const size_t b = index(r.y, r.x + r.width);
+    const size_t c = index(r.y + r.height, r.x);
+    const size_t d = index(r.y + r.height, r.x + r.width);
+    moments.count = static_cast<int64_t>(r.width) * r.height;
+    moments.sum = m_sum[d] - m_sum[b] - m_sum[c] + m_sum[a];
+    // 无符号数按模运算，中间结果回绕不影响最终结果
+    moments.sumSquares = m_sumSquares[d] - m_sumSquares[b] - m_sumSquares[c] + m_sumSquares[a];
+    return moments;
+}
+
+SummedAreaTable::Moments SummedAreaTable::span(int y, int x0, int x1) const
+{
+    return rect(cv::Rect(x0, y, x1 - x0, 1));
+}
+
+SummedAreaTable::Moments SummedAreaTable::spans(const RoiRasterizer::Spans &spans) const
+{
+    Moments moments;
+    for (const RoiRasterizer::Span &s : spans) {
+        moments += span(s.y, s.x0, s.x1);
+    }
+    return moments;
+}
+
+template <typename T>
+void SummedAreaTable::buildBand(const cv::Mat &src, bool rgbOrder, int y0, int y1)
+{
+    const int channels = src.channels();
+    std::vector<T> gray(channels == 1 ? 0 : m_cols);
+
+    for (int y = y0; y < y1; ++y) {
+        const T *row = src.ptr<T>(y);
+        if (channels != 1) {
+            ImageStatistics::grayRow(row, gray.data(), m_cols, channels, rgbOrder);
+            row = gray.data();
+        }
+
+        int64_t *sum = &m_sum[index(y + 1, 1)];
+        uint64_t *squares = &m_sumSquares[index(y + 1, 1)];
+        int64_t rowSum = 0;
+        uint64_t rowSquares = 0;
+        for (int x = 0; x < m_cols; ++x) {
+            const uint64_t v = row[x];
+            rowSum += static_cast<int64_t>(v);
+            rowSquares += v * v;
+            sum[x] = rowSum;
+            squares[x] = rowSquares;
+        }
+
+        // 行带的第一行之上视为0，由第二步补上
+        if (y > y0) {
+            addRow(sum, &m_sum[index(y, 1)], m_cols);
+            addRow(squares, &m_sumSquares[index(y, 1)], m_cols);
+        }
+    }
+}
+
+void SummedAreaTable::addRow(int64_t *dst, const int64_t *src, int n)
+{
+    int i = 0;
+#if CV_SIMD128
+    for (; i <= n - cv::v_int64x2::nlanes; i += cv::v_int64x2::nlanes) {
+        cv::v_store(dst + i, cv::v_load(dst + i) + cv::v_load(src + i));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] += src[i];
+    }
+}
+
+void SummedAreaTable::addRow(uint64_t *dst, const uint64_t *src, int n)
+{
+    int i = 0;
+#if CV_SIMD128
+    for (; i <= n - cv::v_uint64x2::nlanes; i += cv::v_uint64x2::nlanes) {
+        cv::v_store(dst + i, cv::v_load(dst + i) + cv::v_load(src + i));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] += src[i];
+    }
+}
+
+size_t SummedAreaTable::index(int y, int x) const
+{
+    return static_cast<size_t>(y) * (m_cols + 1) + x;
+}
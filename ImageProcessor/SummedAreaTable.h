@@ -0,0 +1,64 @@
+#ifndef SUMMEDAREATABLE_H
+#define SUMMEDAREATABLE_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+#include "RoiRasterizer.h"
+#include "TileScheduler.h"
+
+// 灰度积分图：每个位置保存其左上方所有像素的和与平方和（64位整数）
+// 建表一次遍历图像，之后任意矩形的和、均值、方差都只需读取四个角，与矩形大小无关
+// 建表按行带并行：各行带先独立累加，再把上方行带的累计值加到本行带上
+class SummedAreaTable
+{
+public:
+    // 区域的像素数、和与平方和
+    struct Moments {
+        int64_t count = 0;
+        int64_t sum = 0;
+        uint64_t sumSquares = 0;
+
+        double mean() const;
+        double variance() const;
+        Moments& operator+=(const Moments &other);
+    };
+
+    SummedAreaTable() = default;
+
+    // 支持8U、16U；3、4通道图像按qGray的权重取灰度，通道顺序为BGR(A)，rgbOrder为true时为RGB(A)
+    explicit SummedAreaTable(const cv::Mat &src, bool rgbOrder = false,
+                             const TileScheduler::Control &control = TileScheduler::Control());
+
+    static bool supports(const cv::Mat &src);
+
+    bool isEmpty() const;
+    cv::Size size() const;
+
+    // 矩形区域的统计，超出图像的部分被裁掉，O(1)
+    Moments rect(const cv::Rect &rect) const;
+    // 第y行[x0, x1)的统计，超出图像的部分被裁掉，O(1)；逐行累加即可得到任意形状区域的统计
+    Moments span(int y, int x0, int x1) const;
+    // 光栅化后的ROI的统计：每段常数时间，总开销与段数（ROI的高度）成正比
+    Moments spans(const RoiRasterizer::Spans &spans) const;
+
+private:
+    template <typename T>
+    void buildBand(const cv::Mat &src, bool rgbOrder, int y0, int y1);
+
+    // 两张表的一行加上累计值（SIMD）
+    static void addRow(int64_t *dst, const int64_t *src, int n);
+    static void addRow(uint64_t *dst, const uint64_t *src, int n);
+
+    // (rows + 1) x (cols + 1)，第0行和第0列为0
+    size_t index(int y, int x) const;
+
+    static const int BAND_HEIGHT = 256;
+
+    int m_rows = 0;
+    int m_cols = 0;
+    std::vector<int64_t> m_sum;
+    std::vector<uint64_t> m_sumSquares;
+};
+
+#endif // SUMMEDAREATABLE_H
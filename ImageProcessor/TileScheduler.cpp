@@ -0,0 +1,116 @@
+#include "TileScheduler.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+
+void TileScheduler::run(const cv::Mat &src, cv::Mat &dst, int dstType, int halo,
+                        const TileFunction &function, const Control &control)
+{
+    if (src.empty()) {
+        throw std::runtime_error("Input image is empty");
+    }
+    if (dst.datastart == src.datastart) {
+        // 目标不能与输入共享内存，否则后面的块会读到已写入的结果
+        dst.release();
+    }
+    dst.create(src.size(), dstType);
+
+    halo = std::max(0, halo);
+    const std::vector<cv::Rect> rects = tiles(src.size(), tileSizeFor(src, halo));
+    const cv::Rect bounds(0, 0, src.cols, src.rows);
+
+    forEach(static_cast<int>(rects.size()), [&](int index) {
+        const cv::Rect &tile = rects[index];
+        // 向外扩展halo个像素，在图像边缘处截断
+        const cv::Rect haloRect = cv::Rect(tile.x - halo, tile.y - halo,
+                                           tile.width + 2 * halo, tile.height + 2 * halo) & bounds;
+        const cv::Rect inner(tile.x - haloRect.x, tile.y - haloRect.y, tile.width, tile.height);
+
+        cv::Mat output = dst(tile);
+        function(src(haloRect), inner, output);
+    }, control);
+}
+
+void TileScheduler::forEach(int count, const std::function<void(int index)> &task, const Control &control)
+{
+    std::atomic<int> done(0);
+    std::atomic<bool> stopped(false);
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+
+    // 跟踪中调用线程上显示整个并行区，各工作线程上显示分到的块
+    TraceRecorder::Scope region("opencv.parallelFor");
+    cv::parallel_for_(cv::Range(0, count), [&](const cv::Range &range) {
+        TraceRecorder::Scope chunk("opencv.parallelChunk");
+        for (int i = range.start; i < range.end; ++i) {
+            if (stopped.load()) {
+                return;
+            }
+            if (control.cancelled && control.cancelled()) {
+                stopped.store(true);
+                return;
+            }
+
+            // 工作线程中的异常保存下来，在调用线程中重新抛出
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+                stopped.store(true);
+                return;
+            }
+
+            const int finished = ++done;
+            if (control.progress) {
+                control.progress(finished, count);
+            }
+        }
+    }, count);
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    if (stopped.load()) {
+        throw Cancelled();
+    }
+}
+
+cv::Rect TileScheduler::tileRect(const cv::Mat &output)
+{
+    cv::Size wholeSize;
+    cv::Point offset;
+    output.locateROI(wholeSize, offset);
+    return cv::Rect(offset, output.size());
+}
+
+int TileScheduler::tileSizeFor(const cv::Mat &src, int halo)
+{
+    const double pixelBytes = static_cast<double>(std::max<size_t>(1, src.elemSize()));
+    int side = static_cast<int>(std::sqrt(TARGET_TILE_BYTES / pixelBytes)) - 2 * halo;
+    // 对齐到32像素，保证行首地址对齐良好
+    side = side / 32 * 32;
+    return std::max(static_cast<int>(MIN_TILE_SIZE), side);
+}
+
+std::vector<cv::Rect> TileScheduler::tiles(const cv::Size &size, int tileSize)
+{
+    std::vector<cv::Rect> rects;
+    if (size.width <= 0 || size.height <= 0 || tileSize <= 0) {
+        return rects;
+    }
+
+    rects.reserve(static_cast<size_t>(((size.width + tileSize - 1) / tileSize) *
+                                      ((size.height + tileSize - 1) / tileSize)));
+    for (int y = 0; y < size.height; y += tileSize) {
+        for (int x = 0; x < size.width; x += tileSize) {
+            rects.emplace_back(x, y, std::min(tileSize, size.width - x), std::min(tileSize, size.height - y));
+        }
+    }
+    return rects;
+}
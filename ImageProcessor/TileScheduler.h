@@ -0,0 +1,54 @@
+#ifndef TILESCHEDULER_H
+#define TILESCHEDULER_H
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+// 分块并行执行邻域运算
+// 图像划分为适合缓存大小的块，每块向外扩展halo（核半径）个像素作为输入，
+// 运算结果的内部区域直接写入目标矩阵对应位置；块之间相互独立，由cv::parallel_for_调度
+// 块内的边界处理与整幅图像运算一致：内部边缘由halo提供真实像素，图像边缘仍由滤波函数处理
+class TileScheduler
+{
+public:
+    // 处理中的控制：取消检查和进度回调都在工作线程中调用，必须线程安全
+    struct Control {
+        std::function<bool()> cancelled;                   // 返回true时不再开始新的块
+        std::function<void(int done, int total)> progress; // 每完成一块调用一次
+    };
+
+    // 取消时抛出，目标矩阵中只有部分块有效
+    class Cancelled : public std::runtime_error
+    {
+    public:
+        Cancelled() : std::runtime_error("Operation cancelled") {}
+    };
+
+    // 单块运算：input为带halo的输入区域，inner为块在input中的位置，
+    // 结果写入output（目标矩阵中对应块的区域，尺寸与inner相同）
+    using TileFunction = std::function<void(const cv::Mat &input, const cv::Rect &inner, cv::Mat &output)>;
+
+    // 对src分块执行运算，结果写入dst（已分配时尺寸和类型必须匹配，否则重新分配为dstType）
+    static void run(const cv::Mat &src, cv::Mat &dst, int dstType, int halo,
+                    const TileFunction &function, const Control &control = Control());
+
+    // 并行执行count个相互独立的任务（如行带、列条），取消、进度和异常的处理与run相同
+    static void forEach(int count, const std::function<void(int index)> &task,
+                        const Control &control = Control());
+
+    // 块函数中output在整幅目标矩阵中的位置
+    static cv::Rect tileRect(const cv::Mat &output);
+
+    // 按单个像素大小选择块边长，使带halo的输入块约为256KB
+    static int tileSizeFor(const cv::Mat &src, int halo);
+
+    // 划分块：返回每块在图像中的位置
+    static std::vector<cv::Rect> tiles(const cv::Size &size, int tileSize);
+
+    static const int MIN_TILE_SIZE = 64;
+    static const int TARGET_TILE_BYTES = 256 * 1024;
+};
+
+#endif // TILESCHEDULER_H
@@ -0,0 +1,223 @@
+#include "TraceRecorder.h"
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 已退出的线程最多保留的缓冲区数，超过时丢弃最早退出的线程的事件
+static const int MAX_RETIRED_BUFFERS = 16;
+
+struct TraceEvent {
+    const char *name;
+    int64_t timestamp;   // 相对traceEpoch的纳秒数
+    char phase;          // 'B'或'E'
+};
+
+// 一个线程的环形缓冲区：只有所属线程写入，head为已写入的事件总数
+// 导出时按head读取，读取期间被覆盖的事件丢弃
+struct TraceBuffer {
+    int tid = 0;
+    QString name;                           // 由registryMutex保护
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> clearedAt{0};     // clear时的head，之前的事件不再导出
+    std::atomic<bool> retired{false};       // 所属线程已退出
+    std::vector<TraceEvent> events = std::vector<TraceEvent>(TraceRecorder::CAPACITY);
+};
+
+// 线程退出时标记其缓冲区，缓冲区本身由注册表持有，退出后的事件仍可导出
+struct TraceThreadSlot {
+    TraceBuffer *buffer = nullptr;
+    QString name;
+
+    ~TraceThreadSlot()
+    {
+        if (buffer) {
+            buffer->retired.store(true);
+        }
+    }
+};
+
+static std::atomic<bool> traceEnabled(false);
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> registryBuffers;
+static int nextTid = 1;
+static thread_local TraceThreadSlot threadSlot;
+
+static const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+static TraceBuffer* threadBuffer()
+{
+    if (threadSlot.buffer) {
+        return threadSlot.buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    // 丢弃多余的已退出线程的缓冲区，线程反复创建时内存不会无限增长
+    const auto retiredCount = std::count_if(registryBuffers.begin(), registryBuffers.end(),
+        [](const std::unique_ptr<TraceBuffer> &b) { return b->retired.load(); });
+    if (retiredCount >= MAX_RETIRED_BUFFERS) {
+        const auto oldest = std::find_if(registryBuffers.begin(), registryBuffers.end(),
+            [](const std::unique_ptr<TraceBuffer> &b) { return b->retired.load(); });
+        registryBuffers.erase(oldest);
+    }
+
+    std::unique_ptr<TraceBuffer> buffer(new TraceBuffer);
+    buffer->tid = nextTid++;
+    buffer->name = threadSlot.name.isEmpty() ? QStringLiteral("Thread %1").arg(buffer->tid) : threadSlot.name;
+    threadSlot.buffer = buffer.get();
+    registryBuffers.push_back(std::move(buffer));
+    return threadSlot.buffer;
+}
+
+static void recordEvent(const char *name, char phase)
+{
+    TraceBuffer *buffer = threadBuffer();
+    const uint64_t index = buffer->head.load(std::memory_order_relaxed);
+    TraceEvent &event = buffer->events[index & (TraceRecorder::CAPACITY - 1)];
+    event.name = name;
+    event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - traceEpoch).count();
+    event.phase = phase;
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+TraceRecorder::Scope::Scope(const char *name)
+    : m_name(begin(name) ? name : nullptr)
+{
+}
+
+TraceRecorder::Scope::~Scope()
+{
+    if (m_name) {
+        end(m_name);
+    }
+}
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+    traceEnabled.store(enabled);
+}
+
+bool TraceRecorder::isEnabled()
+{
+    return traceEnabled.load(std::memory_order_relaxed);
+}
+
+bool TraceRecorder::begin(const char *name)
+{
+    if (!isEnabled()) {
+        return false;
+    }
+    recordEvent(name, 'B');
+    return true;
+}
+
+void TraceRecorder::end(const char *name)
+{
+    recordEvent(name, 'E');
+}
+
+void TraceRecorder::setThreadName(const QString &name)
+{
+    threadSlot.name = name;
+    if (threadSlot.buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threadSlot.buffer->name = name;
+    }
+}
+
+void TraceRecorder::clear()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const std::unique_ptr<TraceBuffer> &buffer : registryBuffers) {
+        buffer->clearedAt.store(buffer->head.load(std::memory_order_acquire));
+    }
+}
+
+bool TraceRecorder::writeChromeTrace(const QString &path, QString *errorString)
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+
+    QJsonObject processName;
+    processName.insert("name", "process_name");
+    processName.insert("ph", "M");
+    processName.insert("pid", pid);
+    processName.insert("args", QJsonObject{{"name", QCoreApplication::applicationName()}});
+    traceEvents.append(processName);
+
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::unique_ptr<TraceBuffer> &buffer : registryBuffers) {
+            // 先复制再检查：复制期间被所属线程覆盖（或正在写入）的事件丢弃
+            const uint64_t head = buffer->head.load(std::memory_order_acquire);
+            const uint64_t first = std::max<uint64_t>(head > CAPACITY ? head - CAPACITY : 0,
+                                                      buffer->clearedAt.load());
+            std::vector<TraceEvent> events;
+            events.reserve(static_cast<size_t>(head - std::min(first, head)));
+            for (uint64_t i = first; i < head; ++i) {
+                events.push_back(buffer->events[i & (CAPACITY - 1)]);
+            }
+            const uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+            const uint64_t valid = headAfter >= CAPACITY ? headAfter - CAPACITY + 1 : 0;
+            const size_t skip = static_cast<size_t>(std::min<uint64_t>(valid > first ? valid - first : 0,
+                                                                      events.size()));
+
+            QJsonObject threadName;
+            threadName.insert("name", "thread_name");
+            threadName.insert("ph", "M");
+            threadName.insert("pid", pid);
+            threadName.insert("tid", buffer->tid);
+            threadName.insert("args", QJsonObject{{"name", buffer->name}});
+            traceEvents.append(threadName);
+
+            // 缓冲区开头的结束事件对应的开始事件已被覆盖，不导出
+            int depth = 0;
+            for (size_t i = skip; i < events.size(); ++i) {
+                const TraceEvent &event = events[i];
+                if (event.phase == 'E') {
+                    if (depth == 0) {
+                        continue;
+                    }
+                    --depth;
+                } else {
+                    ++depth;
+                }
+
+                const QString name = QString::fromLatin1(event.name);
+                const int dot = name.indexOf('.');
+                QJsonObject entry;
+                entry.insert("name", name);
+                entry.insert("cat", dot > 0 ? name.left(dot) : QStringLiteral("default"));
+                entry.insert("ph", QString(QChar(event.phase)));
+                entry.insert("ts", event.timestamp / 1000.0);   // 微秒
+                entry.insert("pid", pid);
+                entry.insert("tid", buffer->tid);
+                traceEvents.append(entry);
+            }
+        }
+    }
+
+    QJsonObject trace;
+    trace.insert("traceEvents", traceEvents);
+    trace.insert("displayTimeUnit", "ms");
+
+    const QByteArray json = QJsonDocument(trace).toJson(QJsonDocument::Compact);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
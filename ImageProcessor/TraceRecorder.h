@@ -0,0 +1,48 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QString>
+
+// 跟踪记录：各线程的开始/结束事件写入本线程的环形缓冲区，导出为Chrome trace-event JSON，
+// 在about:tracing或Perfetto中离线查看界面事件、后台任务、解码和OpenCV并行区在时间上的重叠
+// 记录只写本线程的缓冲区，不加锁；缓冲区写满后覆盖最早的事件，导出的是每个线程最近的CAPACITY个事件
+// 默认禁用，禁用时记录函数只读取一个原子标志
+class TraceRecorder
+{
+public:
+    // 作用域事件：构造时记录开始，析构时记录结束（异常退出时也记录）
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope& operator=(const Scope &) = delete;
+
+    private:
+        const char *m_name;   // 开始事件未记录（构造时未启用）时为空
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // name必须是字符串字面量，按"类别.名称"命名（与Metrics一致），导出时点号之前的部分作为类别
+    // begin返回是否记录了开始事件，end只应与返回true的begin配对调用，中途禁用时仍会记录结束事件
+    static bool begin(const char *name);
+    static void end(const char *name);
+
+    // 当前线程在跟踪中显示的名称，未设置时为"Thread <序号>"
+    static void setThreadName(const QString &name);
+
+    // 丢弃所有线程已记录的事件
+    static void clear();
+
+    // 导出为Chrome trace-event JSON文件，失败时返回false并设置errorString
+    static bool writeChromeTrace(const QString &path, QString *errorString = nullptr);
+
+    // 每个线程缓冲区的事件数（2的幂）
+    static const int CAPACITY = 1 << 15;
+};
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,271 @@
+#include "ImagePrefetcher.h"
+#include "../ImageProcessor/Metrics.h"
+#include "../ImageProcessor/TraceRecorder.h"
+#include <QRunnable>
+#include <QImageReader>
+#include <QMetaObject>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include <climits>
+#include <exception>
+
+// 解码一张图像，开始前和解码后各检查一次取消标志
+class ImagePrefetcher::Task : public QRunnable
+{
+public:
+    Task(ImagePrefetcher *prefetcher, const QString &path, const QSharedPointer<Request> &request)
+        : m_prefetcher(prefetcher), m_path(path), m_request(request)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        TraceRecorder::setThreadName("Prefetch");
+        m_request->started.storeRelease(1);
+        if (m_request->cancelled.loadAcquire()) {
+            return;
+        }
+
+        QImage image;
+        try {
+            image = decode(m_path);
+        } catch (const std::exception& e) {
+            qDebug() << "ImagePrefetcher: failed to decode" << m_path << e.what();
+        } catch (...) {
+            qDebug() << "ImagePrefetcher: failed to decode" << m_path;
+        }
+
+        // 解码期间用户已离开的图像不再送回
+        ImagePrefetcher *prefetcher = m_prefetcher;
+        const QString path = m_path;
+        const QSharedPointer<Request> request = m_request;
+        if (request->cancelled.loadAcquire()) {
+            image = QImage();
+        }
+        // 预取器被销毁时排队的调用会被丢弃
+        QMetaObject::invokeMethod(prefetcher, [prefetcher, path, request, image]() {
+            prefetcher->handleDecoded(path, request, image);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    ImagePrefetcher *m_prefetcher;
+    QString m_path;
+    QSharedPointer<Request> m_request;
+};
+
+ImagePrefetcher::ImagePrefetcher(QObject *parent)
+    : QObject(parent), m_aheadCount(DEFAULT_AHEAD_COUNT), m_behindCount(DEFAULT_BEHIND_COUNT)
+{
+    // 解码以IO和单线程解码器为主，两个线程足以跟上浏览速度，不与图像处理争抢核心
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 2));
+    setCacheLimit(DEFAULT_CACHE_LIMIT);
+}
+
+ImagePrefetcher::~ImagePrefetcher()
+{
+    cancelAll();
+    m_pool.waitForDone();
+}
+
+void ImagePrefetcher::setFiles(const QStringList &files)
+{
+    clear();
+    m_files = files;
+}
+
+void ImagePrefetcher::clear()
+{
+    cancelAll();
+    m_cache.clear();
+    m_files.clear();
+}
+
+QImage ImagePrefetcher::cachedImage(const QString &path)
+{
+    const QImage *image = m_cache.object(path);
+    return image ? *image : QImage();
+}
+
+void ImagePrefetcher::insert(const QString &path, const QImage &image)
+{
+    if (image.isNull()) {
+        return;
+    }
+    cancel(path);
+    // 超过缓存上限的单张图像不缓存，QCache会直接删除
+    m_cache.insert(path, new QImage(image), imageCost(image));
+}
+
+bool ImagePrefetcher::isPending(const QString &path) const
+{
+    return m_pending.contains(path);
+}
+
+void ImagePrefetcher::load(const QString &path)
+{
+    if (m_cache.contains(path)) {
+        emit imageReady(path);
+        return;
+    }
+    schedule(path, INT_MAX);
+}
+
+void ImagePrefetcher::prefetch(int index, int direction)
+{
+    const int count = m_files.size();
+    if (index < 0 || index >= count) {
+        return;
+    }
+
+    // 按距离排序，反方向的一张与沿浏览方向的两张距离相当
+    struct Slot {
+        int cost;
+        QString path;
+    };
+    QVector<Slot> candidates;
+    const int step = direction < 0 ? -1 : 1;
+    const int ahead = m_aheadCount;
+    const int behind = direction == 0 ? m_aheadCount : m_behindCount;
+    for (int k = 1; k <= ahead; ++k) {
+        candidates.append({k, m_files.at(((index + step * k) % count + count) % count)});
+    }
+    for (int k = 1; k <= behind; ++k) {
+        candidates.append({direction == 0 ? k : 2 * k, m_files.at(((index - step * k) % count + count) % count)});
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Slot &a, const Slot &b) { return a.cost < b.cost; });
+
+    // 列表较短时首尾相接会重复，当前图像也不需要预取
+    QStringList wanted;
+    const QString &current = m_files.at(index);
+    for (const Slot &slot : candidates) {
+        if (slot.path != current && !wanted.contains(slot.path)) {
+            wanted.append(slot.path);
+        }
+    }
+
+    // 离开窗口的请求取消
+    const QStringList pendingPaths = m_pending.keys();
+    for (const QString &path : pendingPaths) {
+        if (path != current && !wanted.contains(path)) {
+            cancel(path);
+        }
+    }
+
+    for (int i = 0; i < wanted.size(); ++i) {
+        const QString &path = wanted.at(i);
+        if (m_cache.contains(path)) {
+            continue;
+        }
+        schedule(path, wanted.size() - i);
+    }
+}
+
+void ImagePrefetcher::setWindow(int aheadCount, int behindCount)
+{
+    m_aheadCount = qMax(0, aheadCount);
+    m_behindCount = qMax(0, behindCount);
+}
+
+void ImagePrefetcher::setCacheLimit(qint64 bytes)
+{
+    m_cache.setMaxCost(static_cast<int>(qBound<qint64>(0, bytes / 1024, INT_MAX)));
+}
+
+qint64 ImagePrefetcher::cacheLimit() const
+{
+    return static_cast<qint64>(m_cache.maxCost()) * 1024;
+}
+
+qint64 ImagePrefetcher::cachedBytes() const
+{
+    return static_cast<qint64>(m_cache.totalCost()) * 1024;
+}
+
+QImage ImagePrefetcher::decode(const QString &path, QString *errorString)
+{
+    Metrics::ScopedTimer timer("decode.image");
+    QImageReader reader(path);
+    reader.setDecideFormatFromContent(true);
+
+    QImage image;
+    if (!reader.read(&image)) {
+        if (errorString) {
+            *errorString = reader.errorString();
+        }
+        return QImage();
+    }
+    timer.stop();
+    return image;
+}
+
+void ImagePrefetcher::handleDecoded(const QString &path, const QSharedPointer<Request> &request, const QImage &image)
+{
+    auto it = m_pending.find(path);
+    if (it == m_pending.end() || it.value().request != request) {
+        return;
+    }
+    m_pending.erase(it);
+
+    if (request->cancelled.loadAcquire()) {
+        return;
+    }
+    // 解码失败的图像不缓存，显示时同步解码并报告错误
+    if (image.isNull()) {
+        emit decodeFailed(path);
+        return;
+    }
+    m_cache.insert(path, new QImage(image), imageCost(image));
+    emit imageReady(path);
+}
+
+void ImagePrefetcher::cancel(const QString &path)
+{
+    auto it = m_pending.find(path);
+    if (it == m_pending.end()) {
+        return;
+    }
+    Pending pending = it.value();
+    m_pending.erase(it);
+
+    pending.request->cancelled.storeRelease(1);
+    // 还在排队的任务直接移出线程池；已开始的任务可能已被删除，不再访问其指针
+    if (!pending.request->started.loadAcquire() && m_pool.tryTake(pending.task)) {
+        delete pending.task;
+    }
+}
+
+void ImagePrefetcher::cancelAll()
+{
+    const QStringList paths = m_pending.keys();
+    for (const QString &path : paths) {
+        cancel(path);
+    }
+}
+
+void ImagePrefetcher::schedule(const QString &path, int priority)
+{
+    auto it = m_pending.find(path);
+    if (it != m_pending.end()) {
+        Pending &pending = it.value();
+        if (pending.request->started.loadAcquire() || !m_pool.tryTake(pending.task)) {
+            return;
+        }
+        m_pool.start(pending.task, priority);
+        return;
+    }
+
+    Pending pending;
+    pending.request.reset(new Request);
+    pending.task = new Task(this, path, pending.request);
+    m_pending.insert(path, pending);
+    m_pool.start(pending.task, priority);
+}
+
+int ImagePrefetcher::imageCost(const QImage &image)
+{
+    return static_cast<int>(qMax<qint64>(1, static_cast<qint64>(image.sizeInBytes()) / 1024));
+}
@@ -0,0 +1,87 @@
+#ifndef IMAGEPREFETCHER_H
+#define IMAGEPREFETCHER_H
+
+#include <QObject>
+#include <QImage>
+#include <QCache>
+#include <QHash>
+#include <QStringList>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <QAtomicInt>
+
+// 文件夹浏览的预取解码缓存
+// 在后台线程中解码当前图像前后若干张，按浏览方向安排优先级，结果放入按内存大小限制的LRU缓存
+// 缓存和任务表只在对象所在线程（界面线程）中访问，后台解码结果通过排队调用送回
+class ImagePrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ImagePrefetcher(QObject *parent = nullptr);
+    ~ImagePrefetcher() override;
+
+    // 设置新的文件列表（如打开新文件夹），清空缓存并取消所有未完成的解码
+    void setFiles(const QStringList &files);
+    void clear();
+
+    // 缓存中的图像，未命中时返回空图像；命中的图像成为最近使用的一项
+    QImage cachedImage(const QString &path);
+    // 放入同步解码的图像，使回到该图像时也能直接显示
+    void insert(const QString &path, const QImage &image);
+    bool isPending(const QString &path) const;
+    // 以最高优先级在后台解码一张图像（如已显示了缩小预览的当前图像），完成时发出imageReady
+    void load(const QString &path);
+
+    // 以index为中心预取：沿浏览方向（1向后，-1向前）取aheadCount张，反方向取behindCount张，
+    // direction为0时两侧都取aheadCount张；列表首尾相接，与导航按钮的循环浏览一致
+    // 不在新窗口内的排队任务被移出线程池，正在解码的任务完成后丢弃结果；当前图像自己的请求保留
+    void prefetch(int index, int direction);
+
+    void setWindow(int aheadCount, int behindCount);
+    void setCacheLimit(qint64 bytes);
+    qint64 cacheLimit() const;
+    qint64 cachedBytes() const;
+
+    // 在调用线程中解码，失败时返回空图像并设置errorString
+    static QImage decode(const QString &path, QString *errorString = nullptr);
+
+    static const int DEFAULT_AHEAD_COUNT = 4;
+    static const int DEFAULT_BEHIND_COUNT = 2;
+    static const qint64 DEFAULT_CACHE_LIMIT = 512LL * 1024 * 1024;
+
+signals:
+    void imageReady(const QString &path);
+    void decodeFailed(const QString &path);
+
+private:
+    class Task;
+
+    // 任务与界面线程共享的状态
+    struct Request {
+        QAtomicInt cancelled;
+        QAtomicInt started;
+    };
+
+    struct Pending {
+        Task *task = nullptr;
+        QSharedPointer<Request> request;
+    };
+
+    // 在对象所在线程中接收解码结果，已被取消或取代的请求直接丢弃
+    void handleDecoded(const QString &path, const QSharedPointer<Request> &request, const QImage &image);
+    void cancel(const QString &path);
+    void cancelAll();
+    // 排队中的任务按新的优先级重新排队，已开始的任务不受影响
+    void schedule(const QString &path, int priority);
+
+    static int imageCost(const QImage &image);  // 以KB计，避免大图的字节数超出int
+
+    QThreadPool m_pool;
+    QCache<QString, QImage> m_cache;
+    QHash<QString, Pending> m_pending;
+    QStringList m_files;
+    int m_aheadCount;
+    int m_behindCount;
+};
+
+#endif // IMAGEPREFETCHER_H
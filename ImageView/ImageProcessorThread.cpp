@@ -1,4 +1,6 @@
 #include "ImageProcessorThread.h"
+#include "../ImageProcessor/ImageStatisticsCache.h"
+#include "../ImageProcessor/TraceRecorder.h"
 #include <QDebug>
 
 ImageProcessorThread::ImageProcessorThread(QObject *parent)
@@ -36,6 +38,7 @@ void ImageProcessorThread::stop()
 
 void ImageProcessorThread::run()
 {
+    TraceRecorder::setThreadName("ImageProcessorThread");
     while (!m_stop) {
         QMutexLocker locker(&m_mutex);
         if (!m_imageUpdated && !m_stop) {
@@ -49,6 +52,7 @@ void ImageProcessorThread::run()
 
         if (!image.isNull()) {
             try {
+                TraceRecorder::Scope scope("worker.processImage");
                 processImage();
                 calculateImageStats();
             } catch (const std::exception& e) {
@@ -79,39 +83,12 @@ void ImageProcessorThread::calculateImageStats()
     }
 
     try {
-        double sum = 0;
-        int count = 0;
-        
-        const uchar *bits = m_currentImage.bits();
-        if (!bits) {
-            qDebug() << "Error: Invalid image bits";
-            return;
-        }
-
-        int bytesPerLine = m_currentImage.bytesPerLine();
-        int width = m_currentImage.width();
-        int height = m_currentImage.height();
-        
-        if (width <= 0 || height <= 0) {
-            qDebug() << "Error: Invalid image dimensions";
-            return;
-        }
-
-        for (int y = 0; y < height; ++y) {
-            const uchar *line = bits + y * bytesPerLine;
-            for (int x = 0; x < width; ++x) {
-                sum += line[x];
-                ++count;
-            }
-        }
-        
-        if (count > 0) {
-            double meanValue = sum / count;
-            // 确保在主线程中发送信号
-            QMetaObject::invokeMethod(this, [this, meanValue]() {
-                emit imageStatsUpdated(meanValue);
-            }, Qt::QueuedConnection);
-        }
+        // 与界面共用统计缓存：同一版本的图像只遍历一次，且覆盖所有通道而不只是每个像素的首字节
+        const double meanValue = ImageStatisticsCache::grayMean(m_currentImage);
+        // 确保在主线程中发送信号
+        QMetaObject::invokeMethod(this, [this, meanValue]() {
+            emit imageStatsUpdated(meanValue);
+        }, Qt::QueuedConnection);
     } catch (const std::exception& e) {
         qDebug() << "Error calculating image stats:" << e.what();
     }
@@ -0,0 +1,195 @@
+#include "ImagePyramid.h"
+#include "../ImageProcessor/ImageMatAdapter.h"
+#include "../ImageProcessor/Metrics.h"
+#include <QRunnable>
+#include <QThreadPool>
+#include <QMetaObject>
+#include <QDebug>
+#include <opencv2/imgproc.hpp>
+
+// 后台逐层生成金字塔，每生成一层就送回界面线程，先到的粗层可以立即使用
+class ImagePyramid::Builder : public QRunnable
+{
+public:
+    Builder(ImagePyramid *pyramid, quint64 generation, const QImage &base,
+            const QSharedPointer<QAtomicInt> &cancelFlag)
+        : m_pyramid(pyramid), m_generation(generation), m_base(base), m_cancelFlag(cancelFlag)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        QImage current = m_base;
+        while (qMax(current.width(), current.height()) >= 2 * MIN_LEVEL_SIZE) {
+            if (m_cancelFlag->loadAcquire()) {
+                return;
+            }
+
+            QImage next;
+            try {
+                Metrics::ScopedTimer timer("render.pyramidLevel");
+                next = downsample(current);
+                timer.stop();
+            } catch (const std::exception& e) {
+                qDebug() << "ImagePyramid: failed to build level:" << e.what();
+                break;
+            }
+            if (next.isNull()) {
+                break;
+            }
+
+            const bool last = qMax(next.width(), next.height()) < 2 * MIN_LEVEL_SIZE;
+            post(next, last);
+            if (last) {
+                return;
+            }
+            current = next;
+        }
+        post(QImage(), true);
+    }
+
+private:
+    void post(const QImage &level, bool last)
+    {
+        ImagePyramid *pyramid = m_pyramid;
+        const quint64 generation = m_generation;
+        // 金字塔对象被销毁时排队的调用会被丢弃
+        QMetaObject::invokeMethod(pyramid, [pyramid, generation, level, last]() {
+            pyramid->appendLevel(generation, level, last);
+        }, Qt::QueuedConnection);
+    }
+
+    ImagePyramid *m_pyramid;
+    quint64 m_generation;
+    QImage m_base;
+    QSharedPointer<QAtomicInt> m_cancelFlag;
+};
+
+ImagePyramid::ImagePyramid(QObject *parent)
+    : QObject(parent), m_generation(0), m_complete(true)
+{
+}
+
+ImagePyramid::~ImagePyramid()
+{
+    cancelBuild();
+}
+
+void ImagePyramid::setImage(const QImage &image)
+{
+    cancelBuild();
+    m_levels.clear();
+    ++m_generation;
+
+    if (image.isNull()) {
+        m_complete = true;
+        return;
+    }
+
+    // 第0层直接共享原图数据
+    m_levels.append(image);
+    m_complete = false;
+    m_cancelFlag.reset(new QAtomicInt(0));
+    QThreadPool::globalInstance()->start(new Builder(this, m_generation, image, m_cancelFlag));
+}
+
+void ImagePyramid::clear()
+{
+    setImage(QImage());
+}
+
+bool ImagePyramid::isEmpty() const
+{
+    return m_levels.isEmpty();
+}
+
+bool ImagePyramid::isComplete() const
+{
+    return m_complete;
+}
+
+QSize ImagePyramid::baseSize() const
+{
+    return m_levels.isEmpty() ? QSize() : m_levels.first().size();
+}
+
+int ImagePyramid::levelCount() const
+{
+    return m_levels.size();
+}
+
+const QImage& ImagePyramid::level(int index) const
+{
+    return m_levels.at(index);
+}
+
+int ImagePyramid::levelIndexFor(const QSize &targetSize) const
+{
+    int index = 0;
+    for (int i = 1; i < m_levels.size(); ++i) {
+        const QSize size = m_levels.at(i).size();
+        if (size.width() < targetSize.width() || size.height() < targetSize.height()) {
+            break;
+        }
+        index = i;
+    }
+    return index;
+}
+
+QImage ImagePyramid::scaledImage(const QSize &targetSize, Qt::TransformationMode mode) const
+{
+    if (m_levels.isEmpty() || targetSize.isEmpty()) {
+        return QImage();
+    }
+
+    const QImage &source = m_levels.at(levelIndexFor(targetSize));
+    if (source.size() == targetSize) {
+        return source;
+    }
+    return source.scaled(targetSize, Qt::IgnoreAspectRatio, mode);
+}
+
+QPixmap ImagePyramid::scaledPixmap(const QSize &targetSize, Qt::TransformationMode mode) const
+{
+    return QPixmap::fromImage(scaledImage(targetSize, mode));
+}
+
+QImage ImagePyramid::downsample(const QImage &image)
+{
+    const QSize size(qMax(1, image.width() / 2), qMax(1, image.height() / 2));
+
+    if (!ImageMatAdapter::canWrap(image.format())) {
+        return image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    // 区域插值在2倍缩小时等价于2x2均值，直接写入目标QImage的扫描线
+    QImage result(size, image.format());
+    cv::Mat dst = ImageMatAdapter::view(result);
+    cv::resize(ImageMatAdapter::constView(image), dst, dst.size(), 0, 0, cv::INTER_AREA);
+    return result;
+}
+
+void ImagePyramid::appendLevel(quint64 generation, const QImage &level, bool last)
+{
+    if (generation != m_generation) {
+        return;  // 旧图像的结果
+    }
+
+    if (!level.isNull()) {
+        m_levels.append(level);
+        emit levelReady(m_levels.size() - 1);
+    }
+    if (last) {
+        m_complete = true;
+        emit completed();
+    }
+}
+
+void ImagePyramid::cancelBuild()
+{
+    if (m_cancelFlag) {
+        m_cancelFlag->storeRelease(1);
+        m_cancelFlag.reset();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include <QObject>
+#include <QImage>
+#include <QPixmap>
+#include <QVector>
+#include <QSharedPointer>
+#include <QAtomicInt>
+
+// 显示用的多级图像金字塔（mipmap）
+// 第0层与原图共享数据，之后每层长宽减半，在后台线程中逐层生成
+// 显示时从不小于目标尺寸的最小一层缩放，缩放、平移、窗口变化只处理显示尺寸量级的数据
+class ImagePyramid : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ImagePyramid(QObject *parent = nullptr);
+    ~ImagePyramid() override;
+
+    // 设置新图像，取消尚未完成的旧金字塔并在后台开始生成新的层级
+    void setImage(const QImage &image);
+    void clear();
+
+    bool isEmpty() const;
+    bool isComplete() const;
+    QSize baseSize() const;
+    int levelCount() const;              // 已生成的层数（包括第0层）
+    const QImage& level(int index) const;
+
+    // 已生成的层中不小于targetSize的最小一层
+    int levelIndexFor(const QSize &targetSize) const;
+    // 从最合适的层缩放到targetSize（不保持纵横比，由调用方计算目标尺寸）
+    QImage scaledImage(const QSize &targetSize, Qt::TransformationMode mode = Qt::SmoothTransformation) const;
+    QPixmap scaledPixmap(const QSize &targetSize, Qt::TransformationMode mode = Qt::SmoothTransformation) const;
+
+    // 长宽各减半，可直接包装的格式用区域插值，其余格式用QImage平滑缩放
+    static QImage downsample(const QImage &image);
+
+    static const int MIN_LEVEL_SIZE = 256;  // 长边小于该值时停止生成下一层
+
+signals:
+    void levelReady(int index);
+    void completed();
+
+private:
+    class Builder;
+
+    // 在对象所在线程中接收后台生成的层，generation不匹配的结果直接丢弃
+    void appendLevel(quint64 generation, const QImage &level, bool last);
+    void cancelBuild();
+
+    QVector<QImage> m_levels;
+    quint64 m_generation;
+    QSharedPointer<QAtomicInt> m_cancelFlag;  // 与当前后台任务共享
+    bool m_complete;
+};
+
+#endif // IMAGEPYRAMID_H
@@ -1,4 +1,9 @@
 #include "ProcessingWidget.h"
+#include "TiledImageView.h"
+#include "ImagePrefetcher.h"
+#include "../ImageProcessor/RecursiveGaussian.h"
+#include "../ImageProcessor/ImageStatisticsCache.h"
+#include "../ImageProcessor/Metrics.h"
 #include <QPushButton>
 #include <QSlider>
 #include <QTabWidget>
@@ -14,6 +19,7 @@
 #include <QPainter>
 #include <QDebug>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QButtonGroup>
 #include <QToolButton>
 #include <QIcon>
@@ -120,6 +126,13 @@ public:
         update();
     }
 
+    // 缩放到显示尺寸的ROI掩码，offset为图像显示区域的左上角；用于填充环形等不能直接用画刷表示的区域
+    void setROIMask(const RoiMask& displayMask, const QPoint& offset) {
+        m_displayMask = displayMask;
+        m_maskOffset = offset;
+        update();
+    }
+
 protected:
     void paintEvent(QPaintEvent *event) override {
         QWidget::paintEvent(event);
@@ -157,6 +170,16 @@ protected:
         QBrush brush(QColor(128, 218, 235, 60)); // 半透明浅蓝色
         painter.setBrush(brush);
         
+        // 按掩码逐段填充ROI区域
+        const bool fillFromMask = m_multiCircleState == MultiCircleState::RingROI && !m_displayMask.isEmpty();
+        if (fillFromMask) {
+            const QColor maskColor(255, 0, 128, 60); // 半透明粉红色
+            for (const RoiRasterizer::Span &span : m_displayMask.spans()) {
+                painter.fillRect(QRect(m_maskOffset.x() + span.x0, m_maskOffset.y() + span.y, span.length(), 1),
+                                 maskColor);
+            }
+        }
+        
         // 绘制矩形ROI - 确保只绘制与图像区域相交的部分
         if (!m_rectangleROI.isNull()) {
             // 计算与实际图像区域的交集
@@ -239,6 +262,9 @@ protected:
             
             QBrush circleBrush = m_multiCircleState >= MultiCircleState::FirstCircle ? 
                                QBrush(QColor(0, 128, 255, 40)) : brush; // 半透明蓝色
+            if (fillFromMask) {
+                circleBrush = Qt::NoBrush; // 环形区域已由掩码填充
+            }
             painter.setBrush(circleBrush);
             
             // 检查圆心是否在图像区域内
@@ -375,6 +401,9 @@ protected:
             painter.setPen(secondCirclePen);
             
             QBrush secondCircleBrush(QColor(255, 128, 0, 40)); // 半透明橙色
+            if (fillFromMask) {
+                secondCircleBrush = Qt::NoBrush;
+            }
             painter.setBrush(secondCircleBrush);
             
             // 检查圆心是否在图像区域内
@@ -607,6 +636,10 @@ private:
     bool m_handleSelected = false;
     ResizeDirection m_selectedDirection = ResizeDirection::None;
     int m_selectedCircleIndex = -1; // -1表示没有选中, 0表示第一个圆, 1表示第二个圆
+    
+    // 显示尺寸的ROI掩码
+    RoiMask m_displayMask;
+    QPoint m_maskOffset;
 };
 
 // 定义调整圆形的方向枚举
@@ -656,6 +689,8 @@ ProcessingWidget::ProcessingWidget(QWidget *parent)
     , MAX_ZOOM(2.0)
     , MIN_ZOOM(0.5)
     , spinKernelSize(nullptr)
+    , m_spinSigma(nullptr)
+    , m_gaussianKernelFromSigma(nullptr)
     , m_currentROIMode(ROISelectionMode::None)
     , m_selectionInProgress(false)
     , m_arbitraryPoints()
@@ -694,6 +729,20 @@ ProcessingWidget::ProcessingWidget(QWidget *parent)
         m_roiOverlay = new ROIOverlay(imageLabel);
         m_roiOverlay->setGeometry(0, 0, imageLabel->width(), imageLabel->height());
         m_roiOverlay->show();
+
+        m_prefetcher = new ImagePrefetcher(this);
+        // 后台解码完成（或失败）时换入全分辨率图像，失败时由同步解码报告错误
+        connect(m_prefetcher, &ImagePrefetcher::imageReady, this, [this](const QString &path) {
+            if (path == m_pendingFullImagePath) {
+                ensureFullImage();
+            }
+        });
+        connect(m_prefetcher, &ImagePrefetcher::decodeFailed, this, [this](const QString &path) {
+            if (path == m_pendingFullImagePath) {
+                ensureFullImage();
+            }
+        });
+        connectFullImageGate();
         
         qDebug() << "UI setup completed";
 
@@ -785,10 +834,13 @@ void ProcessingWidget::setupUi()
         QLabel *kernelLabel = new QLabel(tr("卷积核大小:"));
         spinKernelSize = new QSpinBox();
         spinKernelSize->setMinimum(3);
-        spinKernelSize->setMaximum(31);
+        spinKernelSize->setMaximum(ImageProcessor::MAX_MEAN_KERNEL_SIZE);
         spinKernelSize->setSingleStep(2);
         spinKernelSize->setValue(3);
-        spinKernelSize->setToolTip(tr("设置滤波的卷积核大小 (3-31, 仅奇数)"));
+        spinKernelSize->setToolTip(tr("设置滤波的卷积核大小 (仅奇数, 均值滤波3-%1, 中值滤波3-%2, 高斯滤波3-%3)")
+                                        .arg(ImageProcessor::MAX_MEAN_KERNEL_SIZE)
+                                        .arg(ImageProcessor::MAX_MEDIAN_KERNEL_SIZE)
+                                        .arg(ImageProcessor::MAX_KERNEL_SIZE));
         
         // 确保只能设置奇数值
         connect(spinKernelSize, QOverload<int>::of(&QSpinBox::valueChanged), 
@@ -809,6 +861,28 @@ void ProcessingWidget::setupUi()
 
         vFilter->addLayout(kernelLayout);
 
+        // 高斯滤波sigma控制，核大小由sigma决定且sigma较大时自动使用递归高斯
+        auto *sigmaLayout = new QHBoxLayout();
+        QLabel *sigmaLabel = new QLabel(tr("高斯Sigma:"));
+        m_spinSigma = new QDoubleSpinBox();
+        m_spinSigma->setDecimals(1);
+        m_spinSigma->setRange(0.1, 200.0);
+        m_spinSigma->setSingleStep(0.5);
+        m_spinSigma->setValue(1.0);
+        m_spinSigma->setToolTip(tr("设置高斯滤波的sigma；卷积核小于6σ+1时按卷积核截断"));
+
+        sigmaLayout->addWidget(sigmaLabel);
+        sigmaLayout->addWidget(m_spinSigma);
+
+        vFilter->addLayout(sigmaLayout);
+
+        // 高斯卷积核最大为31，更大的模糊由sigma决定核大小，sigma不小于阈值时使用运算量与sigma无关的递归高斯
+        m_gaussianKernelFromSigma = new QCheckBox(tr("高斯核大小由sigma决定"));
+        m_gaussianKernelFromSigma->setChecked(false);
+        m_gaussianKernelFromSigma->setToolTip(tr("忽略卷积核大小，按sigma使用完整的高斯核；sigma不小于%1时使用递归高斯")
+                                                  .arg(RecursiveGaussian::SIGMA_THRESHOLD));
+        vFilter->addWidget(m_gaussianKernelFromSigma);
+
         // 添加复选框
         m_subtractFiltered = new QCheckBox(tr("从原图中减去"));
         m_subtractFiltered->setChecked(false);
@@ -829,7 +903,7 @@ void ProcessingWidget::setupUi()
         // 中间布局
         QWidget *centerW = new QWidget;
         auto *vCenter = new QVBoxLayout(centerW);
-        imageLabel = new QLabel;
+        imageLabel = new TiledImageView;
         imageLabel->setAlignment(Qt::AlignCenter);
         imageLabel->setMinimumSize(600, 900); // Increased height from 500 to 700
         imageLabel->setStyleSheet("QLabel { background-color : white; border: 1px solid gray; }");
@@ -1107,9 +1181,15 @@ void ProcessingWidget::setupROISelectionControls()
         btnApplyROI = new QPushButton(tr("应用ROI"));
         btnApplyROI->setEnabled(false); // 初始禁用
         
+        // 仅在ROI内处理：滤波和点运算只计算所选区域
+        m_processInROI = new QCheckBox(tr("仅在ROI内处理"));
+        m_processInROI->setToolTip(tr("滤波和亮度、Gamma调整只计算所选区域，区域以外保持不变"));
+        m_processInROI->setChecked(false);
+        
         // 添加工具按钮布局和应用按钮到ROI分组框
         vROI->addLayout(hToolButtons);
         vROI->addWidget(btnApplyROI);
+        vROI->addWidget(m_processInROI);
         
         // 连接信号 - 修复QButtonGroup::buttonClicked连接
         connect(roiSelectionGroup, &QButtonGroup::idClicked, 
@@ -1118,6 +1198,7 @@ void ProcessingWidget::setupROISelectionControls()
         
         // 连接应用ROI按钮信号
         connect(btnApplyROI, &QPushButton::clicked, this, [this]() {
+            ensureFullImage();
             bool roiApplied = false;
             
             switch (m_currentROIMode) {
@@ -1254,10 +1335,10 @@ void ProcessingWidget::displayImage(const QImage &image)
                 << "深度:" << image.depth() << "位"
                 << "是否空:" << image.isNull();
 
-        // 创建一个安全的深拷贝
+        // 隐式共享，不复制像素数据（超大图像深拷贝会占用双倍内存）
         QImage safeImage;
         try {
-            safeImage = image.copy();
+            safeImage = image;
             
             // 对于索引色图像，转换为RGB32格式以确保安全
             if (safeImage.format() == QImage::Format_Indexed8 || 
@@ -1282,46 +1363,22 @@ void ProcessingWidget::displayImage(const QImage &image)
 
         // 设置当前图像
         m_currentImage = safeImage;
+        m_fitToLabel = true;
         
         // 发射图像变化信号
         emit imageChanged(m_currentImage);
 
-        // 创建QPixmap并缩放
-        QPixmap pixmap;
-        try {
-            pixmap = QPixmap::fromImage(safeImage);
-            if (pixmap.isNull()) {
-                qDebug() << "Error: Failed to create pixmap from image";
-                return;
-            }
-
-            qDebug() << "Scaling pixmap to label size:" << imageLabel->size();
-            pixmap = pixmap.scaled(imageLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-            if (pixmap.isNull()) {
-                qDebug() << "Error: Failed to scale pixmap";
-                return;
-            }
-        }
-        catch (const std::exception& e) {
-            qDebug() << "创建或缩放QPixmap时出错:" << e.what();
-            return;
-        }
-        catch (...) {
-            qDebug() << "创建或缩放QPixmap时出现未知错误";
-            return;
-        }
-
-        // 设置到标签
+        // 交给分块视图显示：只渲染可见的块，不再生成整幅QPixmap
         try {
-            imageLabel->setPixmap(pixmap);
+            imageLabel->setImage(safeImage);
+            updateImageViewport();
         }
         catch (const std::exception& e) {
-            qDebug() << "设置QPixmap到标签时出错:" << e.what();
+            qDebug() << "设置分块视图图像时出错:" << e.what();
             return;
         }
         catch (...) {
-            qDebug() << "设置QPixmap到标签时出现未知错误";
+            qDebug() << "设置分块视图图像时出现未知错误";
             return;
         }
 
@@ -1350,27 +1407,59 @@ void ProcessingWidget::displayImage(const QImage &image)
     isProcessing = false;
 }
 
-// 添加一个辅助函数来计算图像的均值
-double ProcessingWidget::calculateMeanValue(const QImage &image)
+void ProcessingWidget::displayPreviewImage(const QImage &image)
 {
-    try {
-        if (image.isNull()) {
-            return 0.0;
-        }
+    if (image.isNull() || !imageLabel) {
+        return;
+    }
 
-        double sum = 0.0;
-        int count = 0;
+    // 预览图像已接近显示尺寸，与全分辨率图像使用相同的显示区域
+    imageLabel->setImage(image);
+    updateImageViewport();
+}
 
-        for (int y = 0; y < image.height(); ++y) {
-            for (int x = 0; x < image.width(); ++x) {
-                QColor pixel = image.pixelColor(x, y);
-                int gray = qGray(pixel.rgb());
-                sum += gray;
-                count++;
-            }
-        }
+// 根据当前显示模式设置分块视图中整幅图像的显示区域
+void ProcessingWidget::updateImageViewport()
+{
+    if (!imageLabel || !imageLabel->hasImage() || m_currentImage.isNull()) {
+        return;
+    }
+
+    QRect rect;
+    if (m_fitToLabel) {
+        // 与坐标换算使用同一显示区域，ROI工具的坐标保持一致
+        rect = getScaledImageRect();
+    } else {
+        // 滚轮缩放：按原图尺寸乘以缩放系数，居中显示
+        rect = QRect(QPoint(0, 0), m_currentImage.size() * m_zoomFactor);
+        rect.moveCenter(imageLabel->rect().center());
+    }
+    imageLabel->setDisplayRect(rect);
+}
+
+QSize ProcessingWidget::displaySize() const
+{
+    return imageLabel ? imageLabel->size() : QSize();
+}
+
+double ProcessingWidget::getGaussianSigma() const
+{
+    return m_spinSigma ? m_spinSigma->value() : 1.0;
+}
 
-        return count > 0 ? sum / count : 0.0;
+int ProcessingWidget::getGaussianKernelSize() const
+{
+    if (m_gaussianKernelFromSigma && m_gaussianKernelFromSigma->isChecked()) {
+        return 0;
+    }
+    return getKernelSize();
+}
+
+// 图像的灰度均值：与直方图对话框共用按图像版本缓存的统计结果
+double ProcessingWidget::calculateMeanValue(const QImage &image)
+{
+    try {
+        return ImageStatisticsCache::grayMean(image);
     } catch (const std::exception& e) {
         qDebug() << "Error calculating mean value:" << e.what();
         return 0.0;
@@ -1392,22 +1481,10 @@ void ProcessingWidget::onImageProcessed(const QImage &processedImage)
 
         qDebug() << "Processing image size:" << processedImage.width() << "x" << processedImage.height();
         m_currentImage = processedImage;  // 保存当前图像
+        m_fitToLabel = true;
 
-        QPixmap pixmap = QPixmap::fromImage(processedImage);
-        if (pixmap.isNull()) {
-            qDebug() << "Error: Failed to create pixmap from image";
-            return;
-        }
-
-        qDebug() << "Scaling pixmap to label size:" << imageLabel->size();
-        pixmap = pixmap.scaled(imageLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-        if (pixmap.isNull()) {
-            qDebug() << "Error: Failed to scale pixmap";
-            return;
-        }
-
-        imageLabel->setPixmap(pixmap);
+        imageLabel->setImage(processedImage);
+        updateImageViewport();
         qDebug() << "Image display updated successfully";
     } catch (const std::exception& e) {
         qDebug() << "Error in onImageProcessed:" << e.what();
@@ -1513,8 +1590,8 @@ void ProcessingWidget::clearROISelection()
 void ProcessingWidget::mousePressEvent(QMouseEvent *event)
 {
     try {
-        // 确保图像已加载且imageLabel存在
-        if (m_currentImage.isNull() || !imageLabel) {
+        // 确保图像已加载且imageLabel存在，ROI坐标按全分辨率图像换算
+        if (!ensureFullImage() || !imageLabel) {
             return;
         }
 
@@ -1672,7 +1749,7 @@ void ProcessingWidget::paintEvent(QPaintEvent *event)
     QWidget::paintEvent(event);
     
     // 如果没有图像，不绘制ROI
-    if (m_currentImage.isNull() || !imageLabel || !imageLabel->pixmap()) {
+    if (m_currentImage.isNull() || !imageLabel || !imageLabel->hasImage()) {
         return;
     }
     
@@ -1998,6 +2075,8 @@ int ProcessingWidget::calculateImageDistance(int uiDistance)
 // 添加一个方法来强制更新ROI显示
 void ProcessingWidget::updateROIDisplay()
 {
+    updateROIMask();
+    
     if (m_roiOverlay && !m_currentImage.isNull() && imageLabel) {
         // 获取实际图像显示区域
         QRect actualImageRect = getScaledImageRect();
@@ -2015,10 +2094,47 @@ void ProcessingWidget::updateROIDisplay()
                                m_imageSecondCircleRadius, m_multiCircleState,
                                m_handleSelected, m_selectedDirection, m_selectedCircleIndex);
         
+        // 掩码缩放到显示尺寸后交给覆盖层，显示的区域与统计、导出的区域一致
+        m_roiOverlay->setROIMask(m_multiCircleState == MultiCircleState::RingROI && actualImageRect.isValid()
+                                     ? m_roiMask.resized(cv::Size(actualImageRect.width(), actualImageRect.height()))
+                                     : RoiMask(),
+                                 actualImageRect.topLeft());
+        
         m_roiOverlay->update();
     }
 }
 
+// 按当前的ROI几何重建掩码，优先级与应用ROI时一致：矩形、环形、圆形、任意形状
+void ProcessingWidget::updateROIMask()
+{
+    if (m_currentImage.isNull()) {
+        m_roiMask = RoiMask();
+        return;
+    }
+    
+    const cv::Size bounds(m_currentImage.width(), m_currentImage.height());
+    if (!m_imageRectangleROI.isNull() && m_imageRectangleROI.width() > 0 && m_imageRectangleROI.height() > 0) {
+        m_roiMask = RoiMask::rect(cv::Rect(m_imageRectangleROI.x(), m_imageRectangleROI.y(),
+                                           m_imageRectangleROI.width(), m_imageRectangleROI.height()), bounds);
+    } else if (m_multiCircleState == MultiCircleState::RingROI) {
+        m_roiMask = RoiMask::ring(cv::Point(m_imageCircleCenter.x(), m_imageCircleCenter.y()), m_imageCircleRadius,
+                                  cv::Point(m_imageSecondCircleCenter.x(), m_imageSecondCircleCenter.y()),
+                                  m_imageSecondCircleRadius, bounds);
+    } else if (m_imageCircleRadius > 0) {
+        m_roiMask = RoiMask::circle(cv::Point(m_imageCircleCenter.x(), m_imageCircleCenter.y()),
+                                    m_imageCircleRadius, bounds);
+    } else if (m_imageArbitraryROI.size() > 2) {
+        std::vector<cv::Point> points;
+        points.reserve(m_imageArbitraryROI.size());
+        for (const QPoint &point : m_imageArbitraryROI) {
+            points.emplace_back(point.x(), point.y());
+        }
+        m_roiMask = RoiMask::polygon(points, bounds);
+    } else {
+        m_roiMask = RoiMask();
+    }
+}
+
 void ProcessingWidget::setROIMode(bool enableROI)
 {
     m_isROIMode = enableROI; 
@@ -2039,6 +2155,9 @@ void ProcessingWidget::resizeEvent(QResizeEvent *event)
     if (m_roiOverlay && imageLabel) {
         // 使覆盖层的大小与imageLabel一致
         m_roiOverlay->setGeometry(0, 0, imageLabel->width(), imageLabel->height());
+
+        // 按新的标签尺寸更新显示区域，分块视图只重新渲染可见的块
+        updateImageViewport();
         
         // 更新ROI显示
         updateROIDisplay();
@@ -2056,6 +2175,7 @@ void ProcessingWidget::calculateRingROI()
     
     // 设置状态为已完成环形ROI计算
     m_multiCircleState = MultiCircleState::RingROI;
+    updateROIMask();
     
     // 对于环形ROI，不再需要固定内外圆的概念
     // 我们允许两个圆之间有任意位置关系，只要能构成有效区域
@@ -2064,19 +2184,7 @@ void ProcessingWidget::calculateRingROI()
     qDebug() << "第一个圆 - 中心:" << m_imageCircleCenter << "半径:" << m_imageCircleRadius;
     qDebug() << "第二个圆 - 中心:" << m_imageSecondCircleCenter << "半径:" << m_imageSecondCircleRadius;
     
-    // 获取环形ROI中的像素值进行测试
-    QVector<int> pixelValues = getRingROIPixelValues();
-    qDebug() << "环形ROI包含" << pixelValues.size() << "个像素点";
-    
-    // 如果像素数量不太多，可以输出一些示例像素值
-    if (!pixelValues.isEmpty()) {
-        int sampleSize = qMin(10, pixelValues.size());
-        QStringList sampleValues;
-        for (int i = 0; i < sampleSize; ++i) {
-            sampleValues << QString::number(pixelValues[i]);
-        }
-        qDebug() << "像素值样本:" << sampleValues.join(", ");
-    }
+    qDebug() << "环形ROI包含" << getRingROIPixelCount() << "个像素点";
     
     // 环形ROI计算完成后，启用应用按钮
     if (btnApplyROI) {
@@ -2110,51 +2218,14 @@ bool ProcessingWidget::isPointInRingROI(const QPoint& point) const
     return (inCircle1 && !inCircle2) || (inCircle2 && !inCircle1);
 }
 
-// 实现获取环形ROI中像素值的方法
-QVector<int> ProcessingWidget::getRingROIPixelValues() const
+// 环形ROI的像素数：即环形掩码的面积
+qint64 ProcessingWidget::getRingROIPixelCount() const
 {
-    QVector<int> pixelValues;
-    
-    // 检查图像和环形ROI是否有效
-    if (m_currentImage.isNull() || 
-        m_imageCircleRadius <= 0 || 
-        m_imageSecondCircleRadius <= 0 ||
-        m_multiCircleState != MultiCircleState::RingROI) {
-        return pixelValues;
-    }
-    
-    // 确定环形区域的边界盒
-    int left = qMin(m_imageCircleCenter.x() - m_imageCircleRadius,
-                 m_imageSecondCircleCenter.x() - m_imageSecondCircleRadius);
-    int top = qMin(m_imageCircleCenter.y() - m_imageCircleRadius,
-                m_imageSecondCircleCenter.y() - m_imageSecondCircleRadius);
-    int right = qMax(m_imageCircleCenter.x() + m_imageCircleRadius,
-                 m_imageSecondCircleCenter.x() + m_imageSecondCircleRadius);
-    int bottom = qMax(m_imageCircleCenter.y() + m_imageCircleRadius,
-                 m_imageSecondCircleCenter.y() + m_imageSecondCircleRadius);
-    
-    // 确保边界盒在图像范围内
-    left = qMax(0, left);
-    top = qMax(0, top);
-    right = qMin(m_currentImage.width() - 1, right);
-    bottom = qMin(m_currentImage.height() - 1, bottom);
-    
-    // 遍历边界盒中的每个像素
-    for (int y = top; y <= bottom; ++y) {
-        for (int x = left; x <= right; ++x) {
-            QPoint pixelPos(x, y);
-            
-            // 检查像素是否在环形区域内
-            if (isPointInRingROI(pixelPos)) {
-                // 获取像素灰度值
-                QColor pixelColor = m_currentImage.pixelColor(x, y);
-                int grayValue = qGray(pixelColor.red(), pixelColor.green(), pixelColor.blue());
-                pixelValues.append(grayValue);
-            }
-        }
+    if (m_multiCircleState != MultiCircleState::RingROI) {
+        return 0;
     }
     
-    return pixelValues;
+    return m_roiMask.area();
 }
 
 // --- Implementation for Folder Selection and Navigation ---
@@ -2189,10 +2260,11 @@ void ProcessingWidget::onSelectFolderClicked()
 
         if (foundFiles.isEmpty()) {
             m_currentImageIndex = -1;
+            m_prefetcher->clear();
             QMessageBox::information(this, tr("无图像"), tr("在选定文件夹中未找到支持的图像文件。"));
             // Optionally clear the display or show a placeholder
             if (imageLabel) {
-                imageLabel->clear(); 
+                imageLabel->clearImage();
             }
             m_currentImage = QImage(); // Clear current image data
         } else {
@@ -2213,6 +2285,9 @@ void ProcessingWidget::onSelectFolderClicked()
                 qDebug() << "  ...及其他" << (m_imageFiles.size() - 5) << "个文件";
             }
             
+            // 新文件夹的缓存从空开始，旧文件夹未完成的解码全部取消
+            m_prefetcher->setFiles(m_imageFiles);
+
             qDebug() << "准备加载第一张图像:" << m_imageFiles.first();
             m_currentImageIndex = 0;
             qDebug() << "设置当前图像索引:" << m_currentImageIndex;
@@ -2238,7 +2313,7 @@ void ProcessingWidget::onSelectFolderClicked()
     }
 }
 
-void ProcessingWidget::displayImageAtIndex(int index)
+void ProcessingWidget::displayImageAtIndex(int index, int direction)
 {
     try {
         if (index < 0 || index >= m_imageFiles.size()) {
@@ -2246,46 +2321,42 @@ void ProcessingWidget::displayImageAtIndex(int index)
             return;
         }
 
-        // 更新当前图像索引
+        // 更新当前图像索引，上一张图像未完成的渐进加载不再换入
         m_currentImageIndex = index;
+        m_pendingFullImagePath.clear();
         QString imagePath = m_imageFiles.at(index);
         qDebug() << "加载图像文件:" << imagePath << "索引:" << index << "/" << (m_imageFiles.size()-1);
         
-        // 使用QImageReader加载图像，更安全
-        QImageReader reader(imagePath);
-        
-        // 检查图像格式
-        QByteArray format = reader.format();
-        if (!format.isEmpty()) {
-            qDebug() << "图像格式:" << format;
-        }
-        
-        // 设置错误处理
-        reader.setDecideFormatFromContent(true);
-        
-        QImage newImage;
-        bool success = false;
+        QImage newImage = m_prefetcher->cachedImage(imagePath);
         
         try {
-            // 尝试读取图像
-            success = reader.read(&newImage);
-            
-            if (!success) {
-                qWarning() << "Error loading image:" << imagePath 
-                         << "Error:" << reader.errorString();
-                QMessageBox::warning(this, tr("加载失败"), 
-                                    tr("无法加载图像文件: %1\n错误: %2")
-                                    .arg(QFileInfo(imagePath).fileName())
-                                    .arg(reader.errorString()));
+            Metrics::count(newImage.isNull() ? "prefetch.miss" : "prefetch.hit");
+            if (!newImage.isNull()) {
+                qDebug() << "预取缓存命中:" << QFileInfo(imagePath).fileName();
+            } else if (m_progressiveLoading && displayReducedPreview(imagePath)) {
+                // 先显示预览，全分辨率图像以最高优先级在后台解码，完成后由imageReady换入
+                m_pendingFullImagePath = imagePath;
+                m_prefetcher->load(imagePath);
+                updateNavigationButtonsState();
+                m_prefetcher->prefetch(index, direction);
                 return;
-            }
-            
-            // 检查加载的图像是否有效
-            if (newImage.isNull()) {
-                qWarning() << "加载的图像为空";
-                QMessageBox::warning(this, tr("加载失败"), 
-                                    tr("加载的图像为空: %1").arg(QFileInfo(imagePath).fileName()));
+            } else if (m_prefetcher->isPending(imagePath)) {
+                // 后台已在解码：提高为最高优先级，完成后由imageReady换入，不在界面线程中重复解码
+                // 换入之前继续显示上一张图像，m_currentImage与显示的图像保持一致，坐标换算和像素读数仍然有效；
+                // 处理操作由ensureFullImage先换入新图像
+                qDebug() << "等待后台解码:" << QFileInfo(imagePath).fileName();
+                m_pendingFullImagePath = imagePath;
+                m_prefetcher->load(imagePath);
+                updateNavigationButtonsState();
+                m_prefetcher->prefetch(index, direction);
                 return;
+            } else {
+                // 未预取到时在界面线程中同步解码
+                newImage = decodeImageFile(imagePath);
+                if (newImage.isNull()) {
+                    return;
+                }
+                m_prefetcher->insert(imagePath, newImage);
             }
             
             // 显示加载的图像信息
@@ -2299,6 +2370,9 @@ void ProcessingWidget::displayImageAtIndex(int index)
             
             // 更新导航按钮状态
             updateNavigationButtonsState();
+
+            // 在后台预先解码浏览方向上的后续图像
+            m_prefetcher->prefetch(index, direction);
         }
         catch (const std::exception& e) {
             qWarning() << "加载图像时出现异常:" << e.what();
@@ -2318,6 +2392,114 @@ void ProcessingWidget::displayImageAtIndex(int index)
     }
 }
 
+QImage ProcessingWidget::decodeImageFile(const QString &imagePath)
+{
+    QString errorString;
+    QImage image = ImagePrefetcher::decode(imagePath, &errorString);
+    
+    if (!errorString.isEmpty()) {
+        qWarning() << "Error loading image:" << imagePath 
+                 << "Error:" << errorString;
+        QMessageBox::warning(this, tr("加载失败"), 
+                            tr("无法加载图像文件: %1\n错误: %2")
+                            .arg(QFileInfo(imagePath).fileName())
+                            .arg(errorString));
+        return QImage();
+    }
+    
+    // 检查加载的图像是否有效
+    if (image.isNull()) {
+        qWarning() << "加载的图像为空";
+        QMessageBox::warning(this, tr("加载失败"), 
+                            tr("加载的图像为空: %1").arg(QFileInfo(imagePath).fileName()));
+    }
+    return image;
+}
+
+bool ProcessingWidget::displayReducedPreview(const QString &imagePath)
+{
+    if (!imageLabel) {
+        return false;
+    }
+
+    QImageReader reader(imagePath);
+    reader.setDecideFormatFromContent(true);
+    const QSize fullSize = reader.size();
+    const QSize viewSize = displaySize();
+    // JPEG等格式可在解码时按1/2、1/4、1/8缩小，只解码需要的分辨率；其余格式缩小解码并不更快
+    if (!reader.supportsOption(QImageIOHandler::ScaledSize) || !fullSize.isValid() || viewSize.isEmpty()) {
+        return false;
+    }
+    if (fullSize.width() < 2 * viewSize.width() && fullSize.height() < 2 * viewSize.height()) {
+        return false;
+    }
+
+    Metrics::ScopedTimer timer("decode.reducedPreview");
+    reader.setScaledSize(fullSize.scaled(viewSize, Qt::KeepAspectRatio));
+    QImage preview;
+    if (!reader.read(&preview) || preview.isNull()) {
+        return false;
+    }
+    timer.stop();
+    qDebug() << "渐进加载：先显示缩小预览" << preview.size() << "原图" << fullSize;
+
+    // 预览不是当前图像：坐标换算、像素读数和处理都等全分辨率图像换入后再进行
+    m_currentImage = QImage();
+    m_fitToLabel = true;
+    imageLabel->setImage(preview);
+    QRect rect(QPoint(0, 0), fullSize.scaled(imageLabel->size(), Qt::KeepAspectRatio));
+    rect.moveCenter(imageLabel->rect().center());
+    imageLabel->setDisplayRect(rect);
+    return true;
+}
+
+bool ProcessingWidget::ensureFullImage()
+{
+    if (m_pendingFullImagePath.isEmpty()) {
+        return !m_currentImage.isNull();
+    }
+
+    const QString imagePath = m_pendingFullImagePath;
+    m_pendingFullImagePath.clear();
+
+    QImage image = m_prefetcher->cachedImage(imagePath);
+    if (image.isNull()) {
+        // 后台尚未解码完成，在界面线程中解码，后台的请求随之取消
+        qDebug() << "渐进加载：等不及后台解码，同步解码" << imagePath;
+        image = decodeImageFile(imagePath);
+        if (image.isNull()) {
+            return false;
+        }
+        m_prefetcher->insert(imagePath, image);
+    }
+
+    qDebug() << "渐进加载：换入全分辨率图像" << image.size();
+    displayImage(image);
+    return !m_currentImage.isNull();
+}
+
+void ProcessingWidget::connectFullImageGate()
+{
+    // 同一信号的槽按连接顺序调用，这里先连接，MainWindow的处理槽执行时已是全分辨率图像
+    const auto gate = [this]() { ensureFullImage(); };
+    for (QPushButton *button : {btnShowOriginal, btnFlipH, btnFlipV, btnMeanFilter,
+                                btnGaussianFilter, btnMedianFilter, btnHistEqual}) {
+        if (button) {
+            connect(button, &QPushButton::clicked, this, gate);
+        }
+    }
+    for (QSlider *slider : {sliderBrightness, sliderGamma, sliderOffset}) {
+        if (slider) {
+            connect(slider, &QSlider::valueChanged, this, gate);
+        }
+    }
+    for (QCheckBox *checkBox : {m_rgbToGray, m_showHistogram, m_processInROI}) {
+        if (checkBox) {
+            connect(checkBox, &QCheckBox::stateChanged, this, gate);
+        }
+    }
+}
+
 void ProcessingWidget::onPrevImageClicked()
 {
     if (m_imageFiles.size() <= 1) return; // Nothing to navigate
@@ -2328,7 +2510,7 @@ void ProcessingWidget::onPrevImageClicked()
         m_currentImageIndex = m_imageFiles.size() - 1; // Wrap around to the end
     }
     qDebug() << "导航到前一张图像: 从索引" << previousIndex << "到" << m_currentImageIndex;
-    displayImageAtIndex(m_currentImageIndex);
+    displayImageAtIndex(m_currentImageIndex, -1);
 }
 
 void ProcessingWidget::onNextImageClicked()
@@ -2341,7 +2523,7 @@ void ProcessingWidget::onNextImageClicked()
         m_currentImageIndex = 0; // Wrap around to the beginning
     }
     qDebug() << "导航到下一张图像: 从索引" << previousIndex << "到" << m_currentImageIndex;
-    displayImageAtIndex(m_currentImageIndex);
+    displayImageAtIndex(m_currentImageIndex, 1);
 }
 
 void ProcessingWidget::updateNavigationButtonsState()
@@ -2358,7 +2540,7 @@ void ProcessingWidget::updateNavigationButtonsState()
 // --- New Slot for Saving Image ---
 void ProcessingWidget::onSaveClicked()
 {
-    if (m_currentImage.isNull()) {
+    if (!ensureFullImage()) {
         QMessageBox::warning(this, tr("无法保存"), tr("没有可保存的图像。"));
         return;
     }
@@ -2495,6 +2677,7 @@ void ProcessingWidget::mouseMoveEvent(QMouseEvent *event)
                     m_rectangleROI = QRect(m_selectionStart, m_selectionCurrent).normalized();
                     // 转换为图像坐标
                     m_imageRectangleROI = mapToImageRect(m_rectangleROI);
+                    emit roiChanging(m_imageRectangleROI);
                     break;
                     
                 case ROISelectionMode::Circle: {
@@ -2663,11 +2846,8 @@ void ProcessingWidget::mouseReleaseEvent(QMouseEvent *event)
                         // 计算环形ROI
                         calculateRingROI();
                         
-                        // 获取环形ROI中的像素
-                        QVector<int> pixels = getRingROIPixelValues();
-                        
-                        // 检查是否有有效像素
-                        if (pixels.isEmpty()) {
+                        // 检查环形ROI中是否有有效像素
+                        if (getRingROIPixelCount() == 0) {
                             // 环形区域中没有有效像素
                             QMessageBox::warning(this, tr("无效的环形区域"), 
                                                tr("环形区域中没有找到有效像素，请重新选择两个圆"),
@@ -2755,12 +2935,9 @@ void ProcessingWidget::wheelEvent(QWheelEvent *event)
             
             // Update image display with new zoom factor
             if (!m_currentImage.isNull() && imageLabel) {
-                QPixmap pixmap = QPixmap::fromImage(m_currentImage);
-                QSize scaledSize = pixmap.size() * m_zoomFactor;
-                
-                // Maintain aspect ratio
-                pixmap = pixmap.scaled(scaledSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                imageLabel->setPixmap(pixmap);
+                // 分块视图从金字塔中最接近缩放比例的层渲染可见的块
+                m_fitToLabel = false;
+                updateImageViewport();
                 
                 // Update ROI display with new zoom
                 updateROIDisplay();
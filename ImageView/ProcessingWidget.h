@@ -8,6 +8,7 @@
 #include <QSpinBox>
 #include <QApplication>
 #include "../ImageProcessor/ImageProcessor.h"
+#include "../ImageProcessor/RoiMask.h"
 #include <QPoint>
 #include <QVector>
 #include <QPolygon>
@@ -30,9 +31,12 @@ class QHBoxLayout;
 class QVBoxLayout;
 class QFrame;
 class QSpinBox;
+class QDoubleSpinBox;
 class QButtonGroup;
 class QToolButton;
 class ROIOverlay;  // 添加ROIOverlay前置声明
+class TiledImageView;
+class ImagePrefetcher;
 
 // 定义ROI选择模式枚举
 enum class ROISelectionMode {
@@ -87,18 +91,34 @@ public:
     
     QCheckBox* getRgbToGrayCheckBox() const { return m_rgbToGray; }
     QCheckBox* getShowHistogramCheckbox() const { return m_showHistogram; }
+    QCheckBox* getProcessInROICheckBox() const { return m_processInROI; }
     QSpinBox* getKernelSizeSpinBox() const { return spinKernelSize; }
 
     // 获取复选框状态
     bool getSubtractFiltered() const { return m_subtractFiltered ? m_subtractFiltered->isChecked() : false; }
     bool getShowHistogram() const { return m_showHistogram ? m_showHistogram->isChecked() : false; }
+    bool getProcessInROI() const { return m_processInROI ? m_processInROI->isChecked() : false; }
     int getKernelSize() const { return spinKernelSize ? spinKernelSize->value() : 3; }
+    double getGaussianSigma() const;
+    // 高斯滤波使用的核大小：勾选“核大小由sigma决定”时为0
+    int getGaussianKernelSize() const;
 
     // 显示图片
     void displayImage(const QImage &image);
+    // 显示代理分辨率的预览图片：只更新画面，不改变当前图像，也不发出imageChanged
+    void displayPreviewImage(const QImage &image);
+    // 图像显示区域的大小，预览图像不需要超过这个尺寸
+    QSize displaySize() const;
     
     // 获取当前显示的图像
     QImage getCurrentImage() const { return m_currentImage; }
+
+    // 渐进加载：浏览文件夹时先按视图尺寸缩小解码并显示，全分辨率图像在后台解码后替换
+    void setProgressiveLoading(bool enabled) { m_progressiveLoading = enabled; }
+    bool isProgressiveLoading() const { return m_progressiveLoading; }
+    // 当前只显示了缩小预览时立即换入全分辨率图像（后台尚未解码完成则同步解码），
+    // 处理、保存和ROI操作之前调用；没有可用图像时返回false
+    bool ensureFullImage();
     
     // 重置标签显示
     void resetValueLabels();
@@ -120,8 +140,11 @@ public:
     int getSecondCircleRadius() const { return m_imageSecondCircleRadius; }
     MultiCircleState getMultiCircleState() const { return m_multiCircleState; }
     
-    // 新增：获取环形ROI中的像素值
-    QVector<int> getRingROIPixelValues() const;
+    // 获取环形ROI中的像素数
+    qint64 getRingROIPixelCount() const;
+    
+    // 当前ROI的掩码（图像坐标），ROI几何变化时重建，统计和导出与显示使用同一份
+    const RoiMask& getROIMask() const { return m_roiMask; }
 
 signals:
     void mouseClicked(const QPoint& pos, int grayValue, int r, int g, int b);
@@ -132,6 +155,7 @@ signals:
     void roiSelected(const QRect& rect); // Signal for rectangle ROI
     void roiSelected(const QPoint& center, int radius); // Signal for circle ROI
     void roiSelected(const QPolygon& polygon); // Signal for arbitrary ROI
+    void roiChanging(const QRect& rect);       // 拖动矩形ROI时实时发送（图像坐标）
     
     // 新增：图像变化信号
     void imageChanged(const QImage& image);
@@ -175,6 +199,8 @@ private:
     QRect mapToImageRect(const QRect& uiRect);
     QRect mapFromImageRect(const QRect& imageRect);
     void updateROIDisplay();
+    void updateROIMask();        // 按当前的ROI几何重建掩码
+    void updateImageViewport();  // 按显示模式更新分块视图的显示区域
     
     // 新增：计算环形ROI区域
     void calculateRingROI();
@@ -183,7 +209,14 @@ private:
     bool isPointInRingROI(const QPoint& point) const;
 
     // Add these helper function declarations:
-    void displayImageAtIndex(int index);
+    // direction为浏览方向（1下一张，-1上一张，0直接跳转），决定预取的优先顺序
+    void displayImageAtIndex(int index, int direction = 0);
+    // 同步解码图像文件，失败时提示错误并返回空图像
+    QImage decodeImageFile(const QString &imagePath);
+    // 格式支持解码时缩小且原图明显大于视图时，按视图尺寸解码并只更新画面，成功返回true
+    bool displayReducedPreview(const QString &imagePath);
+    // 在处理控件的信号上先换入全分辨率图像，须在MainWindow连接这些信号之前调用
+    void connectFullImageGate();
     void updateNavigationButtonsState();
 
     // 缩放相关
@@ -191,6 +224,7 @@ private:
     const double ZOOM_FACTOR_STEP = 0.1;
     const double MIN_ZOOM = 0.1;
     const double MAX_ZOOM = 5.0;
+    bool m_fitToLabel = true;  // 当前显示是否为适应标签尺寸（非滚轮缩放）
 
     // 左侧按钮
     QPushButton *btnSelect;
@@ -207,6 +241,8 @@ private:
     QCheckBox *m_rgbToGray;        // RGB转灰度复选框
     QCheckBox *m_showHistogram;    // 显示灰度直方图复选框
     QSpinBox *spinKernelSize;      // 卷积核大小控制
+    QDoubleSpinBox *m_spinSigma;   // 高斯滤波sigma控制
+    QCheckBox *m_gaussianKernelFromSigma;  // 高斯滤波的核大小由sigma决定
 
     // ROI选择相关控件
     QGroupBox *gbROISelection;     // ROI选择组
@@ -217,6 +253,7 @@ private:
     QToolButton *btnClearSelection; // 清除选择按钮
     QPushButton *btnApplyROI; // 应用ROI按钮
     QPushButton *btnRectangleROI; // 矩形ROI按钮
+    QCheckBox *m_processInROI = nullptr; // 仅在ROI内处理复选框
     ROIOverlay *m_roiOverlay;      // ROI覆盖层
     
     // ROI选择状态 (UI坐标)
@@ -245,6 +282,8 @@ private:
     QPoint m_imageSecondCircleCenter;  // 第二个圆的中心
     int m_imageSecondCircleRadius = 0; // 第二个圆的半径
     
+    RoiMask m_roiMask;                 // 当前ROI的掩码（图像坐标）
+    
     // 控制鼠标响应的全局变量
     bool m_isROIMode = false; // false表示显示坐标模式，true表示ROI选择模式
     
@@ -275,7 +314,7 @@ private:
     // 中间
     QTabWidget    *tabWidget;
     QGraphicsView *graphicsView;
-    QLabel        *imageLabel;
+    TiledImageView *imageLabel;  // 分块显示图像，保留QLabel的外观和事件
 
     // 右侧
     QGroupBox *gbBasic;
@@ -296,6 +335,9 @@ private:
     QPushButton* btnNextImage = nullptr;
     QStringList m_imageFiles;
     int m_currentImageIndex = -1; // -1 indicates no folder loaded
+    ImagePrefetcher *m_prefetcher = nullptr;  // 文件夹浏览时在后台预先解码前后的图像
+    bool m_progressiveLoading = true;
+    QString m_pendingFullImagePath;            // 等待全分辨率图像的文件（显示的是缩小预览或上一张图像）
     QString m_lastSaveFolder;
 
     // 新增：计算UI和图像坐标转换
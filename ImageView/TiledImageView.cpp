@@ -0,0 +1,158 @@
+#include "TiledImageView.h"
+#include "ImagePyramid.h"
+#include "../ImageProcessor/Metrics.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QDebug>
+
+TiledImageView::TiledImageView(QWidget *parent)
+    : QLabel(parent)
+    , m_pyramid(new ImagePyramid(this))
+{
+    // 默认最多缓存128MB的块
+    m_tiles.setMaxCost(128 * 1024);
+}
+
+TiledImageView::~TiledImageView() = default;
+
+void TiledImageView::setImage(const QImage &image)
+{
+    m_image = image;
+    m_tiles.clear();
+    m_pyramid->setImage(image);
+    update();
+}
+
+void TiledImageView::clearImage()
+{
+    m_image = QImage();
+    m_displayRect = QRect();
+    m_tiles.clear();
+    m_pyramid->clear();
+    QLabel::clear();
+    update();
+}
+
+bool TiledImageView::hasImage() const
+{
+    return !m_image.isNull();
+}
+
+const QImage& TiledImageView::image() const
+{
+    return m_image;
+}
+
+ImagePyramid* TiledImageView::pyramid() const
+{
+    return m_pyramid;
+}
+
+void TiledImageView::setDisplayRect(const QRect &rect)
+{
+    if (rect == m_displayRect) {
+        return;
+    }
+    // 只有显示尺寸变化才需要新的块，位置变化直接复用
+    m_displayRect = rect;
+    update();
+}
+
+QRect TiledImageView::displayRect() const
+{
+    return m_displayRect;
+}
+
+void TiledImageView::setTileCacheSize(int kilobytes)
+{
+    m_tiles.setMaxCost(kilobytes);
+}
+
+int TiledImageView::tileCacheSize() const
+{
+    return m_tiles.maxCost();
+}
+
+void TiledImageView::paintEvent(QPaintEvent *event)
+{
+    // 背景、边框由QLabel绘制
+    QLabel::paintEvent(event);
+
+    if (m_image.isNull() || m_displayRect.isEmpty()) {
+        return;
+    }
+
+    const QRect visible = m_displayRect.intersected(event->rect()).intersected(contentsRect());
+    if (visible.isEmpty()) {
+        return;
+    }
+    Metrics::ScopedTimer timer("render.paint");
+
+    // 可见区域覆盖的块的行列范围
+    const QRect local = visible.translated(-m_displayRect.topLeft());
+    const int firstColumn = local.left() / TILE_SIZE;
+    const int lastColumn = local.right() / TILE_SIZE;
+    const int firstRow = local.top() / TILE_SIZE;
+    const int lastRow = local.bottom() / TILE_SIZE;
+
+    QPainter painter(this);
+    painter.setClipRect(visible);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            const QRect tileRect = QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE)
+                                       .intersected(QRect(QPoint(0, 0), m_displayRect.size()));
+            if (tileRect.isEmpty()) {
+                continue;
+            }
+
+            const TileKey key{m_displayRect.width(), m_displayRect.height(), column, row};
+            QPixmap *tile = m_tiles.object(key);
+            if (!tile) {
+                QPixmap rendered = renderTile(tileRect);
+                if (rendered.isNull()) {
+                    continue;
+                }
+                const int cost = qMax(1, rendered.width() * rendered.height() * rendered.depth() / 8 / 1024);
+                tile = new QPixmap(rendered);
+                if (!m_tiles.insert(key, tile, cost)) {
+                    // 单块超过缓存上限时不缓存，直接绘制
+                    painter.drawPixmap(tileRect.topLeft() + m_displayRect.topLeft(), rendered);
+                    continue;
+                }
+            }
+            painter.drawPixmap(tileRect.topLeft() + m_displayRect.topLeft(), *tile);
+        }
+    }
+    timer.stop();
+}
+
+QPixmap TiledImageView::renderTile(const QRect &tileRect) const
+{
+    Metrics::ScopedTimer timer("render.tile");
+    // 选取不小于当前显示尺寸的最小一层，缩小倍数不超过2
+    const QImage &level = m_pyramid->level(m_pyramid->levelIndexFor(m_displayRect.size()));
+    const double scaleX = static_cast<double>(level.width()) / m_displayRect.width();
+    const double scaleY = static_cast<double>(level.height()) / m_displayRect.height();
+
+    const QRectF source(tileRect.x() * scaleX, tileRect.y() * scaleY,
+                        tileRect.width() * scaleX, tileRect.height() * scaleY);
+    const QRect aligned = source.toAlignedRect().intersected(level.rect());
+    if (aligned.isEmpty()) {
+        return QPixmap();
+    }
+
+    // 先复制块对应的小区域，避免绘制时转换整层图像的格式
+    const QImage part = level.copy(aligned);
+    QImage tile(tileRect.size(), QImage::Format_ARGB32_Premultiplied);
+    tile.fill(Qt::transparent);
+
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(QRectF(QPointF(0, 0), QSizeF(tileRect.size())), part,
+                      source.translated(-aligned.topLeft()));
+    painter.end();
+
+    QPixmap pixmap = QPixmap::fromImage(tile);
+    timer.stop();
+    return pixmap;
+}
@@ -0,0 +1,72 @@
+#ifndef TILEDIMAGEVIEW_H
+#define TILEDIMAGEVIEW_H
+
+#include <QLabel>
+#include <QImage>
+#include <QPixmap>
+#include <QCache>
+#include <QHash>
+
+class ImagePyramid;
+
+// 分块显示的图像视图，用于替代整幅QPixmap的QLabel显示方式
+// 图像按显示尺寸划分为固定大小的块，只渲染和上传可见的块，
+// 每块从金字塔中最接近当前缩放的层生成，并缓存在有上限的LRU缓存中
+// 继承QLabel以保留边框、背景和鼠标跟踪等现有行为，坐标换算仍由ProcessingWidget负责
+class TiledImageView : public QLabel
+{
+    Q_OBJECT
+public:
+    explicit TiledImageView(QWidget *parent = nullptr);
+    ~TiledImageView() override;
+
+    // 设置显示的图像（隐式共享，不复制像素），清空块缓存
+    void setImage(const QImage &image);
+    void clearImage();
+    bool hasImage() const;
+    const QImage& image() const;
+    ImagePyramid* pyramid() const;
+
+    // 整幅图像在本控件坐标中的显示区域，决定缩放比例和位置
+    void setDisplayRect(const QRect &rect);
+    QRect displayRect() const;
+
+    // 块缓存上限（KB）
+    void setTileCacheSize(int kilobytes);
+    int tileCacheSize() const;
+
+    static const int TILE_SIZE = 256;  // 块的边长（显示像素）
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    // 块的键：显示尺寸确定缩放级别，行列确定位置
+    struct TileKey {
+        int displayWidth;
+        int displayHeight;
+        int column;
+        int row;
+
+        bool operator==(const TileKey &other) const
+        {
+            return displayWidth == other.displayWidth && displayHeight == other.displayHeight
+                && column == other.column && row == other.row;
+        }
+    };
+    friend uint qHash(const TileKey &key, uint seed)
+    {
+        return qHash(key.displayWidth, seed) ^ qHash(key.displayHeight, seed + 1)
+             ^ qHash(key.column, seed + 2) ^ qHash(key.row, seed + 3);
+    }
+
+    // 渲染一块：tileRect为块在显示图像中的位置（以显示图像左上角为原点）
+    QPixmap renderTile(const QRect &tileRect) const;
+
+    QImage m_image;
+    ImagePyramid *m_pyramid;
+    QRect m_displayRect;
+    QCache<TileKey, QPixmap> m_tiles;
+};
+
+#endif // TILEDIMAGEVIEW_H
@@ -0,0 +1,142 @@
+#include "MetricsPanel.h"
+#include "ImageProcessor/Metrics.h"
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QJsonDocument>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QDebug>
+
+MetricsPanel::MetricsPanel(QWidget *parent)
+    : QDockWidget(tr("性能统计"), parent)
+    , m_latencyTable(nullptr)
+    , m_counterTable(nullptr)
+    , m_enabledCheckBox(nullptr)
+    , m_refreshTimer(new QTimer(this))
+{
+    setObjectName("MetricsPanel");
+    setupUi();
+
+    m_refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &MetricsPanel::refresh);
+    connect(this, &QDockWidget::visibilityChanged, this, &MetricsPanel::onVisibilityChanged);
+}
+
+void MetricsPanel::setupUi()
+{
+    auto *content = new QWidget(this);
+    auto *mainLayout = new QVBoxLayout(content);
+    mainLayout->setContentsMargins(6, 6, 6, 6);
+
+    // 耗时表：单位为毫秒，分位数由对数分桶的直方图估计
+    m_latencyTable = new QTableWidget(0, 8, content);
+    m_latencyTable->setHorizontalHeaderLabels({tr("操作"), tr("次数"), tr("平均"), tr("p50"),
+                                               tr("p95"), tr("p99"), tr("最大"), tr("总计")});
+    m_latencyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_latencyTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_latencyTable->verticalHeader()->setVisible(false);
+    m_latencyTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_latencyTable->setSortingEnabled(true);
+    mainLayout->addWidget(new QLabel(tr("耗时（毫秒）"), content));
+    mainLayout->addWidget(m_latencyTable, 3);
+
+    m_counterTable = new QTableWidget(0, 2, content);
+    m_counterTable->setHorizontalHeaderLabels({tr("计数器"), tr("值")});
+    m_counterTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_counterTable->verticalHeader()->setVisible(false);
+    m_counterTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    mainLayout->addWidget(new QLabel(tr("计数器"), content));
+    mainLayout->addWidget(m_counterTable, 1);
+
+    auto *buttonLayout = new QHBoxLayout();
+    m_enabledCheckBox = new QCheckBox(tr("记录"), content);
+    m_enabledCheckBox->setChecked(Metrics::isEnabled());
+    connect(m_enabledCheckBox, &QCheckBox::toggled, this, [](bool checked) { Metrics::setEnabled(checked); });
+    auto *resetButton = new QPushButton(tr("清空"), content);
+    connect(resetButton, &QPushButton::clicked, this, &MetricsPanel::onReset);
+    auto *exportButton = new QPushButton(tr("导出JSON..."), content);
+    connect(exportButton, &QPushButton::clicked, this, &MetricsPanel::onExport);
+    buttonLayout->addWidget(m_enabledCheckBox);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(resetButton);
+    buttonLayout->addWidget(exportButton);
+    mainLayout->addLayout(buttonLayout);
+
+    setWidget(content);
+}
+
+void MetricsPanel::refresh()
+{
+    const QVector<Metrics::Latency> latencies = Metrics::latencies();
+
+    // 填充时关闭排序，否则每设置一格都会重新排序
+    m_latencyTable->setSortingEnabled(false);
+    m_latencyTable->setRowCount(latencies.size());
+    for (int row = 0; row < latencies.size(); ++row) {
+        const Metrics::Latency &latency = latencies.at(row);
+        const double values[] = {latency.meanMs(), latency.p50Ms, latency.p95Ms,
+                                 latency.p99Ms, latency.maxMs, latency.totalMs};
+
+        m_latencyTable->setItem(row, 0, new QTableWidgetItem(latency.operation));
+        auto *countItem = new QTableWidgetItem();
+        countItem->setData(Qt::DisplayRole, static_cast<qlonglong>(latency.count));
+        m_latencyTable->setItem(row, 1, countItem);
+        for (int i = 0; i < 6; ++i) {
+            // 按数值排序，显示保留两位小数
+            auto *item = new QTableWidgetItem();
+            item->setData(Qt::DisplayRole, qRound(values[i] * 100.0) / 100.0);
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_latencyTable->setItem(row, 2 + i, item);
+        }
+    }
+    m_latencyTable->setSortingEnabled(true);
+
+    const QVector<Metrics::Counter> counters = Metrics::counters();
+    m_counterTable->setRowCount(counters.size());
+    for (int row = 0; row < counters.size(); ++row) {
+        m_counterTable->setItem(row, 0, new QTableWidgetItem(counters.at(row).name));
+        auto *item = new QTableWidgetItem();
+        item->setData(Qt::DisplayRole, static_cast<qlonglong>(counters.at(row).value));
+        m_counterTable->setItem(row, 1, item);
+    }
+}
+
+void MetricsPanel::onReset()
+{
+    Metrics::reset();
+    refresh();
+}
+
+void MetricsPanel::onExport()
+{
+    const QString filePath = QFileDialog::getSaveFileName(this, tr("导出性能统计"), "metrics.json",
+                                                          tr("性能统计 (*.json)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    const QByteArray json = QJsonDocument(Metrics::toJson()).toJson();
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+        QMessageBox::warning(this, tr("导出失败"), tr("无法写入文件: %1").arg(file.errorString()));
+        return;
+    }
+    qDebug() << "性能统计已导出:" << filePath;
+}
+
+void MetricsPanel::onVisibilityChanged(bool visible)
+{
+    if (visible) {
+        refresh();
+        m_refreshTimer->start();
+    } else {
+        m_refreshTimer->stop();
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef METRICSPANEL_H
+#define METRICSPANEL_H
+
+#include <QDockWidget>
+
+class QCheckBox;
+class QTableWidget;
+class QTimer;
+
+// 性能统计面板：各操作的次数与耗时分位数（p50/p95/p99）以及计数器，可导出为JSON文件
+// 只在面板可见时定时刷新，隐藏时不占用界面线程
+class MetricsPanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsPanel(QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+
+private slots:
+    void onReset();
+    void onExport();
+    void onVisibilityChanged(bool visible);
+
+private:
+    void setupUi();
+
+    QTableWidget *m_latencyTable;
+    QTableWidget *m_counterTable;
+    QCheckBox *m_enabledCheckBox;
+    QTimer *m_refreshTimer;
+
+    static const int REFRESH_INTERVAL_MS = 1000;
+};
+
+#endif // METRICSPANEL_H
@@ -4,9 +4,8 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
-# OpenCV 配置
-INCLUDEPATH += E:/C++/QIImageProcess/3rdparty/opencv/include
-LIBS += -LE:/C++/QIImageProcess/3rdparty/opencv/lib -lopencv_world490
+# 图像处理核心库（含OpenCV配置），与命令行工具共用；从QIImageProcessAll.pro构建
+include(ImageCore.pri)
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -14,16 +13,30 @@ LIBS += -LE:/C++/QIImageProcess/3rdparty/opencv/lib -lopencv_world490
 
 SOURCES += \
     HistogramDialog.cpp \
+    MetricsPanel.cpp \
+    ImageProcessor/ImageMatAdapter.cpp \
     ImageProcessor/ImageProcessor.cpp \
+    ImageProcessor/ImageStatisticsCache.cpp \
+    ImageProcessor/ProcessingJobExecutor.cpp \
+    ImageView/ImagePrefetcher.cpp \
+    ImageView/ImagePyramid.cpp \
     ImageView/ProcessingWidget.cpp \
+    ImageView/TiledImageView.cpp \
     ImageView/ImageProcessorThread.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
     HistogramDialog.h \
+    MetricsPanel.h \
+    ImageProcessor/ImageMatAdapter.h \
     ImageProcessor/ImageProcessor.h \
+    ImageProcessor/ImageStatisticsCache.h \
+    ImageProcessor/ProcessingJobExecutor.h \
+    ImageView/ImagePrefetcher.h \
+    ImageView/ImagePyramid.h \
     ImageView/ProcessingWidget.h \
+    ImageView/TiledImageView.h \
     ImageView/ImageProcessorThread.h \
     mainwindow.h
 
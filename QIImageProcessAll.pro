@@ -0,0 +1,19 @@
+# 顶层工程：核心库、界面程序、命令行工具和基准测试，从这里打开即可按依赖顺序构建全部目标
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    core \
+    app \
+    batch \
+    bench
+
+core.file = ImageCore/ImageCore.pro
+
+app.file = QIImageProcess.pro
+app.depends = core
+
+batch.file = tools/QIImageBatch/QIImageBatch.pro
+batch.depends = core
+
+bench.file = tools/QIImageBench/QIImageBench.pro
+bench.depends = core
@@ -1,5 +1,8 @@
 #include "mainwindow.h"
+#include "ImageProcessor/TraceRecorder.h"
 #include <QApplication>
+#include <QEvent>
+#include <QThread>
 #include <QFile>
 #include <QTextStream>
 #include <QDateTime>
@@ -36,6 +39,42 @@ void messageHandler(QtMsgType type, const QMessageLogContext &context, const QSt
     }
 }
 
+// 跟踪启用时记录界面线程中每个事件的分发，与后台线程的事件对照定位界面卡顿
+class TracingApplication : public QApplication
+{
+public:
+    using QApplication::QApplication;
+
+    bool notify(QObject *receiver, QEvent *event) override
+    {
+        if (!TraceRecorder::isEnabled() || QThread::currentThread() != thread()) {
+            return QApplication::notify(receiver, event);
+        }
+        TraceRecorder::Scope scope(eventName(event->type()));
+        return QApplication::notify(receiver, event);
+    }
+
+private:
+    static const char* eventName(QEvent::Type type)
+    {
+        switch (type) {
+        case QEvent::Paint: return "gui.paint";
+        case QEvent::UpdateRequest: return "gui.updateRequest";
+        case QEvent::Resize: return "gui.resize";
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+        case QEvent::MouseMove: return "gui.mouse";
+        case QEvent::Wheel: return "gui.wheel";
+        case QEvent::KeyPress:
+        case QEvent::KeyRelease: return "gui.key";
+        case QEvent::Timer: return "gui.timer";
+        case QEvent::MetaCall: return "gui.queuedCall";
+        default: return "gui.event";
+        }
+    }
+};
+
 int main(int argc, char *argv[])
 {
     try {
@@ -47,9 +86,15 @@ int main(int argc, char *argv[])
         qDebug() << "Application starting...";
         qDebug() << "Log file: " << logFileName;
 
-        QApplication a(argc, argv);
+        TracingApplication a(argc, argv);
         qDebug() << "QApplication created";
 
+        // --trace：从启动开始记录跟踪，用于分析启动过程
+        TraceRecorder::setThreadName("GUI");
+        if (a.arguments().contains("--trace")) {
+            TraceRecorder::setEnabled(true);
+        }
+
         MainWindow w;
         qDebug() << "MainWindow created";
         
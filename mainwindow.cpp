@@ -1,7 +1,12 @@
 #include "mainwindow.h"
 #include "ImageView/ProcessingWidget.h"
 #include "HistogramDialog.h"
+#include "ImageProcessor/ImageMatAdapter.h"
+#include "ImageProcessor/TraceRecorder.h"
 #include <QMenuBar>
+#include <QAction>
+#include <QJsonDocument>
+#include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QPushButton>
@@ -11,8 +16,6 @@
 #include <QDebug>
 #include <QTimer>
 #include <QSignalBlocker>
-#include <QPainter>
-#include <QPainterPath>
 #include <cmath>   // For fabs() function 
 #include <QColor>  // For QColor
 #include <algorithm> // For qMax, qMin
@@ -27,6 +30,8 @@ MainWindow::MainWindow(QWidget *parent)
     , m_pixelInfoLabel(nullptr)
     , m_meanValueLabel(nullptr)
     , m_histogramDialog(nullptr)
+    , m_metricsPanel(nullptr)
+    , m_previewSettleTimer(nullptr)
 {
     try {
         qDebug() << "Initializing MainWindow...";
@@ -51,6 +56,13 @@ MainWindow::MainWindow(QWidget *parent)
         }
         qDebug() << "HistogramDialog created";
 
+        m_metricsPanel = new MetricsPanel(this);
+
+        // 拖动滑块时先显示代理分辨率预览，参数停止变化一段时间后再计算全分辨率结果
+        m_previewSettleTimer = new QTimer(this);
+        m_previewSettleTimer->setSingleShot(true);
+        m_previewSettleTimer->setInterval(200);
+
         m_statusLabel = new QLabel(this);
         m_pixelInfoLabel = new QLabel(this);
         m_meanValueLabel = new QLabel(this);
@@ -97,7 +109,7 @@ void MainWindow::calculateROIStats(const QImage& image, const QRect& roi, double
     variance = 0.0;
     
     // Input validation
-    if (image.isNull() || roi.isEmpty()) {
+    if (image.isNull() || roi.isEmpty() || !imageProcessor) {
         qDebug() << "Invalid image or ROI in calculateROIStats";
         return;
     }
@@ -109,108 +121,26 @@ void MainWindow::calculateROIStats(const QImage& image, const QRect& roi, double
         return;
     }
     
-    // Calculate sum and pixel count
-    double sum = 0.0;
-    int pixelCount = 0;
-    
-    for (int y = validRect.top(); y <= validRect.bottom(); ++y) {
-        for (int x = validRect.left(); x <= validRect.right(); ++x) {
-            QColor pixelColor = image.pixelColor(x, y);
-            int grayValue = qGray(pixelColor.red(), pixelColor.green(), pixelColor.blue());
-            sum += grayValue;
-            pixelCount++;
-        }
-    }
-    
-    // Calculate mean
-    if (pixelCount > 0) {
-        mean = sum / pixelCount;
-        
-        // Calculate variance
-        double sumSquaredDiff = 0.0;
-        for (int y = validRect.top(); y <= validRect.bottom(); ++y) {
-            for (int x = validRect.left(); x <= validRect.right(); ++x) {
-                QColor pixelColor = image.pixelColor(x, y);
-                int grayValue = qGray(pixelColor.red(), pixelColor.green(), pixelColor.blue());
-                double diff = grayValue - mean;
-                sumSquaredDiff += diff * diff;
-            }
-        }
-        
-        variance = sumSquaredDiff / pixelCount;
-    }
-}
-
-// 计算圆形ROI的统计信息
-void MainWindow::calculateCircleROIStats(const QImage& image, const QPoint& center, int radius, double& mean, double& variance)
-{
-    // Initialize return values
-    mean = 0.0;
-    variance = 0.0;
-    
-    // Input validation
-    if (image.isNull() || radius <= 0) {
-        qDebug() << "Invalid image or radius in calculateCircleROIStats";
-        return;
-    }
-    
-    // Calculate sum and pixel count
-    double sum = 0.0;
-    int pixelCount = 0;
-    
-    // Circle bounding box
-    int left = qMax(0, center.x() - radius);
-    int top = qMax(0, center.y() - radius);
-    int right = qMin(image.width() - 1, center.x() + radius);
-    int bottom = qMin(image.height() - 1, center.y() + radius);
-    
-    // Loop through each pixel in the bounding box
-    for (int y = top; y <= bottom; ++y) {
-        for (int x = left; x <= right; ++x) {
-            // Check if the point is inside the circle
-            int dx = x - center.x();
-            int dy = y - center.y();
-            int distanceSquared = dx*dx + dy*dy;
-            
-            if (distanceSquared <= radius*radius) {
-                // Point is inside the circle
-                QColor pixelColor = image.pixelColor(x, y);
-                int grayValue = qGray(pixelColor.red(), pixelColor.green(), pixelColor.blue());
-                sum += grayValue;
-                pixelCount++;
-            }
-        }
-    }
-    
-    // Calculate mean
-    if (pixelCount > 0) {
-        mean = sum / pixelCount;
-        
-        // Calculate variance
-        double sumSquaredDiff = 0.0;
-        for (int y = top; y <= bottom; ++y) {
-            for (int x = left; x <= right; ++x) {
-                // Check again if the point is inside the circle
-                int dx = x - center.x();
-                int dy = y - center.y();
-                int distanceSquared = dx*dx + dy*dy;
-                
-                if (distanceSquared <= radius*radius) {
-                    QColor pixelColor = image.pixelColor(x, y);
-                    int grayValue = qGray(pixelColor.red(), pixelColor.green(), pixelColor.blue());
-                    double diff = grayValue - mean;
-                    sumSquaredDiff += diff * diff;
-                }
-            }
-        }
+    try {
+        // 积分图只在图像变化后建立一次，矩形的和与平方和只需读取四个角
+        const SummedAreaTable &table = imageProcessor->summedAreaTable(image);
+        const SummedAreaTable::Moments moments =
+            table.rect(cv::Rect(validRect.x(), validRect.y(), validRect.width(), validRect.height()));
         
-        variance = sumSquaredDiff / pixelCount;
+        // 16位灰度图的统计量换算到0-255
+        const double scale = image.depth() == 16 ? 255.0 / 65535.0 : 1.0;
+        mean = moments.mean() * scale;
+        variance = moments.variance() * scale * scale;
+    } catch (const std::exception& e) {
+        qDebug() << "计算矩形ROI统计信息时出错:" << e.what();
     }
 }
 
 void MainWindow::setupUI()
 {
     setCentralWidget(m_processingWidget);
+    addDockWidget(Qt::RightDockWidgetArea, m_metricsPanel);
+    m_metricsPanel->hide();
     resize(1024, 768);
 }
 
@@ -249,11 +179,24 @@ void MainWindow::setupConnections()
     if (m_processingWidget->getMedianFilterButton()) {
         connect(m_processingWidget->getMedianFilterButton(), &QPushButton::clicked, this, &MainWindow::onMedianFilter);
     }
+    if (m_processingWidget->getHistEqualButton()) {
+        connect(m_processingWidget->getHistEqualButton(), &QPushButton::clicked, this, &MainWindow::onHistEqualClicked);
+    }
 
     // 连接RGB转灰度复选框
     if (m_processingWidget->getRgbToGrayCheckBox()) {
         connect(m_processingWidget->getRgbToGrayCheckBox(), &QCheckBox::stateChanged, this, &MainWindow::onRgbToGrayChanged);
     }
+    
+    // 连接仅在ROI内处理复选框：切换后灰度模式下重新计算管线
+    if (m_processingWidget->getProcessInROICheckBox()) {
+        connect(m_processingWidget->getProcessInROICheckBox(), &QCheckBox::stateChanged, this, [this]() {
+            updateProcessingROI();
+            if (m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
+                applyCurrentTransformations();
+            }
+        });
+    }
 
     // 连接滑块信号
     if (m_processingWidget->getBrightnessSlider()) {
@@ -266,6 +209,16 @@ void MainWindow::setupConnections()
         connect(m_processingWidget->getOffsetSlider(), &QSlider::valueChanged, this, &MainWindow::onOffsetChanged);
     }
     
+    // 松开滑块时立即计算全分辨率结果
+    for (QSlider *slider : {m_processingWidget->getBrightnessSlider(),
+                            m_processingWidget->getGammaSlider(),
+                            m_processingWidget->getOffsetSlider()}) {
+        if (slider) {
+            connect(slider, &QSlider::sliderReleased, this, &MainWindow::onSliderReleased);
+        }
+    }
+    connect(m_previewSettleTimer, &QTimer::timeout, this, [this]() { applyCurrentTransformations(); });
+
     // 连接卷积核大小变化信号
     if (m_processingWidget->getKernelSizeSpinBox()) {
         // 将ProcessingWidget的kernelSizeChanged信号连接到ImageProcessor的setKernelSize
@@ -276,6 +229,10 @@ void MainWindow::setupConnections()
     // 连接图像处理信号
     connect(imageProcessor, &ImageProcessor::imageLoaded, this, &MainWindow::onImageLoaded);
     connect(imageProcessor, &ImageProcessor::imageProcessed, this, &MainWindow::onImageProcessed);
+    connect(imageProcessor, &ImageProcessor::previewReady, m_processingWidget, &ProcessingWidget::displayPreviewImage);
+    connect(imageProcessor, &ImageProcessor::processingProgress, this, [this](int percent) {
+        m_statusLabel->setText(percent < 100 ? tr("处理中 %1%").arg(percent) : tr("就绪"));
+    });
     connect(imageProcessor, &ImageProcessor::error, this, &MainWindow::onError);
     
     // 连接鼠标信号
@@ -295,6 +252,8 @@ void MainWindow::setupConnections()
     // 连接ROI选择信号
     connect(m_processingWidget, QOverload<const QRect&>::of(&ProcessingWidget::roiSelected), 
             this, &MainWindow::onRectangleROISelected);
+    connect(m_processingWidget, &ProcessingWidget::roiChanging,
+            this, &MainWindow::onRectangleROIChanging);
     connect(m_processingWidget, QOverload<const QPoint&, int>::of(&ProcessingWidget::roiSelected), 
             this, &MainWindow::onCircleROISelected);
     connect(m_processingWidget, QOverload<const QPolygon&>::of(&ProcessingWidget::roiSelected), 
@@ -318,11 +277,23 @@ void MainWindow::setupConnections()
 
 void MainWindow::createMenuBar()
 {
-    menuBar()->addMenu(tr("文件(&F)"));
-    menuBar()->addMenu(tr("滤镜(&L)"));
+    QMenu *fileMenu = menuBar()->addMenu(tr("文件(&F)"));
+    fileMenu->addAction(tr("导出处理流程(&E)..."), this, &MainWindow::onExportPipeline);
+    // 灰度模式下滤波和直方图均衡化是管线中的阶段，在这里清除
+    QMenu *filterMenu = menuBar()->addMenu(tr("滤镜(&L)"));
+    filterMenu->addAction(tr("清除滤波(&F)"), this, &MainWindow::onClearFilterStage);
+    filterMenu->addAction(tr("清除直方图均衡化(&E)"), this, &MainWindow::onClearEqualizeStage);
     menuBar()->addMenu(tr("关于(&A)"));
     menuBar()->addMenu(tr("帮助(&H)"));
-    menuBar()->addMenu(tr("工具(&T)"));
+    QMenu *toolsMenu = menuBar()->addMenu(tr("工具(&T)"));
+    QAction *metricsAction = m_metricsPanel->toggleViewAction();
+    metricsAction->setText(tr("性能统计(&M)"));
+    toolsMenu->addAction(metricsAction);
+    toolsMenu->addSeparator();
+    QAction *traceAction = toolsMenu->addAction(tr("记录跟踪(&R)"), this, &MainWindow::onTraceToggled);
+    traceAction->setCheckable(true);
+    traceAction->setChecked(TraceRecorder::isEnabled());
+    toolsMenu->addAction(tr("导出跟踪(&X)..."), this, &MainWindow::onExportTrace);
     addToolBar(tr("工具栏"));
 }
 
@@ -421,10 +392,23 @@ void MainWindow::onMeanFilter()
         qDebug() << "Before Mean Filter:";
         imageProcessor->debugImageInfo();
         
+        updateProcessingROI();
         bool subtractFiltered = m_processingWidget ? m_processingWidget->getSubtractFiltered() : false;
         int kernelSize = m_processingWidget ? m_processingWidget->getKernelSize() : 3;
         qDebug() << "Applying Mean Filter with kernel size " << kernelSize << ", subtractFiltered =" << subtractFiltered;
-        imageProcessor->applyMeanFilter(kernelSize, subtractFiltered);
+        if (m_processingWidget && m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
+            // 灰度模式下作为管线的滤波阶段，之后调整滑块不会丢失滤波结果
+            // 管线只有一个滤波阶段，新的滤波替换之前的滤波，可从“滤镜”菜单清除
+            if (!imageProcessor->validateFilterKernel(OperationGraph::FilterMean, kernelSize)) {
+                return;
+            }
+            imageProcessor->setPipelineStage(OperationGraph::StageFilter,
+                                             {static_cast<int>(OperationGraph::FilterMean), kernelSize, 0.0, subtractFiltered});
+            applyCurrentTransformations();
+        } else {
+            // 滤波在后台线程中执行，结果通过imageProcessed信号显示
+            imageProcessor->applyFilterAsync(OperationGraph::FilterMean, kernelSize, 1.0, subtractFiltered);
+        }
         
         qDebug() << "After Mean Filter:";
         imageProcessor->debugImageInfo();
@@ -450,10 +434,24 @@ void MainWindow::onGaussianFilter()
         qDebug() << "Before Gaussian Filter:";
         imageProcessor->debugImageInfo();
         
+        updateProcessingROI();
         bool subtractFiltered = m_processingWidget ? m_processingWidget->getSubtractFiltered() : false;
-        int kernelSize = m_processingWidget ? m_processingWidget->getKernelSize() : 3;
-        qDebug() << "Applying Gaussian Filter with kernel size " << kernelSize << ", sigma=1.0, subtractFiltered =" << subtractFiltered;
-        imageProcessor->applyGaussianFilter(kernelSize, 1.0, subtractFiltered);
+        int kernelSize = m_processingWidget ? m_processingWidget->getGaussianKernelSize() : 3;
+        double sigma = m_processingWidget ? m_processingWidget->getGaussianSigma() : 1.0;
+        qDebug() << "Applying Gaussian Filter with kernel size " << kernelSize << ", sigma =" << sigma << ", subtractFiltered =" << subtractFiltered;
+        if (m_processingWidget && m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
+            // 灰度模式下作为管线的滤波阶段，之后调整滑块不会丢失滤波结果
+            // 管线只有一个滤波阶段，新的滤波替换之前的滤波，可从“滤镜”菜单清除
+            if (!imageProcessor->validateFilterKernel(OperationGraph::FilterGaussian, kernelSize)) {
+                return;
+            }
+            imageProcessor->setPipelineStage(OperationGraph::StageFilter,
+                                             {static_cast<int>(OperationGraph::FilterGaussian), kernelSize, sigma, subtractFiltered});
+            applyCurrentTransformations();
+        } else {
+            // 滤波在后台线程中执行，结果通过imageProcessed信号显示
+            imageProcessor->applyFilterAsync(OperationGraph::FilterGaussian, kernelSize, sigma, subtractFiltered);
+        }
         
         qDebug() << "After Gaussian Filter:";
         imageProcessor->debugImageInfo();
@@ -479,10 +477,23 @@ void MainWindow::onMedianFilter()
         qDebug() << "Before Median Filter:";
         imageProcessor->debugImageInfo();
         
+        updateProcessingROI();
         bool subtractFiltered = m_processingWidget ? m_processingWidget->getSubtractFiltered() : false;
         int kernelSize = m_processingWidget ? m_processingWidget->getKernelSize() : 3;
         qDebug() << "Applying Median Filter with kernel size " << kernelSize << ", subtractFiltered =" << subtractFiltered;
-        imageProcessor->applyMedianFilter(kernelSize, subtractFiltered);
+        if (m_processingWidget && m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
+            // 灰度模式下作为管线的滤波阶段，之后调整滑块不会丢失滤波结果
+            // 管线只有一个滤波阶段，新的滤波替换之前的滤波，可从“滤镜”菜单清除
+            if (!imageProcessor->validateFilterKernel(OperationGraph::FilterMedian, kernelSize)) {
+                return;
+            }
+            imageProcessor->setPipelineStage(OperationGraph::StageFilter,
+                                             {static_cast<int>(OperationGraph::FilterMedian), kernelSize, 0.0, subtractFiltered});
+            applyCurrentTransformations();
+        } else {
+            // 滤波在后台线程中执行，结果通过imageProcessed信号显示
+            imageProcessor->applyFilterAsync(OperationGraph::FilterMedian, kernelSize, 1.0, subtractFiltered);
+        }
         
         qDebug() << "After Median Filter:";
         imageProcessor->debugImageInfo();
@@ -498,27 +509,15 @@ void MainWindow::onMedianFilter()
 
 void MainWindow::onBrightnessChanged(int value)
 {
-    // 如果RGB转灰度复选框被勾选，应用变换到原始灰度图
+    // 如果RGB转灰度复选框被勾选，通过处理管线只重算受影响的阶段
     if (m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
-        // 恢复到原始灰度图
-        imageProcessor->restoreGrayscaleImage();
-        
-        // 获取当前偏移量b的值
-        int offsetValue = m_processingWidget->getOffsetSlider()->value();
-        
-        // 应用线性变换
-        imageProcessor->applyLinearTransform(value, offsetValue);
-        
-        // 获取当前的Gamma值，如果需要，应用Gamma校正
-        double gamma = m_processingWidget->getGammaSlider()->value() / 10.0;
-        if (fabs(gamma - 1.0) > 0.01) {
-            imageProcessor->adjustGammaContrast(gamma, 0);
-        }
-        
-        m_processingWidget->displayImage(imageProcessor->getProcessedImage());
+        // 显示和直方图更新由imageProcessed信号完成，拖动过程中先显示预览
+        applyCurrentTransformations(isSliderDragging());
+        return;
     } else {
         // 正常应用线性变换
         int offsetValue = m_processingWidget->getOffsetSlider()->value();
+        updateProcessingROI();
         imageProcessor->applyLinearTransform(value, offsetValue);
         m_processingWidget->displayImage(imageProcessor->getProcessedImage());
     }
@@ -584,29 +583,16 @@ void MainWindow::updateImageStats(double meanValue)
 
 void MainWindow::onGammaChanged(int value)
 {
-    // 如果RGB转灰度复选框被勾选，应用变换到原始灰度图
+    // 如果RGB转灰度复选框被勾选，通过处理管线只重算受影响的阶段
     if (m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
-        // 恢复到原始灰度图
-        imageProcessor->restoreGrayscaleImage();
-        
-        // 获取当前线性变换参数
-        int brightnessValue = m_processingWidget->getBrightnessSlider()->value();
-        int offsetValue = m_processingWidget->getOffsetSlider()->value();
-        
-        // 如果有线性变换，先应用线性变换
-        if (brightnessValue != 0 || offsetValue != 0) {
-            imageProcessor->applyLinearTransform(brightnessValue, offsetValue);
-        }
-        
-        // 应用Gamma校正
-        double gamma = value / 10.0;
-        imageProcessor->adjustGammaContrast(gamma, 0);
-        
-        m_processingWidget->displayImage(imageProcessor->getProcessedImage());
+        // 显示和直方图更新由imageProcessed信号完成，拖动过程中先显示预览
+        applyCurrentTransformations(isSliderDragging());
+        return;
     } else {
         // 正常应用Gamma校正
         double gamma = value / 10.0;
         int offset = m_processingWidget->getOffsetSlider()->value();
+        updateProcessingROI();
         imageProcessor->adjustGammaContrast(gamma, offset);
         m_processingWidget->displayImage(imageProcessor->getProcessedImage());
     }
@@ -617,27 +603,15 @@ void MainWindow::onGammaChanged(int value)
 
 void MainWindow::onOffsetChanged(int value)
 {
-    // 如果RGB转灰度复选框被勾选，应用变换到原始灰度图
+    // 如果RGB转灰度复选框被勾选，通过处理管线只重算受影响的阶段
     if (m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
-        // 恢复到原始灰度图
-        imageProcessor->restoreGrayscaleImage();
-        
-        // 获取当前系数k的滑块值
-        int brightnessValue = m_processingWidget->getBrightnessSlider()->value();
-        
-        // 应用线性变换
-        imageProcessor->applyLinearTransform(brightnessValue, value);
-        
-        // 获取当前的Gamma值，如果需要，应用Gamma校正
-        double gamma = m_processingWidget->getGammaSlider()->value() / 10.0;
-        if (fabs(gamma - 1.0) > 0.01) {
-            imageProcessor->adjustGammaContrast(gamma, 0);
-        }
-        
-        m_processingWidget->displayImage(imageProcessor->getProcessedImage());
+        // 显示和直方图更新由imageProcessed信号完成，拖动过程中先显示预览
+        applyCurrentTransformations(isSliderDragging());
+        return;
     } else {
         // 正常应用线性变换
         int brightnessValue = m_processingWidget->getBrightnessSlider()->value();
+        updateProcessingROI();
         imageProcessor->applyLinearTransform(brightnessValue, value);
         m_processingWidget->displayImage(imageProcessor->getProcessedImage());
     }
@@ -677,9 +651,11 @@ void MainWindow::onRgbToGrayChanged(bool checked)
                 imageProcessor->convertToGrayscale();
                 qDebug() << "保存灰度图像状态...";
                 imageProcessor->saveGrayscaleImage();
+                imageProcessor->resetPipeline();
             } else {
                 // 恢复到原始图像
                 qDebug() << "恢复到原始图像...";
+                imageProcessor->resetPipeline();
                 imageProcessor->resetToOriginal();
             }
             
@@ -710,10 +686,32 @@ void MainWindow::onRgbToGrayChanged(bool checked)
 
 void MainWindow::onHistEqualClicked()
 {
+    if (m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
+        // 灰度模式下作为管线的最后一个阶段
+        imageProcessor->setPipelineStage(OperationGraph::StageEqualize);
+        applyCurrentTransformations();
+        return;
+    }
     imageProcessor->applyHistogramEqualization();
     m_processingWidget->displayImage(imageProcessor->getProcessedImage());
 }
 
+void MainWindow::onClearFilterStage()
+{
+    imageProcessor->disablePipelineStage(OperationGraph::StageFilter);
+    if (m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
+        applyCurrentTransformations();
+    }
+}
+
+void MainWindow::onClearEqualizeStage()
+{
+    imageProcessor->disablePipelineStage(OperationGraph::StageEqualize);
+    if (m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
+        applyCurrentTransformations();
+    }
+}
+
 void MainWindow::onHistogramCalculated(const QVector<int> &histogram)
 {
     // TODO: Implement histogram visualization
@@ -771,30 +769,69 @@ void MainWindow::onConvertToGrayscale()
 }
 
 // 应用所有当前的变换（在勾选RGB转灰度时使用）
-void MainWindow::applyCurrentTransformations()
+void MainWindow::applyCurrentTransformations(bool interactive)
 {
-    // 恢复到原始灰度图
-    imageProcessor->restoreGrayscaleImage();
+    // 管线从灰度基准图开始：灰度 -> 滤波 -> 线性变换 -> Gamma -> 均衡化
+    // 参数未变化的阶段直接复用缓存，只重算下游
+    updateProcessingROI();
+    imageProcessor->setPipelineStage(OperationGraph::StageGrayscale);
     
     // 获取当前的线性变换参数
     int brightnessValue = m_processingWidget->getBrightnessSlider()->value();
     int offsetValue = m_processingWidget->getOffsetSlider()->value();
     
-    // 如果需要，应用线性变换
+    // 如果需要，启用线性变换阶段
     if (brightnessValue != 0 || offsetValue != 0) {
-        imageProcessor->applyLinearTransform(brightnessValue, offsetValue);
+        imageProcessor->setPipelineStage(OperationGraph::StageLinear, {brightnessValue, offsetValue});
+    } else {
+        imageProcessor->disablePipelineStage(OperationGraph::StageLinear);
     }
     
     // 获取当前的Gamma校正参数
     double gamma = m_processingWidget->getGammaSlider()->value() / 10.0;
     
-    // 如果需要，应用Gamma校正（Gamma不等于1.0时才需要）
+    // 如果需要，启用Gamma校正阶段（Gamma不等于1.0时才需要）
     if (fabs(gamma - 1.0) > 0.01) {
-        imageProcessor->adjustGammaContrast(gamma, 0);
+        imageProcessor->setPipelineStage(OperationGraph::StageGamma, {gamma, 0});
+    } else {
+        imageProcessor->disablePipelineStage(OperationGraph::StageGamma);
     }
     
-    // 显示处理后的图像
-    m_processingWidget->displayImage(imageProcessor->getProcessedImage());
+    if (interactive) {
+        // 拖动过程中只在显示尺寸的代理图像上计算，结果通过previewReady信号显示
+        imageProcessor->renderPipelinePreviewAsync(m_processingWidget->displaySize());
+        m_previewSettleTimer->start();
+        return;
+    }
+
+    // 在后台计算全分辨率管线输出，未完成的旧请求被新请求取代
+    // 结果通过imageProcessed信号显示
+    m_previewSettleTimer->stop();
+    imageProcessor->renderPipelineAsync();
+}
+
+// 同步处理范围：勾选“仅在ROI内处理”时使用当前ROI的掩码，否则处理整幅图像
+void MainWindow::updateProcessingROI()
+{
+    if (!imageProcessor || !m_processingWidget) {
+        return;
+    }
+    imageProcessor->setProcessingROI(m_processingWidget->getProcessInROI() ? m_processingWidget->getROIMask()
+                                                                          : RoiMask());
+}
+
+bool MainWindow::isSliderDragging() const
+{
+    return m_processingWidget->getBrightnessSlider()->isSliderDown()
+        || m_processingWidget->getGammaSlider()->isSliderDown()
+        || m_processingWidget->getOffsetSlider()->isSliderDown();
+}
+
+void MainWindow::onSliderReleased()
+{
+    if (m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
+        applyCurrentTransformations();
+    }
 }
 
 void MainWindow::onMouseMoved(const QPoint &pos, int grayValue)
@@ -826,7 +863,9 @@ void MainWindow::onShowHistogramChanged(bool show)
                 if (m_processingWidget && m_processingWidget->getRgbToGrayCheckBox() && 
                     m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
                     // 确保使用灰度图像版本
-                    QImage grayImage = currentImage.convertToFormat(QImage::Format_Grayscale8);
+                    // 16位灰度图直接统计，不压缩到8位
+                    QImage grayImage = currentImage.format() == QImage::Format_Grayscale16
+                        ? currentImage : currentImage.convertToFormat(QImage::Format_Grayscale8);
                     m_histogramDialog->updateHistogram(grayImage);
                     qDebug() << "显示灰度直方图：使用灰度图像版本";
                 } else {
@@ -861,7 +900,9 @@ void MainWindow::updateHistogramDialog()
                 if (m_processingWidget && m_processingWidget->getRgbToGrayCheckBox() && 
                     m_processingWidget->getRgbToGrayCheckBox()->isChecked()) {
                     // 转换为灰度图像
-                    QImage grayImage = currentImage.convertToFormat(QImage::Format_Grayscale8);
+                    // 16位灰度图直接统计，不压缩到8位
+                    QImage grayImage = currentImage.format() == QImage::Format_Grayscale16
+                        ? currentImage : currentImage.convertToFormat(QImage::Format_Grayscale8);
                     m_histogramDialog->updateHistogram(grayImage);
                     qDebug() << "更新直方图：使用灰度图像";
                 } else {
@@ -894,6 +935,20 @@ void MainWindow::onRectangleROISelected(const QRect& rect)
     // QImage roiImage = imageProcessor->getProcessedImage().copy(rect);
 }
 
+void MainWindow::onRectangleROIChanging(const QRect& rect)
+{
+    // 积分图建立后每次只需常数时间，可以随鼠标移动更新
+    double mean = 0.0, variance = 0.0;
+    calculateROIStats(m_processingWidget->getCurrentImage(), rect, mean, variance);
+    m_pixelInfoLabel->setText(QString("矩形ROI (像素坐标): 左上(%1, %2), 宽高(%3 × %4) | 均值: %5, 方差: %6")
+        .arg(rect.x())
+        .arg(rect.y())
+        .arg(rect.width())
+        .arg(rect.height())
+        .arg(mean, 0, 'f', 2)
+        .arg(variance, 0, 'f', 2));
+}
+
 void MainWindow::onCircleROISelected(const QPoint& center, int radius)
 {
     // 更新状态栏信息
@@ -951,6 +1006,9 @@ void MainWindow::onApplyROI()
     int secondCircleRadius = m_processingWidget->getSecondCircleRadius();
     MultiCircleState multiCircleState = m_processingWidget->getMultiCircleState();
     
+    // 圆形、环形和任意形状ROI的统计与导出都使用ProcessingWidget中按当前几何构建的掩码
+    const RoiMask roiMask = m_processingWidget->getROIMask();
+    
     // 总是优先使用ProcessingWidget的当前图像，这样可以确保在文件夹浏览模式下使用正确的图像
     QImage processedImage = m_processingWidget->getCurrentImage();
     
@@ -994,46 +1052,8 @@ void MainWindow::onApplyROI()
                         .arg(variance, 0, 'f', 2);
     }
     else if (multiCircleState == MultiCircleState::RingROI) {
-        // 环形ROI - 创建一个与原图像尺寸相同的透明图像
-        roiImage = QImage(processedImage.size(), QImage::Format_ARGB32_Premultiplied);
-        roiImage.fill(Qt::transparent);
-        
-        // 创建一个绘制器
-        QPainter painter(&roiImage);
-        painter.setRenderHint(QPainter::Antialiasing, true);
-        
-        // 创建环形ROI路径 - 两个圆的差集
-        QPainterPath path1, path2;
-        path1.addEllipse(firstCircleCenter, firstCircleRadius, firstCircleRadius);
-        path2.addEllipse(secondCircleCenter, secondCircleRadius, secondCircleRadius);
-        
-        // 根据两个圆的情况选择差集方向
-        QPainterPath ringPath;
-        if (firstCircleRadius >= secondCircleRadius) {
-            // 大圆减小圆
-            ringPath = path1.subtracted(path2);
-        } else {
-            // 小圆减大圆
-            ringPath = path2.subtracted(path1);
-        }
-        
-        // 设置剪裁区域为环形
-        painter.setClipPath(ringPath);
-        
-        // 绘制原图像到剪裁区域
-        painter.drawImage(0, 0, processedImage);
-        painter.end();
-        
-        // 计算环形区域的外接矩形
-        QRect boundingRect = ringPath.boundingRect().toRect();
-        
-        // 确保边界在图像内
-        boundingRect = boundingRect.intersected(processedImage.rect());
-        
-        // 裁剪到包围盒大小
-        if (!boundingRect.isEmpty()) {
-            roiImage = roiImage.copy(boundingRect);
-        }
+        // 环形ROI - 只复制掩码的包围盒，环以外的像素为透明
+        roiImage = maskedCopy(processedImage, roiMask);
         
         // 生成ROI信息
         roiInfo = QString("环形ROI区域(像素坐标):\n圆1: 中心(%1, %2), 半径%3\n圆2: 中心(%4, %5), 半径%6")
@@ -1047,10 +1067,7 @@ void MainWindow::onApplyROI()
         // 获取环形ROI区域的统计信息
         double mean = 0.0, variance = 0.0;
         int pixelCount = 0;
-        calculateRingROIStats(processedImage, 
-                             firstCircleCenter, firstCircleRadius,
-                             secondCircleCenter, secondCircleRadius,
-                             mean, variance, pixelCount);
+        calculateMaskStats(processedImage, roiMask, mean, variance, pixelCount);
         
         roiInfo += QString("\n\n区域统计信息:\n像素数量: %1\n均值: %2\n方差: %3")
                         .arg(pixelCount)
@@ -1058,27 +1075,8 @@ void MainWindow::onApplyROI()
                         .arg(variance, 0, 'f', 2);
     }
     else if (circleRadius > 0) {
-        // 圆形ROI - 创建一个与原图像尺寸相同的透明图像
-        roiImage = QImage(processedImage.size(), QImage::Format_ARGB32_Premultiplied);
-        roiImage.fill(Qt::transparent);
-        
-        // 创建一个绘制器
-        QPainter painter(&roiImage);
-        painter.setRenderHint(QPainter::Antialiasing, true);
-        
-        // 设置剪裁区域为圆形
-        QPainterPath path;
-        path.addEllipse(circleCenter, circleRadius, circleRadius);
-        painter.setClipPath(path);
-        
-        // 绘制原图像到剪裁区域
-        painter.drawImage(0, 0, processedImage);
-        painter.end();
-        
-        // 裁剪到包围盒大小
-        QRect boundingRect(circleCenter.x() - circleRadius, circleCenter.y() - circleRadius,
-                          circleRadius * 2, circleRadius * 2);
-        roiImage = roiImage.copy(boundingRect);
+        // 圆形ROI - 只复制掩码的包围盒，圆以外的像素为透明
+        roiImage = maskedCopy(processedImage, roiMask);
         
         // 生成ROI信息
         roiInfo = QString("圆形ROI区域(像素坐标):\n中心: (%1, %2)\n半径: %3")
@@ -1088,33 +1086,20 @@ void MainWindow::onApplyROI()
                         
         // 获取ROI区域的均值和方差
         double mean = 0.0, variance = 0.0;
-        calculateCircleROIStats(processedImage, circleCenter, circleRadius, mean, variance);
+        int pixelCount = 0;
+        calculateMaskStats(processedImage, roiMask, mean, variance, pixelCount);
         
-        roiInfo += QString("\n\n区域统计信息:\n均值: %1\n方差: %2")
+        roiInfo += QString("\n\n区域统计信息:\n像素数量: %1\n均值: %2\n方差: %3")
+                        .arg(pixelCount)
                         .arg(mean, 0, 'f', 2)
                         .arg(variance, 0, 'f', 2);
     }
     else if (arbitraryROI.size() > 2) {
-        // 任意形状ROI - 创建一个与原图像尺寸相同的透明图像
-        roiImage = QImage(processedImage.size(), QImage::Format_ARGB32_Premultiplied);
-        roiImage.fill(Qt::transparent);
-        
-        // 创建一个绘制器
-        QPainter painter(&roiImage);
-        painter.setRenderHint(QPainter::Antialiasing, true);
-        
-        // 设置剪裁区域为多边形
-        QPainterPath path;
-        path.addPolygon(arbitraryROI);
-        painter.setClipPath(path);
-        
-        // 绘制原图像到剪裁区域
-        painter.drawImage(0, 0, processedImage);
-        painter.end();
+        // 任意形状ROI - 只复制掩码的包围盒，多边形以外的像素为透明
+        roiImage = maskedCopy(processedImage, roiMask);
         
         // 计算多边形的包围盒
         QRect boundingRect = arbitraryROI.boundingRect();
-        roiImage = roiImage.copy(boundingRect);
         
         // 生成ROI信息
         roiInfo = QString("任意形状ROI区域(像素坐标):\n顶点数: %1\n包围盒: 左上(%2, %3), 宽高(%4 × %5)")
@@ -1124,8 +1109,15 @@ void MainWindow::onApplyROI()
                         .arg(boundingRect.width())
                         .arg(boundingRect.height());
                         
-        // 对于任意形状，统计信息暂不实现
-        roiInfo += "\n\n注意: 任意形状的统计信息暂不可用";
+        // 获取任意形状ROI区域的统计信息
+        double mean = 0.0, variance = 0.0;
+        int pixelCount = 0;
+        calculateMaskStats(processedImage, roiMask, mean, variance, pixelCount);
+        
+        roiInfo += QString("\n\n区域统计信息:\n像素数量: %1\n均值: %2\n方差: %3")
+                        .arg(pixelCount)
+                        .arg(mean, 0, 'f', 2)
+                        .arg(variance, 0, 'f', 2);
     }
     else {
         QMessageBox::warning(this, tr("无效的ROI"), tr("请先选择一个有效的ROI区域"), QMessageBox::Ok);
@@ -1158,84 +1150,49 @@ void MainWindow::onApplyROI()
     m_pixelInfoLabel->setText(tr("点击图像显示坐标和RGB值"));
 }
 
-// 计算环形ROI的统计信息
-void MainWindow::calculateRingROIStats(const QImage& image, 
-                                      const QPoint& firstCenter, int firstRadius,
-                                      const QPoint& secondCenter, int secondRadius,
-                                      double& mean, double& variance, int& pixelCount)
+// 计算掩码区域的统计信息：积分图逐段取和与平方和，一次完成，不保存像素值
+void MainWindow::calculateMaskStats(const QImage& image, const RoiMask& mask,
+                                   double& mean, double& variance, int& pixelCount)
 {
-    // 初始化返回值
     mean = 0.0;
     variance = 0.0;
     pixelCount = 0;
     
-    // 输入验证
-    if (image.isNull() || firstRadius <= 0 || secondRadius <= 0) {
-        qDebug() << "无效的图像或半径参数";
+    if (image.isNull() || mask.isEmpty() || !imageProcessor) {
         return;
     }
     
-    // 计算环形区域的边界盒
-    int left = qMin(firstCenter.x() - firstRadius, secondCenter.x() - secondRadius);
-    int top = qMin(firstCenter.y() - firstRadius, secondCenter.y() - secondRadius);
-    int right = qMax(firstCenter.x() + firstRadius, secondCenter.x() + secondRadius);
-    int bottom = qMax(firstCenter.y() + firstRadius, secondCenter.y() + secondRadius);
-    
-    // 确保边界盒在图像内
-    left = qMax(0, left);
-    top = qMax(0, top);
-    right = qMin(image.width() - 1, right);
-    bottom = qMin(image.height() - 1, bottom);
-    
-    // 计算总和和像素数量
-    double sum = 0.0;
-    QVector<int> grayValues;
-    
-    // 遍历边界盒中的每个像素
-    for (int y = top; y <= bottom; ++y) {
-        for (int x = left; x <= right; ++x) {
-            // 判断点到两个圆心的距离
-            int dx1 = x - firstCenter.x();
-            int dy1 = y - firstCenter.y();
-            double dist1 = sqrt(dx1*dx1 + dy1*dy1);
-            
-            int dx2 = x - secondCenter.x();
-            int dy2 = y - secondCenter.y();
-            double dist2 = sqrt(dx2*dx2 + dy2*dy2);
-            
-            // 判断点是否在环形区域内(在一个圆内但不在另一个圆内)
-            bool inCircle1 = (dist1 <= firstRadius);
-            bool inCircle2 = (dist2 <= secondRadius);
-            
-            if ((inCircle1 && !inCircle2) || (inCircle2 && !inCircle1)) {
-                // 点在环形区域内
-                QColor pixelColor = image.pixelColor(x, y);
-                int grayValue = qGray(pixelColor.red(), pixelColor.green(), pixelColor.blue());
-                sum += grayValue;
-                grayValues.append(grayValue);
-                pixelCount++;
-            }
-        }
-    }
-    
-    // 计算均值
-    if (pixelCount > 0) {
-        mean = sum / pixelCount;
-        
-        // 计算方差
-        double sumSquaredDiff = 0.0;
-        for (int grayValue : grayValues) {
-            double diff = grayValue - mean;
-            sumSquaredDiff += diff * diff;
-        }
+    try {
+        const SummedAreaTable::Moments moments = imageProcessor->summedAreaTable(image).spans(mask.spans());
         
-        variance = sumSquaredDiff / pixelCount;
+        // 16位灰度图的统计量换算到0-255
+        const double scale = image.depth() == 16 ? 255.0 / 65535.0 : 1.0;
+        mean = moments.mean() * scale;
+        variance = moments.variance() * scale * scale;
+        pixelCount = static_cast<int>(moments.count);
+    } catch (const std::exception& e) {
+        qDebug() << "计算ROI统计信息时出错:" << e.what();
     }
     
-    qDebug() << "环形ROI统计信息: 像素数量 =" << pixelCount 
+    qDebug() << "掩码ROI统计信息: 像素数量 =" << pixelCount 
              << ", 均值 =" << mean << ", 方差 =" << variance;
 }
 
+// 按掩码导出ROI：只复制掩码包围盒内的像素，ROI以外设为透明，不需要整幅图像大小的中间图像
+QImage MainWindow::maskedCopy(const QImage& image, const RoiMask& mask)
+{
+    const cv::Rect bounds = mask.boundingRect() & cv::Rect(0, 0, image.width(), image.height());
+    if (bounds.empty()) {
+        return QImage();
+    }
+    
+    QImage roiImage = image.copy(bounds.x, bounds.y, bounds.width, bounds.height)
+                           .convertToFormat(QImage::Format_ARGB32);
+    cv::Mat view = ImageMatAdapter::view(roiImage);
+    mask.clearOutside(view, bounds.tl());
+    return roiImage;
+}
+
 // 实现环形ROI选择处理函数
 void MainWindow::onRingROISelected(const QPoint& firstCenter, int firstRadius, 
                                  const QPoint& secondCenter, int secondRadius)
@@ -1265,3 +1222,52 @@ void MainWindow::onImageChanged(const QImage &image)
 }
 
 
+
+void MainWindow::onExportPipeline()
+{
+    if (!imageProcessor) {
+        return;
+    }
+
+    QString filePath = QFileDialog::getSaveFileName(this, tr("导出处理流程"), "pipeline.json",
+                                                    tr("处理流程 (*.json)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(QJsonDocument(imageProcessor->exportPipeline()).toJson()) < 0) {
+        QMessageBox::warning(this, tr("导出失败"), tr("无法写入文件: %1").arg(file.errorString()));
+        return;
+    }
+    qDebug() << "处理流程已导出:" << filePath;
+    m_statusLabel->setText(tr("处理流程已导出"));
+}
+
+void MainWindow::onTraceToggled(bool checked)
+{
+    // 重新开始记录时丢弃上一次的事件
+    if (checked) {
+        TraceRecorder::clear();
+    }
+    TraceRecorder::setEnabled(checked);
+    qDebug() << "跟踪记录" << (checked ? "开始" : "停止");
+}
+
+void MainWindow::onExportTrace()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, tr("导出跟踪"), "trace.json",
+                                                    tr("Chrome跟踪 (*.json)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QString errorString;
+    if (!TraceRecorder::writeChromeTrace(filePath, &errorString)) {
+        QMessageBox::warning(this, tr("导出失败"), tr("无法写入文件: %1").arg(errorString));
+        return;
+    }
+    qDebug() << "跟踪已导出:" << filePath;
+    m_statusLabel->setText(tr("跟踪已导出，可在about:tracing或Perfetto中打开"));
+}
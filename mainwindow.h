@@ -8,6 +8,9 @@
 #include "ImageView/ProcessingWidget.h"
 #include "ImageProcessor/ImageProcessor.h"
 #include "HistogramDialog.h"
+#include "MetricsPanel.h"
+
+class QTimer;
 
 class MainWindow : public QMainWindow
 {
@@ -47,11 +50,16 @@ private slots:
     void onHistogramEqualization();
     void onHistogramStretching();
     void onHistEqualClicked();
+    // 清除管线的滤波阶段和直方图均衡化阶段
+    void onClearFilterStage();
+    void onClearEqualizeStage();
     void onResetToOriginal();
     void onShowHistogramChanged(bool show);
+    void onSliderReleased();
     
     // ROI选择相关槽函数
     void onRectangleROISelected(const QRect& rect);
+    void onRectangleROIChanging(const QRect& rect);  // 拖动中实时显示矩形ROI的均值和方差
     void onCircleROISelected(const QPoint& center, int radius);
     void onArbitraryROISelected(const QPolygon& polygon);
     void onRingROISelected(const QPoint& firstCenter, int firstRadius, 
@@ -62,21 +70,28 @@ private slots:
     // 新增：处理图像变化的槽函数
     void onImageChanged(const QImage &image);
 
+    // 导出处理流程：保存当前管线的阶段配置，供批处理工具QIImageBatch使用
+    void onExportPipeline();
+
+    // 跟踪记录：开始/停止记录，导出为Chrome trace-event JSON
+    void onTraceToggled(bool checked);
+    void onExportTrace();
+
 private:
     void setupUI();
     void setupConnections();
     void createMenuBar();
     void setupStatusBar();
-    void applyCurrentTransformations();    // 应用当前所有变换
+    void applyCurrentTransformations(bool interactive = false);  // 应用当前所有变换，拖动中只计算预览
+    bool isSliderDragging() const;         // 是否有调整滑块正在被拖动
     void updateHistogramDialog();          // Update histogram dialog with current image
     
     // ROI统计计算函数
     void calculateROIStats(const QImage& image, const QRect& roi, double& mean, double& variance);
-    void calculateCircleROIStats(const QImage& image, const QPoint& center, int radius, double& mean, double& variance);
-    void calculateRingROIStats(const QImage& image, 
-                              const QPoint& firstCenter, int firstRadius,
-                              const QPoint& secondCenter, int secondRadius,
-                              double& mean, double& variance, int& pixelCount);
+    void calculateMaskStats(const QImage& image, const RoiMask& mask,
+                            double& mean, double& variance, int& pixelCount);
+    QImage maskedCopy(const QImage& image, const RoiMask& mask);
+    void updateProcessingROI();
 
     ProcessingWidget *m_processingWidget;
     ImageProcessor *imageProcessor;
@@ -84,6 +99,8 @@ private:
     QLabel *m_pixelInfoLabel;
     QLabel *m_meanValueLabel;
     HistogramDialog *m_histogramDialog;    // Histogram dialog
+    MetricsPanel *m_metricsPanel;          // 性能统计面板（停靠窗口，默认隐藏）
+    QTimer *m_previewSettleTimer;          // 参数停止变化后计算全分辨率结果
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,17 @@
+# 批处理命令行工具：对文件夹中的所有图像重放界面中导出的处理流程，不需要显示器
+QT       = core
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+
+TARGET = QIImageBatch
+
+# 只链接核心库，不依赖Widgets；从QIImageProcessAll.pro构建
+include(../../ImageCore.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
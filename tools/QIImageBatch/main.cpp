@@ -0,0 +1,168 @@
+// QIImageBatch：对文件夹中的所有图像重放处理流程
+// 处理流程文件由界面程序的“文件 -> 导出处理流程”生成
+//
+// 用法：QIImageBatch --pipeline pipeline.json [选项] <输入文件夹> <输出文件夹>
+// 返回值：0全部成功，1参数或处理流程错误，2部分文件失败，3被中断
+
+#include "ImageProcessor/BatchProcessor.h"
+#include "ImageProcessor/OperationGraph.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+
+static std::atomic<bool> interrupted(false);
+static bool verbose = false;
+
+static void onInterrupt(int)
+{
+    interrupted.store(true);
+}
+
+// 默认只输出警告和错误，--verbose时输出处理过程中的调试信息
+static void messageHandler(QtMsgType type, const QMessageLogContext &, const QString &msg)
+{
+    if (type == QtDebugMsg && !verbose) {
+        return;
+    }
+    fprintf(stderr, "%s\n", msg.toLocal8Bit().constData());
+}
+
+static void printLine(const QString &text)
+{
+    fprintf(stderr, "%s\n", text.toLocal8Bit().constData());
+}
+
+static int parsePositive(const QCommandLineParser &parser, const QCommandLineOption &option)
+{
+    if (!parser.isSet(option)) {
+        return 0;
+    }
+    bool ok = false;
+    const int value = parser.value(option).toInt(&ok);
+    if (!ok || value <= 0) {
+        throw std::invalid_argument(QStringLiteral("--%1 需要正整数").arg(option.names().constLast()).toStdString());
+    }
+    return value;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QIImageBatch");
+    qInstallMessageHandler(messageHandler);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("对文件夹中的所有图像重放处理流程（读取解码、处理、编码写入三级并行）"));
+    parser.addHelpOption();
+    parser.addPositionalArgument("input", QStringLiteral("输入文件夹"));
+    parser.addPositionalArgument("output", QStringLiteral("输出文件夹，按输入的相对路径写入"));
+
+    const QCommandLineOption pipelineOption({"p", "pipeline"}, QStringLiteral("处理流程文件（界面中导出）"), "file");
+    const QCommandLineOption formatOption({"f", "format"}, QStringLiteral("输出格式的扩展名，默认与输入相同"), "ext");
+    const QCommandLineOption recursiveOption({"r", "recursive"}, QStringLiteral("包括子文件夹"));
+    const QCommandLineOption decodeOption("decode-threads", QStringLiteral("读取解码线程数，默认为核数的1/4"), "n");
+    const QCommandLineOption processOption("process-threads", QStringLiteral("处理线程数，默认为核数的1/2"), "n");
+    const QCommandLineOption encodeOption("encode-threads", QStringLiteral("编码写入线程数，默认为核数的1/4"), "n");
+    const QCommandLineOption queueOption("queue", QStringLiteral("各级之间最多缓存的图像数，默认为处理线程数的2倍"), "n");
+    const QCommandLineOption verboseOption({"v", "verbose"}, QStringLiteral("输出调试信息"));
+    parser.addOptions({pipelineOption, formatOption, recursiveOption, decodeOption, processOption,
+                       encodeOption, queueOption, verboseOption});
+    parser.process(app);
+
+    verbose = parser.isSet(verboseOption);
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() != 2 || !parser.isSet(pipelineOption)) {
+        fprintf(stderr, "%s\n", parser.helpText().toLocal8Bit().constData());
+        return 1;
+    }
+
+    try {
+        const QString inputDir = QDir(positional.at(0)).absolutePath();
+        const QString outputDir = QDir(positional.at(1)).absolutePath();
+        if (!QFileInfo(inputDir).isDir()) {
+            printLine(QStringLiteral("输入文件夹不存在: %1").arg(inputDir));
+            return 1;
+        }
+
+        BatchProcessor::Options options;
+        options.decodeThreads = parsePositive(parser, decodeOption);
+        options.processThreads = parsePositive(parser, processOption);
+        options.encodeThreads = parsePositive(parser, encodeOption);
+        options.queueCapacity = parsePositive(parser, queueOption);
+        options.outputFormat = parser.value(formatOption);
+        if (!options.outputFormat.isEmpty() && !BatchProcessor::isSupportedImage("output." + options.outputFormat)) {
+            printLine(QStringLiteral("不支持的输出格式: %1").arg(options.outputFormat));
+            return 1;
+        }
+        // 输出到输入文件夹且不改格式会覆盖原图
+        if (QDir(inputDir) == QDir(outputDir) && options.outputFormat.isEmpty()) {
+            printLine(QStringLiteral("输出文件夹与输入文件夹相同，会覆盖原图，请指定其他输出文件夹"));
+            return 1;
+        }
+
+        // 读取处理流程
+        QFile pipelineFile(parser.value(pipelineOption));
+        if (!pipelineFile.open(QIODevice::ReadOnly)) {
+            printLine(QStringLiteral("无法打开处理流程文件: %1").arg(pipelineFile.errorString()));
+            return 1;
+        }
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(pipelineFile.readAll(), &parseError);
+        if (!document.isObject()) {
+            printLine(QStringLiteral("处理流程文件格式错误: %1").arg(parseError.errorString()));
+            return 1;
+        }
+        OperationGraph pipeline;
+        pipeline.setStagesFromJson(document.object());
+
+        const QStringList files = BatchProcessor::findImages(inputDir, parser.isSet(recursiveOption));
+        if (files.isEmpty()) {
+            printLine(QStringLiteral("输入文件夹中没有支持的图像文件"));
+            return 0;
+        }
+        printLine(QStringLiteral("共%1个文件").arg(files.size()));
+
+        // Ctrl+C时尽快停止：未写出的文件放弃，已写出的文件都是完整的
+        std::signal(SIGINT, onInterrupt);
+        std::atomic<int> lastPercent(-1);
+        TileScheduler::Control control;
+        control.cancelled = []() { return interrupted.load(); };
+        control.progress = [&lastPercent](int done, int total) {
+            const int percent = done * 100 / total;
+            if (lastPercent.exchange(percent) != percent) {
+                fprintf(stderr, "\r%3d%% (%d/%d)", percent, done, total);
+            }
+        };
+
+        BatchProcessor batch(pipeline, options);
+        const BatchProcessor::Result result = batch.run(files, inputDir, outputDir, control);
+        fprintf(stderr, "\n");
+
+        for (const QString &error : result.errors) {
+            printLine(error);
+        }
+        printLine(QStringLiteral("完成: 成功%1个，失败%2个，用时%3秒，%4张/秒")
+                      .arg(result.succeeded)
+                      .arg(result.failed)
+                      .arg(result.seconds, 0, 'f', 1)
+                      .arg(result.seconds > 0 ? result.succeeded / result.seconds : 0.0, 0, 'f', 1));
+
+        if (result.cancelled) {
+            printLine(QStringLiteral("已中断"));
+            return 3;
+        }
+        return result.failed > 0 ? 2 : 0;
+    } catch (const std::exception& e) {
+        printLine(QStringLiteral("错误: %1").arg(QString::fromUtf8(e.what())));
+        return 1;
+    }
+}
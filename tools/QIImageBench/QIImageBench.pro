@@ -0,0 +1,25 @@
+# 基准测试命令行工具：对合成图像逐项计时格式转换、滤波、点运算、直方图和ROI统计，结果以JSON输出；--verify时把滤波结果与OpenCV的参考实现比较
+# QImage与cv::Mat的转换需要QtGui，不依赖Widgets
+QT       = core gui
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+
+TARGET = QIImageBench
+
+# 链接核心库；从QIImageProcessAll.pro构建
+include(../../ImageCore.pri)
+
+SOURCES += \
+    main.cpp \
+    ../../ImageProcessor/ImageMatAdapter.cpp
+
+HEADERS += \
+    ../../ImageProcessor/ImageMatAdapter.h
+
+# 峰值内存（GetProcessMemoryInfo）
+win32: LIBS += -lpsapi
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
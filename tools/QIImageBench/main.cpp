@@ -0,0 +1,613 @@
+// QIImageBench：图像处理各阶段的基准测试，结果以JSON输出，用于跟踪各版本之间的性能变化
+// 输入为按固定种子生成的合成图像，相同参数每次得到相同的输入；每项先预热一次，再计时多次取中位数
+//
+// 用法：QIImageBench [选项]
+//       QIImageBench --verify   不计时，把中值、高斯和均值滤波的结果与OpenCV的参考实现逐像素比较
+// 返回值：0全部完成（--verify时全部一致），1参数错误，2部分测试项出错（错误记录在结果中），
+//         3 --verify发现与参考结果不一致
+
+#include "ImageProcessor/ConstantTimeMedian.h"
+#include "ImageProcessor/ImageMatAdapter.h"
+#include "ImageProcessor/ImageOperations.h"
+#include "ImageProcessor/ImageStatistics.h"
+#include "ImageProcessor/PointOpChain.h"
+#include "ImageProcessor/RoiMask.h"
+#include "ImageProcessor/SummedAreaTable.h"
+#include <QtGlobal>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QVector>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX) && !defined(Q_OS_LINUX)
+#include <sys/resource.h>
+#endif
+
+// 合成图像的种子，修改后不同版本的结果不再可比
+static const uint64_t SEED = 0x51494d47;
+
+struct FormatInfo {
+    const char *name;
+    QImage::Format format;
+};
+
+static const FormatInfo FORMATS[] = {
+    {"Grayscale8", QImage::Format_Grayscale8},
+    {"Grayscale16", QImage::Format_Grayscale16},
+    {"RGB888", QImage::Format_RGB888},
+    {"RGB32", QImage::Format_RGB32},
+    {"Indexed8", QImage::Format_Indexed8}
+};
+
+static bool verbose = false;
+
+// 默认只输出警告和错误，--verbose时输出处理过程中的调试信息
+static void messageHandler(QtMsgType type, const QMessageLogContext &, const QString &msg)
+{
+    if (type == QtDebugMsg && !verbose) {
+        return;
+    }
+    fprintf(stderr, "%s\n", msg.toLocal8Bit().constData());
+}
+
+static void printLine(const QString &text)
+{
+    fprintf(stderr, "%s\n", text.toLocal8Bit().constData());
+}
+
+// 进程的峰值常驻内存（字节），无法获取时返回-1
+static qint64 peakMemoryBytes()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+    return -1;
+#elif defined(Q_OS_LINUX)
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmHWM:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+        }
+    }
+    return -1;
+#elif defined(Q_OS_UNIX)
+    // macOS的ru_maxrss以字节为单位
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<qint64>(usage.ru_maxrss);
+#else
+    return -1;
+#endif
+}
+
+// 把峰值重置为当前值，使每项测试单独统计；不支持时返回false，各项的峰值为进程启动以来的累计值
+static bool resetPeakMemory()
+{
+#if defined(Q_OS_LINUX)
+    QFile clearRefs(QStringLiteral("/proc/self/clear_refs"));
+    return clearRefs.open(QIODevice::WriteOnly) && clearRefs.write("5") == 1;
+#else
+    return false;
+#endif
+}
+
+// 指定格式、尺寸的合成图像：逐行填充均匀分布的随机字节（Grayscale16的像素均匀分布在0-65535），
+// Indexed8使用固定的彩色调色板
+static QImage syntheticImage(int width, int height, QImage::Format format)
+{
+    QImage image(width, height, format);
+    if (image.isNull()) {
+        throw std::runtime_error("Cannot allocate the synthetic image");
+    }
+    if (format == QImage::Format_Indexed8) {
+        QVector<QRgb> palette(256);
+        for (int i = 0; i < palette.size(); ++i) {
+            palette[i] = qRgb(i, (i * 7) & 0xff, 255 - i);
+        }
+        image.setColorTable(palette);
+    }
+
+    cv::RNG rng(SEED);
+    const int rowBytes = width * image.depth() / 8;
+    for (int y = 0; y < height; ++y) {
+        cv::Mat row(1, rowBytes, CV_8UC1, image.scanLine(y));
+        rng.fill(row, cv::RNG::UNIFORM, 0, 256);
+        if (format == QImage::Format_RGB32) {
+            // RGB32要求alpha为0xff
+            QRgb *pixels = reinterpret_cast<QRgb*>(image.scanLine(y));
+            for (int x = 0; x < width; ++x) {
+                pixels[x] |= 0xff000000u;
+            }
+        }
+    }
+    return image;
+}
+
+// 按百万像素数取4:3的尺寸
+static cv::Size sizeForMegapixels(double megapixels)
+{
+    const int width = std::max(1, static_cast<int>(std::lround(std::sqrt(megapixels * 1e6 * 4.0 / 3.0))));
+    const int height = std::max(1, static_cast<int>(std::lround(megapixels * 1e6 / width)));
+    return cv::Size(width, height);
+}
+
+// 与cv::getGaussianKernel中由核大小推出sigma的规则一致
+static double sigmaForKernel(int kernelSize)
+{
+    return 0.3 * ((kernelSize - 1) * 0.5 - 1.0) + 0.8;
+}
+
+static QList<double> parseNumbers(const QString &text, const QString &option)
+{
+    QList<double> numbers;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const double value = part.trimmed().toDouble(&ok);
+        if (!ok || value <= 0) {
+            throw std::invalid_argument(QStringLiteral("--%1 需要以逗号分隔的正数").arg(option).toStdString());
+        }
+        numbers.append(value);
+    }
+    if (numbers.isEmpty()) {
+        throw std::invalid_argument(QStringLiteral("--%1 不能为空").arg(option).toStdString());
+    }
+    return numbers;
+}
+
+class Benchmark
+{
+public:
+    Benchmark(int iterations, const QStringList &operations)
+        : m_iterations(iterations), m_operations(operations)
+    {
+        m_peakPerCase = resetPeakMemory();
+    }
+
+    // 计时一项运算：预热一次，再计时m_iterations次；pixels为参与运算的像素数，用于计算吞吐量
+    // 出错时记录错误并继续下一项
+    void measure(const QString &operation, const QString &format, const cv::Size &size, int kernel,
+                 double pixels, const std::function<void()> &work)
+    {
+        if (!m_operations.isEmpty() && !m_operations.contains(operation)) {
+            return;
+        }
+
+        QJsonObject result;
+        result["operation"] = operation;
+        result["format"] = format;
+        result["width"] = size.width;
+        result["height"] = size.height;
+        result["megapixels"] = size.area() / 1e6;
+        if (kernel > 0) {
+            result["kernel"] = kernel;
+        }
+
+        QString summary;
+        if (m_peakPerCase) {
+            resetPeakMemory();
+        }
+        try {
+            work();
+
+            std::vector<double> times;
+            for (int i = 0; i < m_iterations; ++i) {
+                const auto start = std::chrono::steady_clock::now();
+                work();
+                times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+            std::sort(times.begin(), times.end());
+            const double median = times.size() % 2 ? times[times.size() / 2]
+                                                   : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2.0;
+            double total = 0.0;
+            for (double t : times) {
+                total += t;
+            }
+
+            result["iterations"] = m_iterations;
+            result["minMs"] = times.front();
+            result["medianMs"] = median;
+            result["meanMs"] = total / times.size();
+            result["megapixelsPerSecond"] = median > 0 ? pixels / 1e6 / (median / 1000.0) : 0.0;
+            summary = QStringLiteral("%1 ms, %2 MP/s").arg(median, 0, 'f', 2)
+                          .arg(result["megapixelsPerSecond"].toDouble(), 0, 'f', 1);
+        } catch (const cv::Exception& e) {
+            result["error"] = QString::fromStdString(e.what());
+        } catch (const std::exception& e) {
+            result["error"] = QString::fromStdString(e.what());
+        } catch (...) {
+            result["error"] = QStringLiteral("Unknown error");
+        }
+        if (result.contains("error")) {
+            ++m_errors;
+            summary = QStringLiteral("错误: ") + result["error"].toString().simplified();
+        }
+
+        const qint64 peak = peakMemoryBytes();
+        result["peakMemoryBytes"] = peak;
+        m_peakMemory = std::max(m_peakMemory, peak);
+        m_results.append(result);
+
+        printLine(QStringLiteral("%1 %2 %3x%4%5: %6")
+                      .arg(operation, format)
+                      .arg(size.width)
+                      .arg(size.height)
+                      .arg(kernel > 0 ? QStringLiteral(" k=%1").arg(kernel) : QString())
+                      .arg(summary));
+    }
+
+    QJsonObject report() const
+    {
+        QJsonObject report;
+        report["format"] = QStringLiteral("QIImageBench.results");
+        report["version"] = 1;
+        report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        report["qt"] = QString::fromLatin1(qVersion());
+        report["opencv"] = QString::fromLatin1(CV_VERSION);
+        report["threads"] = cv::getNumThreads();
+        report["iterations"] = m_iterations;
+        report["seed"] = static_cast<qint64>(SEED);
+        // false时各项的peakMemoryBytes为进程启动以来的累计峰值
+        report["peakMemoryPerCase"] = m_peakPerCase;
+        report["peakMemoryBytes"] = m_peakMemory;
+        report["results"] = m_results;
+        return report;
+    }
+
+    int errors() const
+    {
+        return m_errors;
+    }
+
+private:
+    const int m_iterations;
+    const QStringList m_operations;
+    bool m_peakPerCase = false;
+    qint64 m_peakMemory = -1;
+    int m_errors = 0;
+    QJsonArray m_results;
+};
+
+// 一种格式、一种尺寸的全部测试项
+static void runImage(Benchmark &benchmark, const FormatInfo &info, const cv::Size &size, const QList<double> &kernels)
+{
+    const QString format = QString::fromLatin1(info.name);
+    const QImage image = syntheticImage(size.width, size.height, info.format);
+    const double pixels = size.area();
+
+    // 格式转换
+    cv::Mat mat;
+    benchmark.measure("QImageToMat", format, size, 0, pixels, [&]() {
+        mat = ImageMatAdapter::toMat(image);
+    });
+    if (mat.empty()) {
+        mat = ImageMatAdapter::toMat(image);
+    }
+    // Grayscale16的各项测试必须运行在CV_16UC1上，压缩为8位后测到的是8位的路径
+    if (info.format == QImage::Format_Grayscale16 && mat.type() != CV_16UC1) {
+        throw std::runtime_error("Grayscale16 did not convert to a CV_16UC1 matrix");
+    }
+    benchmark.measure("MatToQImage", format, size, 0, pixels, [&]() {
+        ImageMatAdapter::toQImage(mat);
+    });
+    benchmark.measure("toGrayscale", format, size, 0, pixels, [&]() {
+        ImageOperations::toGrayscale(mat);
+    });
+
+    // 邻域滤波
+    for (double k : kernels) {
+        const int kernel = static_cast<int>(k);
+        benchmark.measure("meanFilter", format, size, kernel, pixels, [&]() {
+            ImageOperations::meanFilter(mat, kernel);
+        });
+        benchmark.measure("gaussianFilter", format, size, kernel, pixels, [&]() {
+            ImageOperations::gaussianFilter(mat, kernel, sigmaForKernel(kernel));
+        });
+        benchmark.measure("medianFilter", format, size, kernel, pixels, [&]() {
+            ImageOperations::medianFilter(mat, kernel);
+        });
+    }
+
+    // 点运算与直方图运算
+    benchmark.measure("linearTransform", format, size, 0, pixels, [&]() {
+        ImageOperations::linearTransform(mat, 20, 10);
+    });
+    benchmark.measure("gammaContrast", format, size, 0, pixels, [&]() {
+        ImageOperations::gammaContrast(mat, 0.8, 20);
+    });
+    // 多步调整合并为一张查找表：线性、Gamma、对比度、反相和截断一次遍历完成，耗时应与单步调整相同
+    const PointOpChain toneChain = PointOpChain().linear(1.2, 10).gamma(0.8).contrast(1.1).invert().clip(16, 235);
+    benchmark.measure("fusedPointOps", format, size, 0, pixels, [&]() {
+        ImageOperations::applyPointOps(mat, toneChain);
+    });
+    // 每个通道各自的点运算链编译为一张多通道查找表（8位多通道）
+    if (mat.depth() == CV_8U && mat.channels() > 1) {
+        std::vector<PointOpChain> channelChains;
+        for (int c = 0; c < mat.channels(); ++c) {
+            channelChains.push_back(PointOpChain(toneChain).linear(1.0, 8.0 * c));
+        }
+        benchmark.measure("perChannelPointOps", format, size, 0, pixels, [&]() {
+            PointOpChain::applyLut(mat, PointOpChain::compilePerChannel(channelChains));
+        });
+    }
+    benchmark.measure("equalizeHistogram", format, size, 0, pixels, [&]() {
+        ImageOperations::equalizeHistogram(mat);
+    });
+    benchmark.measure("stretchHistogram", format, size, 0, pixels, [&]() {
+        ImageOperations::stretchHistogram(mat);
+    });
+
+    // 统计
+    benchmark.measure("histogram", format, size, 0, pixels, [&]() {
+        ImageStatistics::compute(mat);
+    });
+    SummedAreaTable table;
+    benchmark.measure("summedAreaTable", format, size, 0, pixels, [&]() {
+        table = SummedAreaTable(mat);
+    });
+    // ROI统计：光栅化居中的圆并由积分图按段累加，吞吐量按ROI的面积计算
+    const cv::Point center(size.width / 2, size.height / 2);
+    const int radius = std::min(size.width, size.height) / 3;
+    const double roiPixels = static_cast<double>(RoiMask::circle(center, radius, size).area());
+    if (table.isEmpty()) {
+        table = SummedAreaTable(mat);
+    }
+    benchmark.measure("roiStatistics", format, size, 0, roiPixels, [&]() {
+        table.spans(RoiMask::circle(center, radius, size).spans());
+    });
+}
+
+// 验证用的随机输入：每个通道在levels个灰度值中均匀取值，16位时这些值均匀分布在0-65535
+// （不超过256个值、不超过4096个值和更多的值分别对应常数时间中值滤波的三种直方图）
+static cv::Mat verifyInput(const cv::Size &size, int depth, int channels, int levels, cv::RNG &rng)
+{
+    cv::Mat mat(size, CV_MAKETYPE(depth, channels));
+    rng.fill(mat, cv::RNG::UNIFORM, 0, levels);
+    if (depth == CV_16U && levels < 65536) {
+        mat.convertTo(mat, -1, 65535.0 / (levels - 1));
+    }
+    return mat;
+}
+
+// 中值滤波的参考结果：medianBlur对大于5的核只支持8位，16位的大核逐像素排序（边界复制边缘像素）
+static cv::Mat referenceMedian(const cv::Mat &src, int kernelSize)
+{
+    cv::Mat dst;
+    if (src.depth() == CV_8U || kernelSize <= 5) {
+        cv::medianBlur(src, dst, kernelSize);
+        return dst;
+    }
+
+    const int radius = kernelSize / 2;
+    const int channels = src.channels();
+    dst.create(src.size(), src.type());
+    std::vector<ushort> window(static_cast<size_t>(kernelSize) * kernelSize);
+    for (int y = 0; y < src.rows; ++y) {
+        for (int x = 0; x < src.cols; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                size_t n = 0;
+                for (int dy = -radius; dy <= radius; ++dy) {
+                    const ushort *row = src.ptr<ushort>(std::min(std::max(y + dy, 0), src.rows - 1));
+                    for (int dx = -radius; dx <= radius; ++dx) {
+                        window[n++] = row[std::min(std::max(x + dx, 0), src.cols - 1) * channels + c];
+                    }
+                }
+                std::nth_element(window.begin(), window.begin() + n / 2, window.begin() + n);
+                dst.ptr<ushort>(y)[x * channels + c] = window[n / 2];
+            }
+        }
+    }
+    return dst;
+}
+
+// --verify：滤波结果与参考实现的最大差值不超过允许值（灰度级）时通过，返回不一致的项数
+// 中值和截断核的高斯必须完全一致；均值允许1个灰度级的舍入差异；递归高斯是近似实现，允许满量程的2%
+static int runVerification()
+{
+    struct GaussianCase {
+        int kernel;
+        double sigma;
+    };
+    const cv::Size sizes[] = {cv::Size(97, 71), cv::Size(37, 23), cv::Size(5, 131)};
+    const int medianKernels[] = {3, 5, 7, 15, 51};
+    const int meanKernels[] = {3, 15, 51, 151};
+    // 截断核走FIR路径，核大小为0时sigma不小于阈值走递归路径（sigma=20时支撑远大于图像）
+    const GaussianCase gaussianCases[] = {{7, 1.5}, {31, 6.0}, {0, 6.0}, {0, 20.0}};
+    struct InputKind {
+        const char *name;
+        int depth;
+        int levels;
+    };
+    const InputKind kinds[] = {
+        {"8U", CV_8U, 256},
+        {"16U/256", CV_16U, 256},
+        {"16U/4096", CV_16U, 4096},
+        {"16U/65536", CV_16U, 65536}
+    };
+
+    cv::RNG rng(SEED);
+    int cases = 0;
+    int failures = 0;
+    const auto check = [&](const QString &operation, const QString &input, int kernel,
+                           const cv::Mat &result, const cv::Mat &reference, double allowed) {
+        ++cases;
+        const bool sameShape = result.size() == reference.size() && result.type() == reference.type();
+        const double diff = sameShape ? cv::norm(result, reference, cv::NORM_INF) : -1.0;
+        const QString line = QStringLiteral("verify %1 %2 k=%3: %4").arg(operation, input).arg(kernel)
+                                 .arg(sameShape ? QStringLiteral("最大差值 %1（允许 %2）").arg(diff).arg(allowed)
+                                                : QStringLiteral("尺寸或类型不一致"));
+        if (!sameShape || diff > allowed) {
+            ++failures;
+            printLine(QStringLiteral("不一致: ") + line);
+        } else {
+            qDebug().noquote() << line;
+        }
+    };
+
+    for (const cv::Size &size : sizes) {
+        for (int channels : {1, 3, 4}) {
+            for (const InputKind &kind : kinds) {
+                const cv::Mat src = verifyInput(size, kind.depth, channels, kind.levels, rng);
+                const double range = kind.depth == CV_16U ? 65535.0 : 255.0;
+                const QString input = QStringLiteral("%1 %2x%3x%4").arg(QString::fromLatin1(kind.name))
+                                          .arg(size.width).arg(size.height).arg(channels);
+                try {
+                    for (int k : medianKernels) {
+                        check("ConstantTimeMedian", input, k, ConstantTimeMedian::apply(src, k),
+                              referenceMedian(src, k), 0.0);
+                        check("medianFilter", input, k, ImageOperations::medianFilter(src, k),
+                              referenceMedian(src, k), 0.0);
+                    }
+                    for (int k : meanKernels) {
+                        cv::Mat reference;
+                        cv::blur(src, reference, cv::Size(k, k));
+                        check("meanFilter", input, k, ImageOperations::meanFilter(src, k), reference, 1.0);
+                    }
+                    for (const GaussianCase &g : gaussianCases) {
+                        cv::Mat reference;
+                        const bool recursive = ImageOperations::usesRecursiveGaussian(g.kernel, g.sigma);
+                        if (recursive) {
+                            // 递归高斯的边界复制边缘像素，参考取±4σ的核
+                            const int support = cvRound(g.sigma * 8.0 + 1.0) | 1;
+                            cv::GaussianBlur(src, reference, cv::Size(support, support), g.sigma, g.sigma,
+                                             cv::BORDER_REPLICATE);
+                        } else {
+                            cv::GaussianBlur(src, reference, cv::Size(g.kernel, g.kernel), g.sigma);
+                        }
+                        check(QStringLiteral("gaussianFilter(sigma=%1)").arg(g.sigma), input, g.kernel,
+                              ImageOperations::gaussianFilter(src, g.kernel, g.sigma), reference,
+                              recursive ? 0.02 * range : 0.0);
+                    }
+                } catch (const std::exception& e) {
+                    ++cases;
+                    ++failures;
+                    printLine(QStringLiteral("错误: verify %1: %2").arg(input, QString::fromUtf8(e.what())));
+                }
+            }
+        }
+    }
+
+    printLine(QStringLiteral("验证完成: %1项，%2项不一致").arg(cases).arg(failures));
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QIImageBench");
+    qInstallMessageHandler(messageHandler);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("图像处理各阶段的基准测试，结果以JSON输出"));
+    parser.addHelpOption();
+
+    const QCommandLineOption sizesOption("sizes", QStringLiteral("图像尺寸（百万像素），默认1,4,16,100"), "list", "1,4,16,100");
+    const QCommandLineOption formatsOption("formats", QStringLiteral("图像格式，默认Grayscale8,Grayscale16,RGB888,RGB32,Indexed8"),
+                                           "list", "Grayscale8,Grayscale16,RGB888,RGB32,Indexed8");
+    const QCommandLineOption kernelsOption("kernels", QStringLiteral("滤波核大小（3-31的奇数），默认3,5,7,11,15,21,31"),
+                                           "list", "3,5,7,11,15,21,31");
+    const QCommandLineOption operationsOption("operations", QStringLiteral("只测试列出的运算，默认全部"), "list");
+    const QCommandLineOption iterationsOption({"n", "iterations"}, QStringLiteral("每项计时的次数，默认5"), "n", "5");
+    const QCommandLineOption outputOption({"o", "output"}, QStringLiteral("结果文件，默认输出到标准输出"), "file");
+    const QCommandLineOption verboseOption({"v", "verbose"}, QStringLiteral("输出调试信息"));
+    const QCommandLineOption verifyOption("verify", QStringLiteral("不计时，把滤波结果与OpenCV的参考实现比较"));
+    parser.addOptions({sizesOption, formatsOption, kernelsOption, operationsOption, iterationsOption,
+                       outputOption, verboseOption, verifyOption});
+    parser.process(app);
+    verbose = parser.isSet(verboseOption);
+
+    if (parser.isSet(verifyOption)) {
+        return runVerification() > 0 ? 3 : 0;
+    }
+
+    QList<double> sizes;
+    QList<double> kernels;
+    QList<FormatInfo> formats;
+    int iterations = 0;
+    try {
+        sizes = parseNumbers(parser.value(sizesOption), "sizes");
+        kernels = parseNumbers(parser.value(kernelsOption), "kernels");
+        for (double k : kernels) {
+            if (k != std::floor(k) || static_cast<int>(k) % 2 == 0 || k < 3 || k > 31) {
+                throw std::invalid_argument("--kernels 需要3到31之间的奇数");
+            }
+        }
+        for (const QString &name : parser.value(formatsOption).split(',', Qt::SkipEmptyParts)) {
+            const auto it = std::find_if(std::begin(FORMATS), std::end(FORMATS),
+                                         [&name](const FormatInfo &f) { return name.trimmed() == QLatin1String(f.name); });
+            if (it == std::end(FORMATS)) {
+                throw std::invalid_argument(QStringLiteral("不支持的格式: %1").arg(name).toStdString());
+            }
+            formats.append(*it);
+        }
+        bool ok = false;
+        iterations = parser.value(iterationsOption).toInt(&ok);
+        if (!ok || iterations <= 0) {
+            throw std::invalid_argument("--iterations 需要正整数");
+        }
+    } catch (const std::exception& e) {
+        printLine(QStringLiteral("错误: %1").arg(QString::fromUtf8(e.what())));
+        return 1;
+    }
+
+    QStringList operations;
+    for (const QString &name : parser.value(operationsOption).split(',', Qt::SkipEmptyParts)) {
+        operations.append(name.trimmed());
+    }
+
+    Benchmark benchmark(iterations, operations);
+    int skipped = 0;
+    for (double megapixels : sizes) {
+        const cv::Size size = sizeForMegapixels(megapixels);
+        for (const FormatInfo &info : formats) {
+            try {
+                runImage(benchmark, info, size, kernels);
+            } catch (const std::exception& e) {
+                // 合成图像分配失败等，跳过这一组
+                ++skipped;
+                printLine(QStringLiteral("%1 %2x%3: %4").arg(QString::fromLatin1(info.name))
+                              .arg(size.width).arg(size.height).arg(QString::fromUtf8(e.what())));
+            }
+        }
+    }
+
+    const QByteArray json = QJsonDocument(benchmark.report()).toJson();
+    if (parser.isSet(outputOption)) {
+        QSaveFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+            printLine(QStringLiteral("无法写入结果文件: %1").arg(file.errorString()));
+            return 1;
+        }
+    } else {
+        fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+    }
+    return benchmark.errors() > 0 || skipped > 0 ? 2 : 0;
+}